@@ -1,24 +1,46 @@
 #include "CircleProgressBar.h"
+#include "GaugeAnimator.h"
 
-#include <QPainter>
 #include <QDebug>
 
+#include <cmath>
+
 CircleProgressBar::CircleProgressBar(QWidget *parent)
     : QOpenGLWidget(parent)
 {
     animation=new QPropertyAnimation(this,"drawValue");
     animation->setDuration(2000); //动画持续时间
     animation->setEasingCurve(QEasingCurve::OutQuart); //先快后慢
+    easingClock.start();
+    frameProfiler=new GaugeProfiler(this);
+    frameRecorder=new GaugeRecorder(this);
+    renderer.setMemoryOwner(this);
+    resolution.setMemoryOwner(this);
+    //动画中途可能跳过了看不出变化的刷新，结束时补一帧并生成静态缓存
+    connect(animation,&QPropertyAnimation::finished,this,[this]{
+        update();
+    });
 }
 
 CircleProgressBar::~CircleProgressBar()
 {
+    if(animatorHandle>=0)
+        GaugeAnimator::instance()->remove(animatorHandle);
+    //工作线程有自己的上下文，先停下
+    if(renderThread)
+        renderThread->stop();
+    GaugeMemory::instance()->untrack(backingMemory);
     //显示后才会执行初始化
     if(!isValid())
         return;
     makeCurrent();
-    vbo.destroy();
-    vao.destroy();
+    frameRecorder->release();
+    frameProfiler->release();
+    resolution.release();
+    delete cacheFbo;
+    GaugeMemory::instance()->untrack(cacheMemory);
+    blitter.destroy();
+    renderer.release();
     doneCurrent();
 }
 
@@ -28,18 +50,60 @@ void CircleProgressBar::setRange(double min, double max)
         return;
     progressMin=min;
     progressMax=max;
+    cacheValid=false;
 }
 
 void CircleProgressBar::setValue(double value)
 {
     if(value<progressMin||value>progressMax)
         return;
-    progressDraw=progressValue;
     progressValue=value;
+    if(animatorHandle>=0){
+        //由GaugeAnimator统一推进，值变化时它会调用update()
+        GaugeAnimator::instance()->animateTo(animatorHandle,normalizedProgress(progressValue));
+        cacheValid=false;
+        return;
+    }
+    if(gpuEasing){
+        //只改缓动参数，由着色器计算过程
+        easing.retarget(easingNow(),normalizedProgress(progressValue));
+        cacheValid=false;
+        update();
+        return;
+    }
+    //从当前绘制的值继续，动画进行中时只改终点不重新计时
+    GaugeValueFeed::retarget(animation,progressDraw,progressValue);
+}
 
-    animation->setStartValue(progressDraw);
-    animation->setEndValue(progressValue);
-    animation->start();
+void CircleProgressBar::postValue(double value)
+{
+    //只有上一个值已被取走时才排队刷新，之后的写入直接覆盖
+    if(valueFeed.store(value))
+        QMetaObject::invokeMethod(this,[this]{ update(); },Qt::QueuedConnection);
+}
+
+void CircleProgressBar::setDataSource(GaugeDataSource *source)
+{
+    dataSource=source;
+    //静止时不出帧，绑定期间由帧驱动按屏幕刷新轮询，没有新值时只贴缓存
+    if(dataSource){
+        if(!sourceDriver)
+            sourceDriver=new GaugeFrameDriver(this);
+        sourceDriver->start();
+    }else if(sourceDriver){
+        sourceDriver->stop();
+    }
+    update();
+}
+
+GaugeDataSource *CircleProgressBar::getDataSource() const
+{
+    return dataSource;
+}
+
+double CircleProgressBar::easingNow() const
+{
+    return easingClock.nsecsElapsed()/1e9;
 }
 
 double CircleProgressBar::getDrawValue() const
@@ -50,161 +114,381 @@ double CircleProgressBar::getDrawValue() const
 void CircleProgressBar::setDrawValue(double value)
 {
     progressDraw=value;
+    //变化不到一个像素且文字不变时不刷新
+    if(!isVisibleChange(value))
+        return;
+    cacheValid=false;
+    update();
+}
+
+void CircleProgressBar::setQuality(GaugeShaders::Quality quality)
+{
+    renderer.setQuality(quality);
+    if(renderThread)
+        renderThread->setQuality(quality);
+    cacheValid=false;
+    update();
+}
+
+GaugeShaders::Quality CircleProgressBar::getQuality() const
+{
+    return renderer.getQuality();
+}
+
+void CircleProgressBar::setLabelFont(const QFont &font)
+{
+    renderer.setLabelFont(font);
+    if(renderThread)
+        renderThread->setLabelFont(font);
+    cacheValid=false;
+    update();
+}
+
+QFont CircleProgressBar::getLabelFont() const
+{
+    return renderer.getLabelFont();
+}
+
+void CircleProgressBar::setMeshGeometryEnabled(bool enable)
+{
+    renderer.setMeshGeometryEnabled(enable);
+    if(renderThread)
+        renderThread->setMeshGeometryEnabled(enable);
+    cacheValid=false;
+    update();
+}
+
+bool CircleProgressBar::isMeshGeometryEnabled() const
+{
+    return renderer.isMeshGeometryEnabled();
+}
+
+bool CircleProgressBar::setThreadedRenderingEnabled(bool enable)
+{
+    if(enable==(renderThread!=nullptr))
+        return true;
+    if(enable){
+        //工作线程的渲染器与当前样式一致
+        CircleProgressRenderer *thread_renderer=new CircleProgressRenderer;
+        thread_renderer->setQuality(renderer.getQuality());
+        thread_renderer->setLabelFont(renderer.getLabelFont());
+        thread_renderer->setMeshGeometryEnabled(renderer.isMeshGeometryEnabled());
+        renderThread=new GaugeRenderThread(thread_renderer,this);
+        if(!renderThread->start()){
+            delete renderThread;
+            renderThread=nullptr;
+            return false;
+        }
+        //工作线程画完时贴上新的一帧，参数没变时paintGL不再提交，不会循环
+        connect(renderThread,&GaugeRenderThread::frameReady,this,[this]{ update(); });
+    }else{
+        //等GUI线程贴图的命令执行完再释放工作线程的纹理
+        if(isValid()){
+            makeCurrent();
+            glFinish();
+            doneCurrent();
+        }
+        delete renderThread;
+        renderThread=nullptr;
+    }
+    cacheValid=false;
+    update();
+    return true;
+}
+
+bool CircleProgressBar::isThreadedRenderingEnabled() const
+{
+    return renderThread!=nullptr;
+}
+
+void CircleProgressBar::setAdaptiveResolutionEnabled(bool enable)
+{
+    if(enable==adaptiveResolution)
+        return;
+    adaptiveResolution=enable;
+    //关闭时归还内部FBO
+    if(!enable&&isValid()){
+        makeCurrent();
+        resolution.release();
+        doneCurrent();
+    }
+    update();
+}
+
+bool CircleProgressBar::isAdaptiveResolutionEnabled() const
+{
+    return adaptiveResolution;
+}
+
+GaugeResolutionScaler *CircleProgressBar::resolutionScaler()
+{
+    return &resolution;
+}
+
+void CircleProgressBar::setSurfaceMode(GaugeSurface::Mode mode)
+{
+    if(GaugeSurface::apply(this,mode))
+        surfaceMode=mode;
+}
+
+GaugeSurface::Mode CircleProgressBar::getSurfaceMode() const
+{
+    return surfaceMode;
+}
+
+qint64 CircleProgressBar::gpuMemoryBytes() const
+{
+    return GaugeMemory::instance()->bytesFor(this);
+}
+
+void CircleProgressBar::setProfilingEnabled(bool enable)
+{
+    frameProfiler->setEnabled(enable);
+    renderer.setTimingEnabled(enable);
+}
+
+bool CircleProgressBar::isProfilingEnabled() const
+{
+    return frameProfiler->isEnabled();
+}
+
+GaugeProfiler *CircleProgressBar::profiler() const
+{
+    return frameProfiler;
+}
+
+GaugeRecorder *CircleProgressBar::recorder() const
+{
+    return frameRecorder;
+}
+
+bool CircleProgressBar::setGpuEasingEnabled(bool enable)
+{
+    if(enable==gpuEasing)
+        return true;
+    const double now=easingNow();
+    if(enable){
+        setSharedAnimationEnabled(false);
+        GaugeEasing::Curve curve;
+        if(!GaugeEasing::curveFor(animation->easingCurve().type(),curve)){
+            qWarning()<<"GPU easing does not support this easing curve";
+            return false;
+        }
+        //接着进行中的属性动画继续
+        easing.curve=curve;
+        easing.duration=animation->duration()/1000.0f;
+        if(animation->state()==QAbstractAnimation::Running){
+            easing.start=normalizedProgress(animation->startValue().toDouble());
+            easing.end=normalizedProgress(animation->endValue().toDouble());
+            easing.startTime=now-animation->currentTime()/1000.0;
+        }else{
+            easing.jump(normalizedProgress(progressDraw));
+        }
+        animation->stop();
+    }else{
+        //从当前值改回属性动画
+        progressDraw=progressMin+easing.valueAt(now)*(progressMax-progressMin);
+        if(easing.isRunning(now))
+            GaugeValueFeed::retarget(animation,progressDraw,progressValue);
+    }
+    gpuEasing=enable;
+    renderer.setGpuEasingEnabled(enable);
+    cacheValid=false;
+    update();
+    return true;
+}
+
+bool CircleProgressBar::isGpuEasingEnabled() const
+{
+    return gpuEasing;
+}
+
+void CircleProgressBar::setSharedAnimationEnabled(bool enable)
+{
+    if(enable==(animatorHandle>=0))
+        return;
+    GaugeAnimator *animator=GaugeAnimator::instance();
+    if(enable){
+        setGpuEasingEnabled(false);
+        //从当前值接着走向设置的值
+        const bool running=animation->state()==QAbstractAnimation::Running;
+        animation->stop();
+        animatorHandle=animator->add(this);
+        animator->jumpTo(animatorHandle,normalizedProgress(progressDraw));
+        if(running)
+            animator->animateTo(animatorHandle,normalizedProgress(progressValue));
+    }else{
+        progressDraw=progressMin+animator->value(animatorHandle)*(progressMax-progressMin);
+        if(animator->isRunning(animatorHandle))
+            GaugeValueFeed::retarget(animation,progressDraw,progressValue);
+        animator->remove(animatorHandle);
+        animatorHandle=-1;
+    }
+    cacheValid=false;
     update();
 }
 
+bool CircleProgressBar::isSharedAnimationEnabled() const
+{
+    return animatorHandle>=0;
+}
+
 void CircleProgressBar::initializeGL()
 {
     //为当前上下文初始化OpenGL函数解析
     initializeOpenGLFunctions();
+    //着色器代码见GaugeShaders
+    renderer.initialize();
+    blitter.create();
+}
 
-    //着色器代码
-    //in输入，out输出,uniform从cpu向gpu发送
-    //[aPos]两个三角的顶点数据
-    //[thePos]表示当前像素点
-    const char *vertex_str=R"(#version 330 core
-                           layout (location = 0) in vec2 aPos;
-                           out vec2 thePos;
-                           void main()
-                           {
-                             gl_Position = vec4(aPos, 0.0, 1.0);
-                             thePos = aPos;
-                           })";
-    //GLSL的atan2也叫atan，不过参数不同，我们封装一个0-360度的归一化值[0,1]的版本
-    //[FragColor]该点输出颜色，gl_FragColor在3移除了，自己声明一个
-    //[aValue]进度值
-    //[aSmoothWidth]用来计算平滑所需宽度，根据绘制区域大小来计算
-    //[len]坐标点距离圆心的距离,[0,1]，勾股定理
-    //[alpha]使用smoothstep平滑函数取0.75±0.15的圆圈透明度为1
-    //[angle]thePos像素点对应的角度值，用于调节渐变，归一化到[0，1]
-    //[angle_smooth]进度值那条斜线取平滑
-    //[ret smoothstep(a,b,x)]可以用来生成0-1的平滑过渡，达到抗锯齿效果
-    //返回0: x<a<b 或者 x>a>b
-    //返回1: x<b<a 或者 x>b>a
-    //返回n: 根据x在ab间位置，返回[0,1]过度值
-    const char *fragment_str=R"(#version 330 core
-                             #define PI 3.14159265
-                             uniform float aValue;
-                             uniform float aSmoothWidth;
-                             in vec2 thePos;
-                             out vec4 FragColor;
-
-                             float myatan2(float y,float x)
-                             {
-                               float ret_val = 0.0;
-                               if(x != 0.0){
-                                 ret_val = atan(y,x);
-                                 if(ret_val < 0.0){
-                                   ret_val += 2.0*PI;
-                                 }
-                               }else{
-                                 ret_val = y>0 ? PI*0.5 : PI*1.5;
-                               }
-                               return ret_val/(2.0*PI);
-                             }
-
-                             void main()
-                             {
-                             float len = abs(sqrt(pow(thePos.x,2.0)+pow(thePos.y,2.0)));
-                             float alpha = smoothstep(0.15+aSmoothWidth,0.15,abs(len-0.75));
-                             float angle = myatan2(thePos.y,thePos.x);
-                             float angle_smooth = smoothstep(aValue+aSmoothWidth/3.0,aValue,angle);
-
-                             if(angle_smooth>0.0 && aValue>0.0){
-                               if(angle_smooth>=1.0){
-                                 FragColor = vec4(1.0,0.1,(1.0-angle),alpha);
-                               }else{
-                                 FragColor = vec4(mix(vec3(1.0,0.1,(1.0-angle)),vec3(0.4,0.1,0.6),1.0-angle_smooth),alpha);
-                               }
-                             }else{
-                               FragColor = vec4(0.4,0.1,0.6,alpha);
-                             }
-                             })";
-
-
-    //将source编译为指定类型的着色器，并添加到此着色器程序
-    if(!shaderProgram.addCacheableShaderFromSourceCode(
-                QOpenGLShader::Vertex,vertex_str)){
-        qDebug()<<"compiler vertex error"<<shaderProgram.log();
+void CircleProgressBar::paintGL()
+{
+    //取数据源和跨线程写入的最新值，一帧只取一次
+    double fed_value=0;
+    if(dataSource&&dataSource->sample(fed_value))
+        setValue(fed_value);
+    if(valueFeed.take(fed_value))
+        setValue(fed_value);
+    bool running=animation->state()==QAbstractAnimation::Running;
+    if(gpuEasing){
+        //进度由着色器计算，这里只同步参数、维护drawValue，动画期间继续请求下一帧
+        const double now=easingNow();
+        renderer.setEasing(easing,now);
+        progressDraw=progressMin+easing.valueAt(now)*(progressMax-progressMin);
+        running=easing.isRunning(now);
+        if(running)
+            update();
+    }else if(animatorHandle>=0){
+        GaugeAnimator *animator=GaugeAnimator::instance();
+        progressDraw=progressMin+animator->value(animatorHandle)*(progressMax-progressMin);
+        running=animator->isRunning(animatorHandle);
     }
-    if(!shaderProgram.addCacheableShaderFromSourceCode(
-                QOpenGLShader::Fragment,fragment_str)){
-        qDebug()<<"compiler fragment error"<<shaderProgram.log();
+    const float progress=normalizedProgress(progressDraw);
+    //qDebug()<<"draw progress"<<progress;
+    paintedProgress=progress;
+    if(renderThread){
+        //GUI线程只贴图，各阶段记0
+        if(frameProfiler->isEnabled())
+            frameProfiler->beginFrame(running);
+        drawThreaded(progress,0);
+        if(frameProfiler->isEnabled())
+            frameProfiler->endFrame(ProgressRenderer::Timings());
+        frameRecorder->captureFrame();
+        return;
     }
-    //使用addShader()将添加到该程序的着色器链接在一起。
-    if(!shaderProgram.link()){
-        qDebug()<<"link shaderprogram error"<<shaderProgram.log();
+    if(!frameProfiler->isEnabled()){
+        drawFrame(progress,running);
+    }else{
+        frameProfiler->beginFrame(running);
+        //只贴缓存时渲染器没有工作，各阶段记0
+        const bool rendered=drawFrame(progress,running);
+        frameProfiler->endFrame(rendered?renderer.lastTimings():ProgressRenderer::Timings());
     }
-
-    //两个三角拼接的一个矩形
-    const float vertices[] = {
-        -1.0f, -1.0f, //左下角
-        +1.0f, -1.0f, //右下角
-        +1.0f, +1.0f, //右上角
-
-        +1.0f, +1.0f, //右上角
-        -1.0f, +1.0f, //左上角
-        -1.0f, -1.0f, //左下角
-    };
-    vao.create();
-    vao.bind();
-    vbo=QOpenGLBuffer(QOpenGLBuffer::VertexBuffer);
-    vbo.create();
-    vbo.bind();
-    vbo.allocate(vertices,sizeof(vertices));
-
-    // position attribute
-    int attr = -1;
-    attr = shaderProgram.attributeLocation("aPos");
-    //setAttributeBuffer(int location, GLenum type, int offset, int tupleSize, int stride = 0)
-    shaderProgram.setAttributeBuffer(attr, GL_FLOAT, 0, 2, sizeof(GLfloat) * 2);
-    shaderProgram.enableAttributeArray(attr);
+    frameRecorder->captureFrame();
 }
 
-void CircleProgressBar::paintGL()
+bool CircleProgressBar::drawFrame(float progress, bool running)
 {
-    //以短边为边长，保持比例，Qt这里有个问题，在resize里设置的没用
-    const int item_w=width()>height()?height():width();
-    glViewport((width()-item_w)/2,
-               (height()-item_w)/2,
-               item_w,
-               item_w);
+    //动画过程中每帧都不同，直接绘制
+    if(running){
+        drawLive(progress,0);
+        return true;
+    }
 
-    glClearColor(0.1f, 0.2f, 0.3f, 1.0f);
-    glClear(GL_COLOR_BUFFER_BIT);
+    //静止时绘制到缓存纹理，之后的刷新（遮挡、父控件重绘等）只贴图
+    const qreal ratio=devicePixelRatioF();
+    const QSize fbo_size(qRound(width()*ratio),qRound(height()*ratio));
+    if(!cacheFbo||cacheFbo->size()!=fbo_size){
+        delete cacheFbo;
+        cacheFbo=new QOpenGLFramebufferObject(fbo_size,QOpenGLFramebufferObject::NoAttachment,
+                                              GL_TEXTURE_2D,GaugeSurface::textureFormat(surfaceMode));
+        GaugeMemory::instance()->track(cacheMemory,this,GaugeMemory::Framebuffer,
+                                       QString("static cache %1x%2").arg(fbo_size.width()).arg(fbo_size.height()),
+                                       GaugeMemory::framebufferBytes(fbo_size,false,0,GaugeSurface::bytesPerPixel(surfaceMode)));
+        cacheValid=false;
+    }
+    const GaugeShaders::Quality quality=GaugeShaders::resolve(renderer.getQuality());
+    bool rendered=false;
+    if(!cacheValid||cacheQuality!=quality){
+        cacheFbo->bind();
+        renderer.setPixelScale(float(ratio));
+        renderer.render(fbo_size.width(),fbo_size.height(),progress);
+        glBindFramebuffer(GL_FRAMEBUFFER, defaultFramebufferObject());
+        cacheValid=true;
+        cacheQuality=quality;
+        rendered=true;
+    }
 
-    glEnable(GL_BLEND);
-    //基于源像素Alpha通道值的半透明混合函数
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE);
-    //开启多重采样抗锯齿，貌似没啥效果
-    //glEnable(GL_MULTISAMPLE);
+    glViewport(0, 0, fbo_size.width(), fbo_size.height());
+    glDisable(GL_BLEND);
+    blitter.bind();
+    blitter.blit(cacheFbo->texture(), QMatrix4x4(), QOpenGLTextureBlitter::OriginBottomLeft);
+    blitter.release();
+    return rendered;
+}
 
-    shaderProgram.bind();
-    //把进度[min,max]归一化[0,1]
-    const float progress=(progressDraw-progressMin)/(progressMax-progressMin);
-    //qDebug()<<"draw progress"<<progress;
-    shaderProgram.setUniformValue("aValue", progress);
-    //aSmoothWidth用来计算平滑所需宽度，根据不同的大小来计算，这里用N px的宽度
-    shaderProgram.setUniformValue("aSmoothWidth", float(3.0/item_w));
-    vao.bind();
+void CircleProgressBar::drawThreaded(float progress, float time)
+{
+    const qreal ratio=devicePixelRatioF();
+    GaugeRenderThread::FrameRequest request;
+    request.fboSize=QSize(qRound(width()*ratio),qRound(height()*ratio));
+    request.pixelScale=float(ratio);
+    request.progress=progress;
+    request.time=time;
+    //参数和样式没变时不再提交，工作线程画完触发的刷新只贴图
+    if(!cacheValid||request.fboSize!=threadRequest.fboSize||request.progress!=threadRequest.progress){
+        renderThread->requestFrame(request);
+        threadRequest=request;
+        cacheValid=true;
+    }
 
-    glDrawArrays(GL_TRIANGLES, 0, 6);
+    //贴上最新完成的一帧，还没有时只清屏
+    const GaugeRenderThread::Frame &frame=renderThread->latestFrame(this);
+    glViewport(0, 0, request.fboSize.width(), request.fboSize.height());
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    if(!frame.texture)
+        return;
+    glDisable(GL_BLEND);
+    blitter.bind();
+    blitter.blit(frame.texture, QMatrix4x4(), QOpenGLTextureBlitter::OriginBottomLeft);
+    blitter.release();
+}
 
-    vao.release();
-    shaderProgram.release();
+void CircleProgressBar::drawLive(float progress, float time)
+{
+    //QOpenGLWidget的帧缓冲按设备像素分配
+    const qreal ratio=devicePixelRatioF();
+    const QSize pixel_size(qRound(width()*ratio),qRound(height()*ratio));
+    renderer.setPixelScale(float(ratio));
+    if(!adaptiveResolution){
+        renderer.render(pixel_size.width(),pixel_size.height(),progress,time);
+        return;
+    }
+    //仪表本体画到缩小的FBO再放大，文字按原分辨率绘制
+    QOpenGLFramebufferObject *fbo=resolution.begin(pixel_size);
+    renderer.setPixelScale(float(ratio*resolution.scale()));
+    renderer.renderGauge(fbo->width(),fbo->height(),progress,time);
+    resolution.end(defaultFramebufferObject());
+    renderer.setPixelScale(float(ratio));
+    renderer.renderLabel(pixel_size.width(),pixel_size.height(),progress);
+}
 
-    //目前文字用QPainter绘制
-    QPainter painter(this);
-    painter.setPen(Qt::white);
-    painter.setFont(QFont("Microsoft YaHei",16));
-    const QString text_val=QString::number(progress*100,'f',2)+" %";
-    const int text_x=width()/2-painter.fontMetrics().width(text_val)/2;
-    const int text_y=height()/2+painter.fontMetrics().height()/2;
-    painter.drawText(text_x,text_y,text_val);
+void CircleProgressBar::trackBackingMemory(int width, int height)
+{
+    //QOpenGLWidget的帧缓冲按设备像素分配，带深度模板，多重采样时另有一个解析用的颜色缓冲
+    const qreal ratio=devicePixelRatioF();
+    const QSize pixel_size(qRound(width*ratio),qRound(height*ratio));
+    GaugeMemory::instance()->track(backingMemory,this,GaugeMemory::Framebuffer,
+                                   QString("widget framebuffer %1x%2").arg(pixel_size.width()).arg(pixel_size.height()),
+                                   GaugeMemory::framebufferBytes(pixel_size,true,format().samples(),GaugeSurface::bytesPerPixel(surfaceMode)));
 }
 
 void CircleProgressBar::resizeGL(int width, int height)
 {
+    trackBackingMemory(width,height);
+    cacheValid=false;
     //以短边为边长，保持比例，Qt这里有个问题，在resize里设置的没用
     const int item_w=width>height?height:width;
     glViewport((width-item_w)/2,
@@ -212,3 +496,22 @@ void CircleProgressBar::resizeGL(int width, int height)
                item_w,
                item_w);
 }
+
+float CircleProgressBar::normalizedProgress(double value) const
+{
+    //把进度[min,max]归一化[0,1]
+    return (value-progressMin)/(progressMax-progressMin);
+}
+
+bool CircleProgressBar::isVisibleChange(double value) const
+{
+    if(paintedProgress<0)
+        return true;
+    const float progress=normalizedProgress(value);
+    //文字精确到0.01%
+    if(qRound(progress*10000)!=qRound(paintedProgress*10000))
+        return true;
+    //进度端点在外圈(半径0.9)上移动的弧长，不到半个像素看不出来
+    const double item_px=qMin(width(),height())*devicePixelRatioF();
+    return std::abs(progress-paintedProgress)*3.14159265*0.9*item_px>=0.5;
+}
@@ -1,11 +1,22 @@
 #pragma once
 #include <QOpenGLWidget>
 #include <QOpenGLFunctions_3_3_Core>
-#include <QOpenGLShaderProgram>
-#include <QOpenGLVertexArrayObject>
-#include <QOpenGLBuffer>
+#include <QOpenGLFramebufferObject>
+#include <QOpenGLTextureBlitter>
+#include "CircleProgressRenderer.h"
+#include "GaugeProfiler.h"
+#include "GaugeRecorder.h"
+#include "GaugeRenderThread.h"
+#include "GaugeResolutionScaler.h"
+#include "GaugeMemory.h"
+#include "GaugeSurface.h"
+#include "GaugeFrameDriver.h"
+#include "GaugeValueFeed.h"
+#include "GaugeDataSource.h"
+#include "GaugeEasing.h"
 
 #include <QPropertyAnimation>
+#include <QElapsedTimer>
 
 //龚建波：环形进度条
 class CircleProgressBar : public QOpenGLWidget, protected QOpenGLFunctions_3_3_Core
@@ -18,10 +29,63 @@ public:
 
     void setRange(double min,double max);
     void setValue(double value);
+    //可在任意线程调用的setValue，高频写入时每帧只取最新值，不会每次重启动画
+    //调用线程需在控件析构前停止写入
+    void postValue(double value);
+    //绑定数据源，每帧从中取一次值，nullptr解除绑定；不转移所有权，数据源需比绑定更长寿
+    void setDataSource(GaugeDataSource *source);
+    GaugeDataSource *getDataSource() const;
 
     double getDrawValue() const;
     void setDrawValue(double value);
 
+    //画质档位，默认跟随GaugeShaders的全局设置
+    void setQuality(GaugeShaders::Quality quality);
+    GaugeShaders::Quality getQuality() const;
+
+    //百分比文字的字体，默认QFont("Microsoft YaHei",16)
+    void setLabelFont(const QFont &font);
+    QFont getLabelFont() const;
+
+    //只绘制仪表覆盖的圆环/圆盘网格，减少片元着色器的执行次数，默认关闭
+    void setMeshGeometryEnabled(bool enable);
+    bool isMeshGeometryEnabled() const;
+
+    //在工作线程绘制，默认关闭。开启后paintGL只提交参数并贴上最新完成的一帧，GL绘制和文字不占GUI线程
+    //工作线程画完时再刷新一次；GPU缓动时进度在CPU上计算后交给工作线程
+    bool setThreadedRenderingEnabled(bool enable);
+    bool isThreadedRenderingEnabled() const;
+
+    //自适应分辨率，默认关闭。仪表本体按resolutionScaler()的预算降低内部分辨率绘制后放大，文字仍按原分辨率绘制
+    //只作用于动画过程中的逐帧绘制，静止时的缓存仍按原分辨率
+    void setAdaptiveResolutionEnabled(bool enable);
+    bool isAdaptiveResolutionEnabled() const;
+    GaugeResolutionScaler *resolutionScaler();
+
+    //表面格式，默认不修改，需要在控件第一次显示前设置，见GaugeSurface
+    void setSurfaceMode(GaugeSurface::Mode mode);
+    GaugeSurface::Mode getSurfaceMode() const;
+
+    //GaugeMemory中登记在本控件名下的显存估算，不含共享的着色器和顶点
+    qint64 gpuMemoryBytes() const;
+
+    //帧耗时统计，默认关闭，结果见profiler()的statsUpdated信号
+    void setProfilingEnabled(bool enable);
+    bool isProfilingEnabled() const;
+    GaugeProfiler *profiler() const;
+    //录制画面，见GaugeRecorder::start
+    GaugeRecorder *recorder() const;
+
+    //GPU缓动，默认关闭。开启后不再用属性动画逐帧设置drawValue，
+    //只在setValue时更新一次缓动参数，进度由着色器按时间计算，CPU只请求帧
+    //动画曲线须为GaugeEasing支持的类型，否则保持属性动画并返回false
+    bool setGpuEasingEnabled(bool enable);
+    bool isGpuEasingEnabled() const;
+    //交给全局的GaugeAnimator推进动画，默认关闭
+    //同屏仪表很多时不再每个控件一个QPropertyAnimation逐帧派发，只在值变化时刷新；与GPU缓动互斥
+    void setSharedAnimationEnabled(bool enable);
+    bool isSharedAnimationEnabled() const;
+
 protected:
     //设置OpenGL资源和状态。在第一次调用resizeGL或paintGL之前被调用一次
     void initializeGL() override;
@@ -31,14 +95,60 @@ protected:
     void resizeGL(int width, int height) override;
 
 private:
-    //着色器程序
-    QOpenGLShaderProgram shaderProgram;
-    //顶点数组对象
-    QOpenGLVertexArrayObject vao;
-    //顶点缓冲
-    QOpenGLBuffer vbo;
+    //缓动时钟的当前时间，秒
+    double easingNow() const;
+    //把进度[min,max]归一化[0,1]
+    float normalizedProgress(double value) const;
+    //交给工作线程绘制并贴上最新完成的一帧
+    void drawThreaded(float progress,float time);
+    //在GUI线程逐帧绘制，开启自适应分辨率时经内部FBO放大
+    void drawLive(float progress,float time);
+    //按尺寸更新控件帧缓冲的显存登记
+    void trackBackingMemory(int width,int height);
+    //与上次绘制相比能否看出变化
+    bool isVisibleChange(double value) const;
+    //绘制一帧，running时直接绘制，否则走静态缓存，返回渲染器是否实际绘制
+    bool drawFrame(float progress,bool running);
+
+private:
+    //着色器和绘制流程
+    CircleProgressRenderer renderer;
+    //静态帧缓存，动画停下后绘制一次，之后直接贴图，直到进度、尺寸或样式改变
+    QOpenGLFramebufferObject *cacheFbo{ nullptr };
+    QOpenGLTextureBlitter blitter;
+    bool cacheValid{ false };
+    GaugeShaders::Quality cacheQuality{ GaugeShaders::QualityDefault };
+    //上次实际绘制的归一化进度，小于0表示还没绘制过
+    float paintedProgress{ -1 };
     //属性动画
     QPropertyAnimation *animation{ nullptr };
+    //跨线程写入的最新值
+    GaugeValueFeed valueFeed;
+    //GPU缓动的参数，进度已归一化，时间取easingClock
+    bool gpuEasing{ false };
+    GaugeEasing easing;
+    QElapsedTimer easingClock;
+    //GaugeAnimator中的句柄，未启用时为-1
+    int animatorHandle{ -1 };
+    //绑定的数据源
+    GaugeDataSource *dataSource{ nullptr };
+    //绑定数据源后持续出帧以便每帧取值，未绑定时为nullptr
+    GaugeFrameDriver *sourceDriver{ nullptr };
+    //帧耗时统计
+    GaugeProfiler *frameProfiler{ nullptr };
+    //画面录制
+    GaugeRecorder *frameRecorder{ nullptr };
+    GaugeSurface::Mode surfaceMode{ GaugeSurface::Default };
+    //显存登记
+    int backingMemory{ -1 };
+    int cacheMemory{ -1 };
+    //自适应分辨率
+    bool adaptiveResolution{ false };
+    GaugeResolutionScaler resolution;
+    //工作线程绘制，未启用时为nullptr
+    GaugeRenderThread *renderThread{ nullptr };
+    //上次提交给工作线程的参数
+    GaugeRenderThread::FrameRequest threadRequest;
     //进度值
     double progressMin{ 0 };
     double progressMax{ 100 };
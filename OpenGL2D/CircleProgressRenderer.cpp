@@ -0,0 +1,19 @@
+#include "CircleProgressRenderer.h"
+
+GaugeShaders::Program CircleProgressRenderer::programType() const
+{
+    //着色器代码见GaugeShaders
+    return GaugeShaders::CircleProgram;
+}
+
+QColor CircleProgressRenderer::clearColor() const
+{
+    return QColor::fromRgbF(0.1,0.2,0.3);
+}
+
+void CircleProgressRenderer::coverage(float smoothWidth, float &inner, float &outer) const
+{
+    //与circleColor的alpha一致：|len-0.75|<0.15+smoothWidth
+    inner=0.6f-smoothWidth;
+    outer=0.9f+smoothWidth;
+}
@@ -0,0 +1,12 @@
+#pragma once
+#include "ProgressRenderer.h"
+
+//环形进度条的绘制
+class CircleProgressRenderer : public ProgressRenderer
+{
+protected:
+    GaugeShaders::Program programType() const override;
+    QColor clearColor() const override;
+    //圆环[0.6,0.9]
+    void coverage(float smoothWidth,float &inner,float &outer) const override;
+};
@@ -0,0 +1,264 @@
+#include "GLCapabilities.h"
+
+#include <QGuiApplication>
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
+#include <QOffscreenSurface>
+#include <QSurfaceFormat>
+#include <QSettings>
+#include <QCryptographicHash>
+#include <QMutex>
+#include <QAtomicInt>
+#include <QDebug>
+
+#ifndef GL_MAX_SAMPLES
+#define GL_MAX_SAMPLES 0x8D57
+#endif
+
+//缓存格式版本，增删字段时加一，旧缓存自动失效
+static const int cache_format=2;
+
+static QMutex current_mutex;
+static GLCapabilities current_caps;
+static bool current_loaded=false;
+static QAtomicInt revalidated(0);
+
+GLCapabilities GLCapabilities::load()
+{
+    GLCapabilities caps;
+    if(!readCache(caps)){
+        caps=probe();
+        //探测失败可能只是没有屏幕或驱动临时出错，不缓存，下次启动再试
+        if(caps.valid)
+            writeCache(caps);
+    }
+    QMutexLocker locker(&current_mutex);
+    current_caps=caps;
+    current_loaded=true;
+    return caps;
+}
+
+GLCapabilities GLCapabilities::probe()
+{
+    GLCapabilities caps;
+    //一般需要先构造一个QGuiApplication有些函数才能调用
+    if(!QGuiApplication::primaryScreen())
+        return caps;
+    //按控件实际使用的格式请求，驱动不支持3.3 Core时Qt会退回到它能创建的版本
+    QSurfaceFormat format=QSurfaceFormat::defaultFormat();
+    format.setRenderableType(QSurfaceFormat::OpenGL);
+    format.setMajorVersion(3);
+    format.setMinorVersion(3);
+    format.setProfile(QSurfaceFormat::CoreProfile);
+    QOffscreenSurface surface;
+    surface.setFormat(format);
+    surface.create();
+    QOpenGLContext context;
+    context.setFormat(format);
+    if(!context.create()||!context.makeCurrent(&surface))
+        return caps;
+    caps=fromCurrentContext();
+    context.doneCurrent();
+    surface.destroy();
+    return caps;
+}
+
+GLCapabilities GLCapabilities::current()
+{
+    QMutexLocker locker(&current_mutex);
+    return current_caps;
+}
+
+void GLCapabilities::revalidate()
+{
+    if(!revalidated.testAndSetRelaxed(0,1))
+        return;
+    if(!QOpenGLContext::currentContext())
+        return;
+    GLCapabilities caps=fromCurrentContext();
+    if(!caps.valid)
+        return;
+    QMutexLocker locker(&current_mutex);
+    //本进程没有调用load()，比如基准测试，不动缓存
+    if(!current_loaded||caps.driverString()==current_caps.driverString())
+        return;
+    //驱动更新或换了显卡，本次已经按旧结果选好后端，下次启动用新结果
+    qDebug()<<"OpenGL driver changed:"<<current_caps.driverString()<<"->"<<caps.driverString();
+    writeCache(caps);
+}
+
+GaugeBackend::Backend GLCapabilities::backend() const
+{
+    return GaugeBackend::select(majorVersion,minorVersion);
+}
+
+GaugeShaders::Quality GLCapabilities::quality() const
+{
+    //CPU实现的GL按像素算着色器，用最低档
+    if(softwareRasterizer)
+        return GaugeShaders::QualityLow;
+    //只支持3.x的一般是老集显
+    if(majorVersion<4)
+        return GaugeShaders::QualityMedium;
+    return GaugeShaders::QualityHigh;
+}
+
+QString GLCapabilities::driverString() const
+{
+    QString ver=version;
+    ver.remove(QStringLiteral("(Core Profile) "));
+    ver.remove(QStringLiteral("(Compatibility Profile) "));
+    return vendor+QStringLiteral("|")+renderer+QStringLiteral("|")+ver;
+}
+
+bool GLCapabilities::parseVersion(const QByteArray &versionString, int &major, int &minor)
+{
+    bool majorOk = false;
+    bool minorOk = false;
+    QList<QByteArray> parts = versionString.split(' ');
+    if (versionString.startsWith(QByteArrayLiteral("OpenGL ES"))) {
+        if (parts.size() >= 3) {
+            QList<QByteArray> versionParts = parts.at(2).split('.');
+            if (versionParts.size() >= 2) {
+                major = versionParts.at(0).toInt(&majorOk);
+                minor = versionParts.at(1).toInt(&minorOk);
+                // Nexus 6 has "OpenGL ES 3.0V@95.0 (GIT@I86da836d38)"
+                if (!minorOk)
+                    if (int idx = versionParts.at(1).indexOf('V'))
+                        minor = versionParts.at(1).left(idx).toInt(&minorOk);
+            } else {
+                qWarning("Unrecognized OpenGL ES version");
+            }
+        } else {
+            // If < 3 parts to the name, it is an unrecognised OpenGL ES
+            qWarning("Unrecognised OpenGL ES version");
+        }
+    } else {
+        // Not OpenGL ES, but regular OpenGL, the version numbers are first in the string
+        QList<QByteArray> versionParts = parts.at(0).split('.');
+        if (versionParts.size() >= 2) {
+            major = versionParts.at(0).toInt(&majorOk);
+            minor = versionParts.at(1).toInt(&minorOk);
+        } else {
+            qWarning("Unrecognized OpenGL version");
+        }
+    }
+
+    if (!majorOk || !minorOk)
+        qWarning("Unrecognized OpenGL version");
+    return (majorOk && minorOk);
+}
+
+GLCapabilities GLCapabilities::fromCurrentContext()
+{
+    GLCapabilities caps;
+    QOpenGLContext *context=QOpenGLContext::currentContext();
+    if(!context)
+        return caps;
+    QOpenGLFunctions *gl=context->functions();
+    auto gl_string=[gl](GLenum name){
+        const GLubyte *str=gl->glGetString(name);
+        return str?QString::fromLatin1(reinterpret_cast<const char*>(str)):QString();
+    };
+    caps.vendor=gl_string(GL_VENDOR);
+    caps.renderer=gl_string(GL_RENDERER);
+    caps.version=gl_string(GL_VERSION);
+    if(!parseVersion(caps.version.toLatin1(),caps.majorVersion,caps.minorVersion)){
+        caps.majorVersion=0;
+        caps.minorVersion=0;
+    }
+    caps.valid=!caps.version.isEmpty();
+
+    const QString renderer=caps.renderer.toLower();
+    static const char *software_names[]={
+        "llvmpipe","softpipe","swrast","software rasterizer",
+        "gdi generic","microsoft basic render","swiftshader"
+    };
+    for(const char *name:software_names){
+        if(renderer.contains(QLatin1String(name))){
+            caps.softwareRasterizer=true;
+            break;
+        }
+    }
+
+    const bool gl33=caps.majorVersion*10+caps.minorVersion>=33;
+    if(gl33||context->hasExtension(QByteArrayLiteral("GL_ARB_framebuffer_object"))){
+        GLint samples=0;
+        gl->glGetIntegerv(GL_MAX_SAMPLES,&samples);
+        caps.maxSamples=samples;
+    }
+    caps.timerQuery=gl33||context->hasExtension(QByteArrayLiteral("GL_ARB_timer_query"));
+    caps.instancing=gl33||(context->hasExtension(QByteArrayLiteral("GL_ARB_instanced_arrays"))&&
+                           context->hasExtension(QByteArrayLiteral("GL_ARB_draw_instanced")));
+    caps.rgb565=context->isOpenGLES()||caps.majorVersion*10+caps.minorVersion>=41||
+            context->hasExtension(QByteArrayLiteral("GL_ARB_ES2_compatibility"));
+    return caps;
+}
+
+QString GLCapabilities::cacheGroup()
+{
+    QStringList parts;
+    parts<<QGuiApplication::platformName()<<QString::fromLatin1(qVersion());
+    //这些设置会让Qt或Mesa选择不同的驱动
+    parts<<QString::number(QCoreApplication::testAttribute(Qt::AA_UseDesktopOpenGL))
+         <<QString::number(QCoreApplication::testAttribute(Qt::AA_UseOpenGLES))
+         <<QString::number(QCoreApplication::testAttribute(Qt::AA_UseSoftwareOpenGL));
+    static const char *env_names[]={
+        "QT_OPENGL","LIBGL_ALWAYS_SOFTWARE","GALLIUM_DRIVER","MESA_LOADER_DRIVER_OVERRIDE",
+        "__GLX_VENDOR_LIBRARY_NAME","DISPLAY","WAYLAND_DISPLAY"
+    };
+    for(const char *name:env_names)
+        parts<<QString::fromLocal8Bit(qgetenv(name));
+    const QByteArray hash=QCryptographicHash::hash(parts.join('|').toUtf8(),QCryptographicHash::Sha1);
+    return QStringLiteral("probe_")+QString::fromLatin1(hash.toHex().left(16));
+}
+
+bool GLCapabilities::readCache(GLCapabilities &caps)
+{
+    QSettings settings(QSettings::IniFormat,QSettings::UserScope,
+                       QStringLiteral("EasyOpenGL2D"),QStringLiteral("GLCapabilities"));
+    settings.beginGroup(cacheGroup());
+    if(settings.value(QStringLiteral("format")).toInt()!=cache_format)
+        return false;
+    caps.valid=settings.value(QStringLiteral("valid")).toBool();
+    caps.fromCache=true;
+    caps.vendor=settings.value(QStringLiteral("vendor")).toString();
+    caps.renderer=settings.value(QStringLiteral("renderer")).toString();
+    caps.version=settings.value(QStringLiteral("version")).toString();
+    caps.majorVersion=settings.value(QStringLiteral("major")).toInt();
+    caps.minorVersion=settings.value(QStringLiteral("minor")).toInt();
+    caps.softwareRasterizer=settings.value(QStringLiteral("software")).toBool();
+    caps.maxSamples=settings.value(QStringLiteral("maxSamples")).toInt();
+    caps.timerQuery=settings.value(QStringLiteral("timerQuery")).toBool();
+    caps.instancing=settings.value(QStringLiteral("instancing")).toBool();
+    caps.rgb565=settings.value(QStringLiteral("rgb565")).toBool();
+    //旧版本写入的失败结果不用
+    if(!caps.valid)
+        return false;
+    //不到3.3的结果会选CPU后端，不会创建GL控件，revalidate()没有机会核对，
+    //每次启动都重新探测，驱动升级后马上回到GL
+    if(caps.majorVersion*10+caps.minorVersion<33)
+        return false;
+    //驱动字符串和字段对不上说明缓存被改坏了
+    return settings.value(QStringLiteral("driver")).toString()==caps.driverString();
+}
+
+void GLCapabilities::writeCache(const GLCapabilities &caps)
+{
+    QSettings settings(QSettings::IniFormat,QSettings::UserScope,
+                       QStringLiteral("EasyOpenGL2D"),QStringLiteral("GLCapabilities"));
+    settings.beginGroup(cacheGroup());
+    settings.setValue(QStringLiteral("format"),cache_format);
+    settings.setValue(QStringLiteral("valid"),caps.valid);
+    settings.setValue(QStringLiteral("driver"),caps.driverString());
+    settings.setValue(QStringLiteral("vendor"),caps.vendor);
+    settings.setValue(QStringLiteral("renderer"),caps.renderer);
+    settings.setValue(QStringLiteral("version"),caps.version);
+    settings.setValue(QStringLiteral("major"),caps.majorVersion);
+    settings.setValue(QStringLiteral("minor"),caps.minorVersion);
+    settings.setValue(QStringLiteral("software"),caps.softwareRasterizer);
+    settings.setValue(QStringLiteral("maxSamples"),caps.maxSamples);
+    settings.setValue(QStringLiteral("timerQuery"),caps.timerQuery);
+    settings.setValue(QStringLiteral("instancing"),caps.instancing);
+    settings.setValue(QStringLiteral("rgb565"),caps.rgb565);
+}
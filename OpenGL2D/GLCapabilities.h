@@ -0,0 +1,53 @@
+#pragma once
+#include <QString>
+#include <QByteArray>
+#include "GaugeBackend.h"
+#include "GaugeShaders.h"
+
+//OpenGL能力探测
+//启动时创建临时上下文读取版本、厂商、采样数和扩展，结果按运行环境缓存到磁盘
+//之后的启动直接读缓存，不再创建上下文；缓存记录驱动字符串，
+//控件第一次初始化时用真实上下文核对，驱动变了就更新缓存，下次启动生效
+//探测失败不缓存；不到3.3（会选CPU后端，没有GL控件核对）的结果不从缓存读取，每次启动重新探测
+class GLCapabilities
+{
+public:
+    bool valid{ false };            //探测成功
+    bool fromCache{ false };        //本次由缓存读取
+    QString vendor;
+    QString renderer;
+    QString version;
+    int majorVersion{ 0 };
+    int minorVersion{ 0 };
+    bool softwareRasterizer{ false }; //llvmpipe、GDI Generic等CPU实现
+    int maxSamples{ 0 };
+    bool timerQuery{ false };       //GL_TIME_ELAPSED查询，GaugeProfiler使用
+    bool instancing{ false };       //实例化绘制，GaugeCanvas使用
+    bool rgb565{ false };           //RGB565颜色缓冲，GaugeSurface的16位模式使用
+
+    //读缓存，没有或不可用时探测并写入缓存，需要QGuiApplication
+    static GLCapabilities load();
+    //不看缓存，创建临时上下文探测
+    static GLCapabilities probe();
+    //load()的结果
+    static GLCapabilities current();
+    //在当前上下文上核对驱动字符串，和缓存不一致时更新缓存，每个进程只核对一次
+    static void revalidate();
+
+    //根据能力选择后端和画质档位
+    GaugeBackend::Backend backend() const;
+    GaugeShaders::Quality quality() const;
+    //厂商、渲染器、版本拼成的驱动字符串，去掉了Core/Compatibility Profile的区别
+    QString driverString() const;
+
+    //解析字符串中的opengl版本号
+    static bool parseVersion(const QByteArray &versionString, int &major, int &minor);
+
+private:
+    //从当前上下文读取
+    static GLCapabilities fromCurrentContext();
+    //缓存分组名，由平台、Qt版本和影响驱动选择的环境变量决定
+    static QString cacheGroup();
+    static bool readCache(GLCapabilities &caps);
+    static void writeCache(const GLCapabilities &caps);
+};
@@ -0,0 +1,280 @@
+#include "GLResourceCache.h"
+#include "GaugeMemory.h"
+
+#include <QOpenGLContext>
+#include <QOpenGLPixelTransferOptions>
+#include <QMutexLocker>
+#include <QThread>
+#include <QThreadStorage>
+#include <QDebug>
+
+#include <cmath>
+
+//开启了独立程序的线程
+static QThreadStorage<bool> thread_private_programs;
+
+GLResourceCache *GLResourceCache::instance()
+{
+    static GLResourceCache cache;
+    return &cache;
+}
+
+GLResourceCache::GLResourceCache(QObject *parent)
+    : QObject(parent)
+{
+}
+
+QSharedPointer<QOpenGLShaderProgram> GLResourceCache::program(const QString &key,
+                                                              const char *vertex_str,
+                                                              const char *fragment_str)
+{
+    //独立的程序按线程区分键值
+    QString cache_key=key;
+    if(thread_private_programs.hasLocalData()&&thread_private_programs.localData())
+        cache_key+=QString("@%1").arg(quintptr(QThread::currentThread()),0,16);
+    QMutexLocker locker(&mutex);
+    GroupCache *group=currentGroup();
+    if(!group)
+        return QSharedPointer<QOpenGLShaderProgram>();
+
+    QSharedPointer<QOpenGLShaderProgram> shader_program;
+    for(;;){
+        shader_program=group->programs.value(cache_key).toStrongRef();
+        if(shader_program){
+            hits.ref();
+            return shader_program;
+        }
+        if(!group->compiling.contains(cache_key))
+            break;
+        //同组的另一个线程正在编译同一个程序，等它放进缓存，失败时由这里重新编译
+        programCompiled.wait(&mutex);
+        group=currentGroup();
+        if(!group)
+            return QSharedPointer<QOpenGLShaderProgram>();
+    }
+    misses.ref();
+    group->compiling.insert(cache_key);
+    //编译链接可能要几十毫秒，期间不持锁，预编译线程不会挡住GUI线程取其他资源
+    locker.unlock();
+
+    shader_program=QSharedPointer<QOpenGLShaderProgram>::create();
+    bool compiled=true;
+    //将source编译为指定类型的着色器，并添加到此着色器程序
+    if(!shader_program->addCacheableShaderFromSourceCode(
+                QOpenGLShader::Vertex,vertex_str)){
+        qDebug()<<"compiler vertex error"<<key<<shader_program->log();
+        compiled=false;
+    }
+    if(!shader_program->addCacheableShaderFromSourceCode(
+                QOpenGLShader::Fragment,fragment_str)){
+        qDebug()<<"compiler fragment error"<<key<<shader_program->log();
+        compiled=false;
+    }
+    //使用addShader()将添加到该程序的着色器链接在一起。
+    if(!shader_program->link()){
+        qDebug()<<"link shaderprogram error"<<key<<shader_program->log();
+        compiled=false;
+    }
+    //驱动内部的程序大小查不到，只登记对象；0字节不会触发预算信号
+    const int memory_handle=GaugeMemory::instance()->reserve(nullptr,GaugeMemory::Program,cache_key);
+    QObject::connect(shader_program.data(),&QObject::destroyed,[memory_handle]{
+        int handle=memory_handle;
+        GaugeMemory::instance()->untrack(handle);
+    });
+
+    locker.relock();
+    //解锁期间groups可能增删过，重新取
+    group=currentGroup();
+    if(group){
+        group->compiling.remove(cache_key);
+        //失败的程序不缓存，以免之后一直拿到坏的程序
+        if(compiled)
+            group->programs.insert(cache_key,shader_program);
+    }
+    programCompiled.wakeAll();
+    return shader_program;
+}
+
+void GLResourceCache::setThreadPrivatePrograms(bool enable)
+{
+    thread_private_programs.setLocalData(enable);
+}
+
+QSharedPointer<QOpenGLBuffer> GLResourceCache::quadBuffer()
+{
+    QMutexLocker locker(&mutex);
+    GroupCache *group=currentGroup();
+    if(!group)
+        return QSharedPointer<QOpenGLBuffer>();
+
+    QSharedPointer<QOpenGLBuffer> buffer=group->quad.toStrongRef();
+    if(buffer){
+        hits.ref();
+        return buffer;
+    }
+    misses.ref();
+
+    //两个三角拼接的一个矩形
+    const float vertices[] = {
+        -1.0f, -1.0f, //左下角
+        +1.0f, -1.0f, //右下角
+        +1.0f, +1.0f, //右上角
+
+        +1.0f, +1.0f, //右上角
+        -1.0f, +1.0f, //左上角
+        -1.0f, -1.0f, //左下角
+    };
+    int memory_handle=-1;
+    buffer=trackedBuffer("quad vertices",memory_handle);
+    buffer->create();
+    buffer->bind();
+    buffer->allocate(vertices,sizeof(vertices));
+    buffer->release();
+    group->quad=buffer;
+    //budgetExceeded的槽可能再调用缓存，解锁后再登记字节数
+    locker.unlock();
+    GaugeMemory::instance()->track(memory_handle,nullptr,GaugeMemory::Buffer,"quad vertices",sizeof(vertices));
+    return buffer;
+}
+
+QSharedPointer<QOpenGLBuffer> GLResourceCache::ringBuffer(int segments)
+{
+    QMutexLocker locker(&mutex);
+    GroupCache *group=currentGroup();
+    if(!group||segments<3)
+        return QSharedPointer<QOpenGLBuffer>();
+
+    QSharedPointer<QOpenGLBuffer> buffer=group->rings.value(segments).toStrongRef();
+    if(buffer){
+        hits.ref();
+        return buffer;
+    }
+    misses.ref();
+
+    QVector<float> vertices;
+    vertices.reserve(segments*6*3);
+    for(int i=0;i<segments;i++){
+        const double a0=2.0*3.14159265358979*i/segments;
+        const double a1=2.0*3.14159265358979*(i+1)/segments;
+        const float x0=float(std::cos(a0)), y0=float(std::sin(a0));
+        const float x1=float(std::cos(a1)), y1=float(std::sin(a1));
+        //内0,外0,外1 / 内0,外1,内1
+        vertices<<x0<<y0<<0.0f<<x0<<y0<<1.0f<<x1<<y1<<1.0f;
+        vertices<<x0<<y0<<0.0f<<x1<<y1<<1.0f<<x1<<y1<<0.0f;
+    }
+    const QString name=QString("ring vertices %1").arg(segments);
+    int memory_handle=-1;
+    buffer=trackedBuffer(name,memory_handle);
+    buffer->create();
+    buffer->bind();
+    buffer->allocate(vertices.constData(),int(vertices.size()*sizeof(float)));
+    buffer->release();
+    group->rings.insert(segments,buffer);
+    //budgetExceeded的槽可能再调用缓存，解锁后再登记字节数
+    locker.unlock();
+    GaugeMemory::instance()->track(memory_handle,nullptr,GaugeMemory::Buffer,name,qint64(vertices.size()*sizeof(float)));
+    return buffer;
+}
+
+QSharedPointer<QOpenGLTexture> GLResourceCache::texture(const QString &key, const QImage &image)
+{
+    QMutexLocker locker(&mutex);
+    GroupCache *group=currentGroup();
+    if(!group)
+        return QSharedPointer<QOpenGLTexture>();
+
+    QSharedPointer<QOpenGLTexture> gl_texture=group->textures.value(key).toStrongRef();
+    if(gl_texture){
+        hits.ref();
+        return gl_texture;
+    }
+    misses.ref();
+
+    //释放时注销GaugeMemory的登记
+    const qint64 texture_bytes=qint64(image.width())*image.height()*(image.format()==QImage::Format_Grayscale8?1:4);
+    int memory_handle=GaugeMemory::instance()->reserve(nullptr,GaugeMemory::Texture,key);
+    gl_texture=QSharedPointer<QOpenGLTexture>(new QOpenGLTexture(QOpenGLTexture::Target2D),
+                                              [memory_handle](QOpenGLTexture *texture){
+        int handle=memory_handle;
+        GaugeMemory::instance()->untrack(handle);
+        delete texture;
+    });
+    if(image.format()==QImage::Format_Grayscale8){
+        //单通道直接上传，不经过RGBA转换
+        gl_texture->setFormat(QOpenGLTexture::R8_UNorm);
+        gl_texture->setSize(image.width(),image.height());
+        gl_texture->setMipLevels(1);
+        gl_texture->allocateStorage(QOpenGLTexture::Red,QOpenGLTexture::UInt8);
+        QOpenGLPixelTransferOptions options;
+        options.setAlignment(1);
+        options.setRowLength(image.bytesPerLine());
+        gl_texture->setData(QOpenGLTexture::Red,QOpenGLTexture::UInt8,image.constBits(),&options);
+    }else{
+        gl_texture->setData(image,QOpenGLTexture::DontGenerateMipMaps);
+    }
+    gl_texture->setMinMagFilters(QOpenGLTexture::Linear,QOpenGLTexture::Linear);
+    gl_texture->setWrapMode(QOpenGLTexture::ClampToEdge);
+    group->textures.insert(key,gl_texture);
+    //budgetExceeded的槽可能再调用缓存，解锁后再登记字节数
+    locker.unlock();
+    GaugeMemory::instance()->track(memory_handle,nullptr,GaugeMemory::Texture,key,texture_bytes);
+    return gl_texture;
+}
+
+QSharedPointer<QOpenGLBuffer> GLResourceCache::trackedBuffer(const QString &name, int &memoryHandle)
+{
+    //释放时注销GaugeMemory的登记
+    const int memory_handle=GaugeMemory::instance()->reserve(nullptr,GaugeMemory::Buffer,name);
+    memoryHandle=memory_handle;
+    return QSharedPointer<QOpenGLBuffer>(new QOpenGLBuffer(QOpenGLBuffer::VertexBuffer),
+                                         [memory_handle](QOpenGLBuffer *buffer){
+        int handle=memory_handle;
+        GaugeMemory::instance()->untrack(handle);
+        delete buffer;
+    });
+}
+
+void GLResourceCache::retain(const QSharedPointer<QOpenGLShaderProgram> &program)
+{
+    QMutexLocker locker(&mutex);
+    GroupCache *group=currentGroup();
+    if(!group||!program||group->retained.contains(program))
+        return;
+    group->retained.append(program);
+}
+
+int GLResourceCache::hitCount() const
+{
+    return hits.loadAcquire();
+}
+
+int GLResourceCache::missCount() const
+{
+    return misses.loadAcquire();
+}
+
+void GLResourceCache::resetCounters()
+{
+    hits.storeRelease(0);
+    misses.storeRelease(0);
+}
+
+GLResourceCache::GroupCache *GLResourceCache::currentGroup()
+{
+    QOpenGLContext *context=QOpenGLContext::currentContext();
+    if(!context){
+        qWarning()<<"GLResourceCache: no current context";
+        return nullptr;
+    }
+    QOpenGLContextGroup *share_group=context->shareGroup();
+    auto iter=groups.find(share_group);
+    if(iter==groups.end()){
+        //共享组随最后一个上下文销毁，组内资源此时已由Qt释放，这里只清理记录
+        connect(share_group,&QObject::destroyed,this,[this,share_group]{
+            QMutexLocker locker(&mutex);
+            groups.remove(share_group);
+        },Qt::DirectConnection);
+        iter=groups.insert(share_group,GroupCache());
+    }
+    return &iter.value();
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include <QObject>
+#include <QOpenGLShaderProgram>
+#include <QOpenGLBuffer>
+#include <QOpenGLTexture>
+#include <QImage>
+#include <QSharedPointer>
+#include <QWeakPointer>
+#include <QHash>
+#include <QVector>
+#include <QSet>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QAtomicInt>
+
+class QOpenGLContextGroup;
+
+//进程内共享的OpenGL资源缓存
+//按当前上下文的共享组区分，同一组内每个着色器程序只编译链接一次，矩形顶点只上传一次
+//返回引用计数指针，最后一个使用者释放时销毁，释放时应有该组的上下文为当前
+//VAO不能跨上下文共享，仍由各实例自己创建
+class GLResourceCache : public QObject
+{
+    Q_OBJECT
+public:
+    static GLResourceCache *instance();
+
+    //取着色器程序，key相同视为同一程序，未命中时用source编译链接
+    //编译链接时不持锁，其他线程取别的资源不用等；同一组内同一key正在编译时等它完成
+    //编译或链接失败的程序照常返回给这次调用，但不放进缓存，下次再取时重新编译
+    //需要在有当前上下文时调用
+    QSharedPointer<QOpenGLShaderProgram> program(const QString &key,
+                                                 const char *vertex_str,
+                                                 const char *fragment_str);
+    //两个三角拼接的矩形，6个[-1,1]范围的vec2顶点
+    QSharedPointer<QOpenGLBuffer> quadBuffer();
+    //segments段的圆环，每段两个三角共6个vec3顶点：xy为单位方向，z为0内圈、1外圈
+    //半径在顶点着色器里给出，同一段数的网格与尺寸无关
+    QSharedPointer<QOpenGLBuffer> ringBuffer(int segments);
+    //取纹理，未命中时上传image，Grayscale8图像上传为单通道R8
+    QSharedPointer<QOpenGLTexture> texture(const QString &key,const QImage &image);
+
+    //当前线程取到的着色器程序不与其他线程共用，顶点缓冲和纹理仍然共享
+    //uniform是程序对象的状态，两个线程同时用一个程序绘制会互相覆盖，在非GUI线程绘制前开启
+    static void setThreadPrivatePrograms(bool enable);
+
+    //让资源常驻到共享组销毁，预编译的着色器程序用它保持存活
+    //需要在该组的上下文为当前时调用
+    void retain(const QSharedPointer<QOpenGLShaderProgram> &program);
+
+    //命中/未命中计数，包括程序、顶点缓冲和纹理
+    int hitCount() const;
+    int missCount() const;
+    void resetCounters();
+
+private:
+    explicit GLResourceCache(QObject *parent = nullptr);
+
+    //一个共享组内的资源，只保存弱引用，不延长资源生命周期
+    //retained是显式要求常驻的资源，compiling是正在编译、还没放进programs的key
+    struct GroupCache
+    {
+        QHash<QString,QWeakPointer<QOpenGLShaderProgram>> programs;
+        QSet<QString> compiling;
+        QWeakPointer<QOpenGLBuffer> quad;
+        QHash<int,QWeakPointer<QOpenGLBuffer>> rings;
+        QHash<QString,QWeakPointer<QOpenGLTexture>> textures;
+        QVector<QSharedPointer<QOpenGLShaderProgram>> retained;
+    };
+    //当前上下文所在共享组的缓存，调用时需持有mutex，解锁后指针失效，重新取
+    GroupCache *currentGroup();
+    //在GaugeMemory预留登记的顶点缓冲，最后一个引用释放时注销，memoryHandle写回句柄
+    //track可能同步发出budgetExceeded，字节数在释放mutex之后再登记
+    static QSharedPointer<QOpenGLBuffer> trackedBuffer(const QString &name,int &memoryHandle);
+
+private:
+    QHash<QOpenGLContextGroup*,GroupCache> groups;
+    QMutex mutex;
+    //有程序编译完成，等同一个key的线程被唤醒
+    QWaitCondition programCompiled;
+    QAtomicInt hits;
+    QAtomicInt misses;
+};
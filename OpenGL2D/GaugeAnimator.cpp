@@ -0,0 +1,248 @@
+#include "GaugeAnimator.h"
+#include "GaugeSimd.h"
+
+#include <QCoreApplication>
+#include <QGuiApplication>
+#include <QScreen>
+#include <QTimer>
+#include <QWidget>
+
+//开始时间离epoch超过这个秒数时平移，float在64秒内的精度约4微秒
+static const double rebase_interval_s=64.0;
+
+GaugeAnimator *GaugeAnimator::instance()
+{
+    //跟随QCoreApplication析构，定时器不会比事件循环活得长
+    static GaugeAnimator *animator=new GaugeAnimator(QCoreApplication::instance());
+    return animator;
+}
+
+GaugeAnimator::GaugeAnimator(QObject *parent)
+    : QObject(parent)
+{
+    elapsed.start();
+}
+
+int GaugeAnimator::add(QWidget *target)
+{
+    if(freeHandles.isEmpty()){
+        //一次扩一组，保证整组加载不越界
+        const int base=starts.size();
+        const int grow=8;
+        const int size=base+grow;
+        starts.resize(size);
+        ends.resize(size);
+        startTimes.resize(size);
+        invDurations.resize(size);
+        values.resize(size);
+        curves.resize(size);
+        running.resize(size);
+        changed.resize(size);
+        targets.resize(size);
+        for(int i=size-1;i>=base;i--)
+            freeHandles.append(i);
+    }
+    const int handle=freeHandles.takeLast();
+    starts[handle]=0;
+    ends[handle]=0;
+    startTimes[handle]=0;
+    invDurations[handle]=0;
+    values[handle]=0;
+    curves[handle]=GaugeEasing::Linear;
+    running[handle]=0;
+    targets[handle]=target;
+    registered++;
+    return handle;
+}
+
+void GaugeAnimator::remove(int handle)
+{
+    if(handle<0||handle>=targets.size())
+        return;
+    if(running[handle]!=0)
+        active--;
+    running[handle]=0;
+    targets[handle]=nullptr;
+    freeHandles.append(handle);
+    registered--;
+}
+
+void GaugeAnimator::animateTo(int handle, float target, float duration, GaugeEasing::Curve curve)
+{
+    if(handle<0||handle>=targets.size())
+        return;
+    if(duration<=0){
+        jumpTo(handle,target);
+        return;
+    }
+    //单个仪表的重定向用GaugeEasing的同一套公式
+    const float now=relativeTime(clock());
+    GaugeEasing easing;
+    easing.start=starts[handle];
+    easing.end=ends[handle];
+    easing.startTime=startTimes[handle];
+    easing.duration=invDurations[handle]>0?1.0f/invDurations[handle]:0;
+    easing.curve=GaugeEasing::Curve(curves[handle]);
+    //只存了时长的倒数，1/(1/d)不一定等于d，按倒数比较
+    const bool keep=running[handle]!=0&&easing.curve==curve&&invDurations[handle]==1.0f/duration;
+    if(keep){
+        easing.duration=duration;
+    }else{
+        //没在运行，或曲线、时长变了时从当前值重新开始
+        //开始时间放到一个时长之前，retarget看作已结束，从now开始，不沿用旧的开始时间
+        easing.jump(running[handle]!=0?easing.valueAt(now):values[handle]);
+        easing.curve=curve;
+        easing.duration=duration;
+        easing.startTime=now-duration;
+    }
+    easing.retarget(now,target);
+    starts[handle]=easing.start;
+    ends[handle]=easing.end;
+    startTimes[handle]=float(easing.startTime);
+    invDurations[handle]=1.0f/duration;
+    curves[handle]=float(curve);
+    if(running[handle]==0){
+        running[handle]=1;
+        active++;
+    }
+    ensureTimer();
+}
+
+void GaugeAnimator::jumpTo(int handle, float value)
+{
+    if(handle<0||handle>=targets.size())
+        return;
+    if(running[handle]!=0)
+        active--;
+    running[handle]=0;
+    starts[handle]=value;
+    ends[handle]=value;
+    if(values[handle]!=value){
+        values[handle]=value;
+        if(targets[handle])
+            targets[handle]->update();
+    }
+}
+
+float GaugeAnimator::value(int handle) const
+{
+    return handle>=0&&handle<values.size()?values[handle]:0;
+}
+
+bool GaugeAnimator::isRunning(int handle) const
+{
+    return handle>=0&&handle<running.size()&&running[handle]!=0;
+}
+
+int GaugeAnimator::count() const
+{
+    return registered;
+}
+
+int GaugeAnimator::runningCount() const
+{
+    return active;
+}
+
+int GaugeAnimator::bytesPerGauge()
+{
+    return int(sizeof(float)*8+sizeof(QWidget*));
+}
+
+int GaugeAnimator::advance(double time)
+{
+    if(active==0)
+        return 0;
+    const float now=relativeTime(time);
+    using namespace GaugeSimd;
+    const int n=starts.size();
+    const float *start=starts.constData();
+    const float *end=ends.constData();
+    const float *t0=startTimes.constData();
+    const float *inv=invDurations.constData();
+    const float *curve=curves.constData();
+    float *run=running.data();
+    float *value=values.data();
+    float *dirty=changed.data();
+
+    //一次推进FloatN::Size个仪表，曲线用掩码选择，与GaugeEasing::ease一致
+    //停止的仪表保持原值，到终点的同时清掉运行标记
+    const FloatN zero(0.0f);
+    const FloatN one(1.0f);
+    for(int i=0;i<n;i+=FloatN::Size)
+    {
+        const FloatN t=(FloatN(now)-FloatN::load(t0+i))*FloatN::load(inv+i);
+        const FloatN u=vmin(vmax(t,zero),one);
+        const FloatN r=one-u;
+        const FloatN r2=r*r;
+        const FloatN r3=r2*r;
+        const FloatN c=FloatN::load(curve+i);
+        FloatN k=u;
+        k=select(c==FloatN(1.0f),one-r2,k);
+        k=select(c==FloatN(2.0f),one-r3,k);
+        k=select(c==FloatN(3.0f),one-r2*r2,k);
+        k=select(c==FloatN(4.0f),select(u<FloatN(0.5f),FloatN(4.0f)*u*u*u,one-FloatN(4.0f)*r3),k);
+        const FloatN s=FloatN::load(start+i);
+        const FloatN old=FloatN::load(value+i);
+        const FloatN active_mask=FloatN::load(run+i)!=zero;
+        const FloatN next=select(active_mask,s+(FloatN::load(end+i)-s)*k,old);
+        next.store(value+i);
+        select(next!=old,one,zero).store(dirty+i);
+        select(active_mask&(t<one),one,zero).store(run+i);
+    }
+
+    //只处理有变化的仪表
+    int count=0;
+    int still_running=0;
+    for(int i=0;i<n;i++)
+    {
+        still_running+=run[i]!=0;
+        if(dirty[i]==0)
+            continue;
+        count++;
+        if(targets[i])
+            targets[i]->update();
+    }
+    active=still_running;
+    if(active==0&&timer)
+        timer->stop();
+    return count;
+}
+
+double GaugeAnimator::clock() const
+{
+    return elapsed.nsecsElapsed()/1e9;
+}
+
+float GaugeAnimator::relativeTime(double now)
+{
+    if(active==0){
+        //没有进行中的动画，停止的仪表不读开始时间，直接换零点
+        epoch=now;
+    }else if(now-epoch>rebase_interval_s){
+        //所有开始时间一起平移，两个较小的float相减，不丢精度
+        const float shift=float(now-epoch);
+        for(float &t:startTimes)
+            t-=shift;
+        epoch=now;
+    }
+    return float(now-epoch);
+}
+
+void GaugeAnimator::ensureTimer()
+{
+    if(!timer){
+        timer=new QTimer(this);
+        timer->setTimerType(Qt::PreciseTimer);
+        //按主屏刷新率推进，实际出帧仍由各控件的update合并到vsync
+        qreal rate=60;
+        if(QGuiApplication::primaryScreen())
+            rate=qMax<qreal>(1,QGuiApplication::primaryScreen()->refreshRate());
+        timer->setInterval(qMax(1,int(1000/rate)));
+        connect(timer,&QTimer::timeout,this,[this]{
+            advance(clock());
+        });
+    }
+    if(!timer->isActive())
+        timer->start();
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <QObject>
+#include <QVector>
+#include <QElapsedTimer>
+#include "GaugeEasing.h"
+
+class QWidget;
+class QTimer;
+
+//全局的进度动画管理，代替每个控件各自的QPropertyAnimation
+//所有仪表的动画状态按数组分列连续存放（起点、终点、开始时间、时长倒数、曲线），
+//每次刷新用GaugeSimd一次推进多个仪表，只对值有变化的仪表调用update()
+//只有一个定时器，按主屏刷新率触发，没有进行中的动画时停止
+//时钟用double秒，开始时间列存相对epoch的float，epoch定期前移，进程运行多久float都只需表示几十秒
+//只能在GUI线程使用
+class GaugeAnimator : public QObject
+{
+    Q_OBJECT
+public:
+    static GaugeAnimator *instance();
+
+    //注册一个仪表，target为值变化时需要刷新的控件，可为nullptr，返回句柄
+    int add(QWidget *target);
+    //注销，句柄之后会被复用
+    void remove(int handle);
+    //从当前值走向target，进行中时保持曲线进度不变，与GaugeEasing::retarget一致
+    //进度已归一化，duration单位秒
+    void animateTo(int handle,float target,float duration=2.0f,GaugeEasing::Curve curve=GaugeEasing::OutQuart);
+    //不带动画直接设置
+    void jumpTo(int handle,float value);
+    float value(int handle) const;
+    bool isRunning(int handle) const;
+
+    //注册的仪表数和进行中的动画数
+    int count() const;
+    int runningCount() const;
+    //每个仪表占用的状态字节数
+    static int bytesPerGauge();
+
+    //推进到now（秒，取clock()），返回值有变化的仪表数，定时器触发时自动调用
+    //基准测试可以直接调用来测一趟的耗时
+    int advance(double now);
+    //动画时钟，秒
+    double clock() const;
+
+private:
+    explicit GaugeAnimator(QObject *parent = nullptr);
+    void ensureTimer();
+    //now相对epoch的秒数，离得太远时先把epoch移到now
+    float relativeTime(double now);
+
+private:
+    //每个仪表一列，长度按SIMD最大宽度对齐，多出的位置作为空闲句柄
+    //曲线和运行标记也存为float，整趟推进不用做类型转换
+    QVector<float> starts;
+    QVector<float> ends;
+    QVector<float> startTimes;
+    QVector<float> invDurations;
+    QVector<float> values;
+    QVector<float> curves;
+    QVector<float> running;
+    //本次推进的变化标记，复用避免每帧分配
+    QVector<float> changed;
+    QVector<QWidget*> targets;
+    //空闲的句柄，从末尾取，小的句柄先用
+    QVector<int> freeHandles;
+    int registered{ 0 };
+    int active{ 0 };
+    QTimer *timer{ nullptr };
+    QElapsedTimer elapsed;
+    //startTimes的零点，clock()的秒数
+    double epoch{ 0 };
+};
@@ -0,0 +1,43 @@
+#include "GaugeBackend.h"
+
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QtGlobal>
+
+//全局后端
+static QAtomicInt current_backend(GaugeBackend::OpenGLBackend);
+
+GaugeBackend::Backend GaugeBackend::select(int glMajor, int glMinor)
+{
+    const QByteArray env=qgetenv("GAUGE_BACKEND").toLower();
+    if(env=="software")
+        return SoftwareBackend;
+    if(env=="opengl")
+        return OpenGLBackend;
+    //着色器是#version 330 core
+    return (glMajor*10+glMinor>=33)?OpenGLBackend:SoftwareBackend;
+}
+
+void GaugeBackend::setBackend(Backend backend)
+{
+    current_backend.storeRelease(backend);
+}
+
+GaugeBackend::Backend GaugeBackend::backend()
+{
+    return Backend(current_backend.loadAcquire());
+}
+
+bool GaugeBackend::isSoftware()
+{
+    return backend()==SoftwareBackend;
+}
+
+bool GaugeBackend::rhiRequested()
+{
+#ifdef GAUGE_RHI
+    return qEnvironmentVariableIsSet("GAUGE_RHI_API");
+#else
+    return false;
+#endif
+}
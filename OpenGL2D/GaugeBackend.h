@@ -0,0 +1,24 @@
+#pragma once
+
+//进度条的绘制后端
+//OpenGL达到3.3时用着色器绘制，否则用SoftwareRasterizer在CPU上绘制
+//环境变量GAUGE_BACKEND=software/opengl可以强制指定，便于在正常机器上检查后备路径
+//构建了QRhi后端（Qt6.7）且设置了GAUGE_RHI_API时用GaugeRhiWidget，不需要GL
+class GaugeBackend
+{
+public:
+    enum Backend {
+        OpenGLBackend = 0,
+        SoftwareBackend = 1,
+        RhiBackend = 2
+    };
+
+    //按OpenGL版本选择，环境变量优先
+    static Backend select(int glMajor,int glMinor);
+    //全局后端，创建控件前设置
+    static void setBackend(Backend backend);
+    static Backend backend();
+    static bool isSoftware();
+    //是否要求用QRhi后端，这时启动时不探测GL，也不预编译GLSL
+    static bool rhiRequested();
+};
@@ -0,0 +1,341 @@
+#include "GaugeCanvas.h"
+#include "GLResourceCache.h"
+#include "GLCapabilities.h"
+#include "GaugeFrameDriver.h"
+#include "GaugeMemory.h"
+
+#include <QVector2D>
+#include <QVector3D>
+#include <QDebug>
+
+#include <cmath>
+#include <cstddef>
+
+//进度球波浪一个周期的时长，与原来30ms步进2/360一致
+static const double wave_period_s=5.4;
+
+GaugeCanvas::GaugeCanvas(QWidget *parent)
+    : QOpenGLWidget(parent)
+{
+    for(int i=0;i<StyleCount;i++)
+        styleColors[i]=Qt::white;
+
+    driver=new GaugeFrameDriver(this);
+    label.setMemoryOwner(this);
+}
+
+GaugeCanvas::~GaugeCanvas()
+{
+    GaugeMemory::instance()->untrack(backingMemory);
+    //显示后才会执行初始化
+    if(!isValid())
+        return;
+    makeCurrent();
+    for(GaugeBatch &batch:batches){
+        batch.instanceVbo.destroy();
+        batch.vao.destroy();
+        GaugeMemory::instance()->untrack(batch.vboMemory);
+        GaugeMemory::instance()->untrack(batch.vaoMemory);
+        batch.shaderProgram.reset();
+    }
+    quadVbo.reset();
+    label.release();
+    doneCurrent();
+}
+
+int GaugeCanvas::addGauge(GaugeType type, const QRectF &rect, int style)
+{
+    GaugeBatch &batch=batches[type];
+    GaugeInstance instance;
+    instance.rect[0]=rect.x();
+    instance.rect[1]=rect.y();
+    instance.rect[2]=rect.width();
+    instance.rect[3]=rect.height();
+    instance.value=0;
+    instance.time=0;
+    instance.style=qBound(0,style,StyleCount-1);
+    instance.reserved=0;
+    batch.instances.append(instance);
+    batch.dirty=true;
+
+    gaugeIndex.append(qMakePair(int(type),batch.instances.size()-1));
+    labelsDirty=true;
+    updateDriver();
+    update();
+    return gaugeIndex.size()-1;
+}
+
+void GaugeCanvas::clearGauges()
+{
+    for(GaugeBatch &batch:batches){
+        batch.instances.clear();
+        batch.dirty=true;
+    }
+    gaugeIndex.clear();
+    labelsDirty=true;
+    updateDriver();
+    update();
+}
+
+int GaugeCanvas::gaugeCount() const
+{
+    return gaugeIndex.size();
+}
+
+void GaugeCanvas::setGaugeRect(int id, const QRectF &rect)
+{
+    GaugeInstance *instance=instanceAt(id);
+    if(!instance)
+        return;
+    instance->rect[0]=rect.x();
+    instance->rect[1]=rect.y();
+    instance->rect[2]=rect.width();
+    instance->rect[3]=rect.height();
+    markDirty(id);
+}
+
+void GaugeCanvas::setGaugeValue(int id, double value)
+{
+    GaugeInstance *instance=instanceAt(id);
+    if(!instance)
+        return;
+    instance->value=qBound(0.0,value,1.0);
+    markDirty(id);
+}
+
+double GaugeCanvas::getGaugeValue(int id) const
+{
+    const GaugeInstance *instance=instanceAt(id);
+    return instance?instance->value:0;
+}
+
+void GaugeCanvas::setGaugeTime(int id, double time)
+{
+    GaugeInstance *instance=instanceAt(id);
+    if(!instance)
+        return;
+    instance->time=time;
+    markDirty(id);
+}
+
+void GaugeCanvas::setGaugeStyle(int id, int style)
+{
+    GaugeInstance *instance=instanceAt(id);
+    if(!instance)
+        return;
+    instance->style=qBound(0,style,StyleCount-1);
+    markDirty(id);
+}
+
+void GaugeCanvas::setStyleColor(int style, const QColor &color)
+{
+    if(style<0||style>=StyleCount)
+        return;
+    styleColors[style]=color;
+    update();
+}
+
+void GaugeCanvas::setLabelVisible(bool visible)
+{
+    labelVisible=visible;
+    update();
+}
+
+void GaugeCanvas::setQuality(GaugeShaders::Quality quality)
+{
+    this->quality=quality;
+    update();
+}
+
+GaugeShaders::Quality GaugeCanvas::getQuality() const
+{
+    return quality;
+}
+
+void GaugeCanvas::setLabelFont(const QFont &font)
+{
+    label.setFont(font);
+    update();
+}
+
+GaugeFrameDriver *GaugeCanvas::frameDriver() const
+{
+    return driver;
+}
+
+qint64 GaugeCanvas::gpuMemoryBytes() const
+{
+    return GaugeMemory::instance()->bytesFor(this);
+}
+
+void GaugeCanvas::initializeGL()
+{
+    //为当前上下文初始化OpenGL函数解析
+    initializeOpenGLFunctions();
+    //用真实上下文核对启动时缓存的驱动信息
+    GLCapabilities::revalidate();
+
+    //着色器程序和矩形顶点从缓存中取，同一共享组内只编译上传一次
+    quadVbo=GLResourceCache::instance()->quadBuffer();
+    initBatch(CircleGauge);
+    initBatch(WaveGauge);
+    label.initialize();
+}
+
+void GaugeCanvas::paintGL()
+{
+    glClearColor(0.1f, 0.2f, 0.3f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    glEnable(GL_BLEND);
+    //基于源像素Alpha通道值的半透明混合函数
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+
+    //每类仪表一次绘制
+    drawBatch(CircleGauge);
+    drawBatch(WaveGauge);
+
+    if(!labelVisible||gaugeIndex.isEmpty())
+        return;
+    //文字走SDF图集，所有仪表的文字一次绘制
+    //只有仪表增删或数据改动后才重新生成文字列表，波浪动画的每帧刷新直接沿用上次的顶点
+    if(labelsDirty){
+        label.clear();
+        for(const GaugeBatch &batch:batches){
+            for(const GaugeInstance &instance:batch.instances){
+                const QRectF rect(instance.rect[0],instance.rect[1],
+                                  instance.rect[2],instance.rect[3]);
+                //字号随仪表大小变化，太小时不绘制
+                const qreal pixel_size=qMin(rect.width(),rect.height())/8;
+                if(pixel_size<6)
+                    continue;
+                label.addText(QString::number(instance.value*100,'f',2)+" %",rect.center(),pixel_size);
+            }
+        }
+        labelsDirty=false;
+    }
+    //文字坐标是逻辑像素，视口按设备像素
+    const qreal ratio=devicePixelRatioF();
+    label.render(qRound(width()*ratio),qRound(height()*ratio),ratio);
+}
+
+void GaugeCanvas::resizeGL(int width, int height)
+{
+    //实例位置在顶点着色器中按窗口尺寸换算，视口铺满即可
+    //QOpenGLWidget的帧缓冲按设备像素分配，带深度模板，多重采样时另有一个解析用的颜色缓冲
+    const qreal ratio=devicePixelRatioF();
+    const QSize pixel_size(qRound(width*ratio),qRound(height*ratio));
+    GaugeMemory::instance()->track(backingMemory,this,GaugeMemory::Framebuffer,
+                                   QString("canvas framebuffer %1x%2").arg(pixel_size.width()).arg(pixel_size.height()),
+                                   GaugeMemory::framebufferBytes(pixel_size,true,format().samples()));
+}
+
+void GaugeCanvas::initBatch(GaugeType type)
+{
+    GaugeBatch &batch=batches[type];
+    updateProgram(type);
+
+    batch.vao.create();
+    batch.vao.bind();
+    // position attribute，每个顶点取一次
+    quadVbo->bind();
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * 2, nullptr);
+
+    // instance attribute，每个实例取一次
+    batch.instanceVbo.create();
+    batch.instanceVbo.setUsagePattern(QOpenGLBuffer::DynamicDraw);
+    batch.instanceVbo.bind();
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(GaugeInstance),
+                          reinterpret_cast<void*>(offsetof(GaugeInstance,rect)));
+    glVertexAttribDivisor(1, 1);
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(GaugeInstance),
+                          reinterpret_cast<void*>(offsetof(GaugeInstance,value)));
+    glVertexAttribDivisor(2, 1);
+    batch.vao.release();
+    batch.dirty=true;
+    const QString name=(type==CircleGauge)?QStringLiteral("canvas circle"):QStringLiteral("canvas wave");
+    GaugeMemory::instance()->track(batch.vaoMemory,this,GaugeMemory::VertexArray,name+" vao",0);
+    GaugeMemory::instance()->track(batch.vboMemory,this,GaugeMemory::Buffer,name+" instances",0);
+}
+
+void GaugeCanvas::updateProgram(GaugeType type)
+{
+    GaugeBatch &batch=batches[type];
+    batch.programQuality=GaugeShaders::resolve(quality);
+    const GaugeShaders::ProgramSource source=GaugeShaders::programSource(
+                (type==CircleGauge)?GaugeShaders::CanvasCircleProgram:GaugeShaders::CanvasWaveProgram,
+                batch.programQuality);
+    batch.shaderProgram=GLResourceCache::instance()->program(
+                source.key,source.vertex.constData(),source.fragment.constData());
+}
+
+void GaugeCanvas::drawBatch(GaugeType type)
+{
+    GaugeBatch &batch=batches[type];
+    if(batch.instances.isEmpty())
+        return;
+    if(GaugeShaders::resolve(quality)!=batch.programQuality)
+        updateProgram(type);
+    //实例数据有改动才整体上传，动画时间走uniform不需要上传
+    if(batch.dirty){
+        batch.instanceVbo.bind();
+        batch.instanceVbo.allocate(batch.instances.constData(),
+                                   batch.instances.size()*int(sizeof(GaugeInstance)));
+        batch.instanceVbo.release();
+        //实例数随仪表增删变化，按这次分配的大小更新登记
+        GaugeMemory::instance()->track(batch.vboMemory,this,GaugeMemory::Buffer,
+                                       (type==CircleGauge)?QStringLiteral("canvas circle instances"):QStringLiteral("canvas wave instances"),
+                                       batch.instances.size()*qint64(sizeof(GaugeInstance)));
+        batch.dirty=false;
+    }
+
+    batch.shaderProgram->bind();
+    batch.shaderProgram->setUniformValue("aViewSize", QVector2D(width(),height()));
+    batch.shaderProgram->setUniformValue("aTime",
+                                        float(std::fmod(driver->elapsed(),wave_period_s)/wave_period_s));
+    QVector3D palette[StyleCount];
+    for(int i=0;i<StyleCount;i++)
+        palette[i]=QVector3D(styleColors[i].redF(),styleColors[i].greenF(),styleColors[i].blueF());
+    batch.shaderProgram->setUniformValueArray("aPalette", palette, StyleCount);
+    batch.vao.bind();
+
+    glDrawArraysInstanced(GL_TRIANGLES, 0, 6, batch.instances.size());
+
+    batch.vao.release();
+    batch.shaderProgram->release();
+}
+
+GaugeCanvas::GaugeInstance *GaugeCanvas::instanceAt(int id)
+{
+    if(id<0||id>=gaugeIndex.size())
+        return nullptr;
+    const QPair<int,int> &index=gaugeIndex.at(id);
+    return &batches[index.first].instances[index.second];
+}
+
+const GaugeCanvas::GaugeInstance *GaugeCanvas::instanceAt(int id) const
+{
+    if(id<0||id>=gaugeIndex.size())
+        return nullptr;
+    const QPair<int,int> &index=gaugeIndex.at(id);
+    return &batches[index.first].instances.at(index.second);
+}
+
+void GaugeCanvas::markDirty(int id)
+{
+    batches[gaugeIndex.at(id).first].dirty=true;
+    labelsDirty=true;
+    update();
+}
+
+void GaugeCanvas::updateDriver()
+{
+    //只有进度球需要持续刷新
+    if(batches[WaveGauge].instances.isEmpty())
+        driver->stop();
+    else
+        driver->start();
+}
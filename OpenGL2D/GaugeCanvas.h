@@ -0,0 +1,125 @@
+#pragma once
+#include <QOpenGLWidget>
+#include <QOpenGLFunctions_3_3_Core>
+#include <QOpenGLShaderProgram>
+#include <QOpenGLVertexArrayObject>
+#include <QOpenGLBuffer>
+#include <QSharedPointer>
+#include "LabelRenderer.h"
+#include "GaugeShaders.h"
+
+#include <QVector>
+#include <QPair>
+#include <QColor>
+
+class GaugeFrameDriver;
+
+//多仪表画布：一个QOpenGLWidget里绘制N个环形进度条和进度球
+//同类仪表的状态（区域、进度、时间、样式）放在一个实例缓冲里，一次实例化绘制完成
+class GaugeCanvas : public QOpenGLWidget, protected QOpenGLFunctions_3_3_Core
+{
+    Q_OBJECT
+public:
+    //仪表类型
+    enum GaugeType {
+        CircleGauge = 0, //环形进度条
+        WaveGauge = 1    //波浪进度球
+    };
+    //调色板大小，style取值[0,StyleCount)
+    static constexpr int StyleCount = 4;
+
+    explicit GaugeCanvas(QWidget *parent = nullptr);
+    ~GaugeCanvas();
+
+    //添加仪表，rect为画布内的像素区域，以短边为边长居中绘制，返回仪表id
+    int addGauge(GaugeType type,const QRectF &rect,int style=0);
+    //移除所有仪表
+    void clearGauges();
+    int gaugeCount() const;
+
+    void setGaugeRect(int id,const QRectF &rect);
+    //进度值归一化到[0,1]
+    void setGaugeValue(int id,double value);
+    double getGaugeValue(int id) const;
+    //波浪的相位偏移[0,1]，让相邻的进度球不同步
+    void setGaugeTime(int id,double time);
+    void setGaugeStyle(int id,int style);
+
+    //样式颜色，与着色器计算出的颜色相乘，默认白色即原始配色
+    void setStyleColor(int style,const QColor &color);
+    //是否绘制百分比文字
+    void setLabelVisible(bool visible);
+    //画质档位，默认跟随GaugeShaders的全局设置
+    void setQuality(GaugeShaders::Quality quality);
+    GaugeShaders::Quality getQuality() const;
+    //百分比文字的字体，字号随仪表大小缩放
+    void setLabelFont(const QFont &font);
+    //进度球动画的帧驱动，可设置目标帧率和省电模式
+    GaugeFrameDriver *frameDriver() const;
+    //GaugeMemory中登记在本控件名下的显存估算，不含共享的着色器和顶点
+    qint64 gpuMemoryBytes() const;
+
+protected:
+    //设置OpenGL资源和状态。在第一次调用resizeGL或paintGL之前被调用一次
+    void initializeGL() override;
+    //渲染OpenGL场景，每当需要更新小部件时使用
+    void paintGL() override;
+    //设置OpenGL视口、投影等，每当尺寸大小改变时调用
+    void resizeGL(int width, int height) override;
+
+private:
+    //单个仪表的实例数据，与着色器的aRect/aData属性布局对应
+    struct GaugeInstance
+    {
+        float rect[4];     //x,y,w,h
+        float value;       //归一化进度
+        float time;        //相位偏移
+        float style;       //调色板下标
+        float reserved;
+    };
+    //一类仪表的绘制批次
+    struct GaugeBatch
+    {
+        //着色器程序，同一共享组内的画布共用
+        QSharedPointer<QOpenGLShaderProgram> shaderProgram;
+        //当前程序对应的档位
+        GaugeShaders::Quality programQuality{ GaugeShaders::QualityDefault };
+        //顶点数组对象
+        QOpenGLVertexArrayObject vao;
+        //实例缓冲
+        QOpenGLBuffer instanceVbo{ QOpenGLBuffer::VertexBuffer };
+        //实例数据，数据改变后标记dirty，绘制前整体上传
+        QVector<GaugeInstance> instances;
+        bool dirty{ true };
+        //GaugeMemory的登记
+        int vaoMemory{ -1 };
+        int vboMemory{ -1 };
+    };
+
+    void initBatch(GaugeType type);
+    //档位变化时从缓存换一个程序，顶点属性位置固定，VAO不用重建
+    void updateProgram(GaugeType type);
+    void drawBatch(GaugeType type);
+    GaugeInstance *instanceAt(int id);
+    const GaugeInstance *instanceAt(int id) const;
+    void markDirty(int id);
+    void updateDriver();
+
+private:
+    GaugeBatch batches[2];
+    //两个三角拼接的一个矩形，两类仪表共用
+    QSharedPointer<QOpenGLBuffer> quadVbo;
+    //id -> (类型,批次内下标)
+    QVector<QPair<int,int>> gaugeIndex;
+    QColor styleColors[StyleCount];
+    //所有仪表的百分比文字一次绘制
+    LabelRenderer label;
+    //仪表增删或数据改动后才重新生成文字
+    bool labelsDirty{ true };
+    bool labelVisible{ true };
+    GaugeShaders::Quality quality{ GaugeShaders::QualityDefault };
+    //有进度球时才启动的动画帧驱动
+    GaugeFrameDriver *driver{ nullptr };
+    //控件帧缓冲在GaugeMemory的登记
+    int backingMemory{ -1 };
+};
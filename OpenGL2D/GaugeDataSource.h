@@ -0,0 +1,12 @@
+#pragma once
+
+//进度值的数据源
+//绑定到控件后，控件每帧调用一次sample，取到新值时按setValue处理
+//sample在GUI线程调用，不能阻塞，也不应发信号或做系统调用
+class GaugeDataSource
+{
+public:
+    virtual ~GaugeDataSource() {}
+    //有新值时写入value并返回true
+    virtual bool sample(double &value)=0;
+};
@@ -0,0 +1,76 @@
+#include "GaugeEasing.h"
+
+bool GaugeEasing::curveFor(QEasingCurve::Type type, Curve &curve)
+{
+    switch(type)
+    {
+    case QEasingCurve::Linear: curve=Linear; return true;
+    case QEasingCurve::OutQuad: curve=OutQuad; return true;
+    case QEasingCurve::OutCubic: curve=OutCubic; return true;
+    case QEasingCurve::OutQuart: curve=OutQuart; return true;
+    case QEasingCurve::InOutCubic: curve=InOutCubic; return true;
+    default: return false;
+    }
+}
+
+float GaugeEasing::ease(Curve curve, float u)
+{
+    //与GaugeShaders里的easedValue保持一致
+    const float r=1.0f-u;
+    switch(curve)
+    {
+    case OutQuad: return 1.0f-r*r;
+    case OutCubic: return 1.0f-r*r*r;
+    case OutQuart: return 1.0f-r*r*r*r;
+    case InOutCubic: return u<0.5f?4.0f*u*u*u:1.0f-4.0f*r*r*r;
+    default: return u;
+    }
+}
+
+float GaugeEasing::timeProgress(double now) const
+{
+    if(duration<=0)
+        return 1.0f;
+    const float u=float((now-startTime)/duration);
+    return u<0?0:(u>1?1:u);
+}
+
+float GaugeEasing::valueAt(double now) const
+{
+    const float k=ease(curve,timeProgress(now));
+    return start+(end-start)*k;
+}
+
+bool GaugeEasing::isRunning(double now) const
+{
+    return timeProgress(now)<1.0f;
+}
+
+void GaugeEasing::retarget(double now, float target)
+{
+    const float current=valueAt(now);
+    if(isRunning(now)){
+        //value(u)=start+(end-start)*E(u)，保持u0和value(u0)=current不变求新的start
+        const float eased=ease(curve,timeProgress(now));
+        if(eased<0.99f){
+            start=(current-target*eased)/(1.0f-eased);
+            end=target;
+            return;
+        }
+    }
+    start=current;
+    end=target;
+    startTime=now;
+}
+
+void GaugeEasing::jump(float value)
+{
+    start=value;
+    end=value;
+}
+
+float GaugeEasing::elapsed(double now) const
+{
+    const double t=now-startTime;
+    return float(t<0?0:(t>duration?duration:t));
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <QEasingCurve>
+
+//GPU缓动的动画状态：起止值、开始时间、时长、曲线
+//着色器用同样的公式按当前时间算出进度，CPU只负责请求帧；valueAt是CPU端的同一公式，给文字和状态判断用
+//时间为控件自己的时钟，单位秒，用double，长时间运行也不丢精度；传给着色器的是相对startTime的时间
+class GaugeEasing
+{
+public:
+    //着色器支持的曲线，数值与GLSL里的aCurve对应
+    enum Curve {
+        Linear = 0,
+        OutQuad = 1,
+        OutCubic = 2,
+        OutQuart = 3,
+        InOutCubic = 4
+    };
+    //QEasingCurve类型对应的曲线，着色器不支持时返回false
+    static bool curveFor(QEasingCurve::Type type,Curve &curve);
+    //u为[0,1]的时间进度
+    static float ease(Curve curve,float u);
+
+    //开始时间起经过的时间进度[0,1]
+    float timeProgress(double now) const;
+    float valueAt(double now) const;
+    bool isRunning(double now) const;
+    //从now时的值走向target
+    //进行中时反推新的起点，保持当前值和时间进度不变；已结束或快结束时从now重新开始
+    void retarget(double now,float target);
+    //不带动画直接跳到value
+    void jump(float value);
+    //now时距开始的秒数，限制在[0,duration]，给着色器用的小数值
+    float elapsed(double now) const;
+
+    float start{ 0 };
+    float end{ 0 };
+    double startTime{ 0 };
+    float duration{ 2.0f };
+    Curve curve{ OutQuart };
+};
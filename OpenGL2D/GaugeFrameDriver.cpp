@@ -0,0 +1,152 @@
+#include "GaugeFrameDriver.h"
+
+#include <QOpenGLWidget>
+#include <QWindow>
+#include <QEvent>
+
+GaugeFrameDriver::GaugeFrameDriver(QOpenGLWidget *widget)
+    : QObject(widget)
+    , widget(widget)
+{
+    pacingTimer=new QTimer(this);
+    pacingTimer->setSingleShot(true);
+    pacingTimer->setTimerType(Qt::PreciseTimer);
+    connect(pacingTimer,&QTimer::timeout,this,[this]{
+        if(running)
+            this->widget->update();
+    });
+    connect(widget,&QOpenGLWidget::frameSwapped,this,&GaugeFrameDriver::onFrameSwapped);
+    widget->installEventFilter(this);
+    clock.start();
+}
+
+void GaugeFrameDriver::start()
+{
+    if(running)
+        return;
+    running=true;
+    suspended=false;
+    widget->update();
+}
+
+void GaugeFrameDriver::stop()
+{
+    running=false;
+    suspended=false;
+    pacingTimer->stop();
+}
+
+bool GaugeFrameDriver::isRunning() const
+{
+    return running;
+}
+
+bool GaugeFrameDriver::isSuspended() const
+{
+    return suspended;
+}
+
+void GaugeFrameDriver::setTargetFps(int fps)
+{
+    targetFps=qMax(0,fps);
+}
+
+int GaugeFrameDriver::getTargetFps() const
+{
+    return targetFps;
+}
+
+void GaugeFrameDriver::setPowerSave(bool enable)
+{
+    powerSave=enable;
+}
+
+bool GaugeFrameDriver::isPowerSave() const
+{
+    return powerSave;
+}
+
+double GaugeFrameDriver::elapsed() const
+{
+    return clock.nsecsElapsed()/1e9;
+}
+
+bool GaugeFrameDriver::eventFilter(QObject *watched, QEvent *event)
+{
+    switch(event->type())
+    {
+    case QEvent::Show:
+        //控件第一次显示后才有顶层窗口，顺带监听窗口的最小化和显示
+        if(watched==widget&&watchedWindow!=widget->window()){
+            if(watchedWindow)
+                watchedWindow->removeEventFilter(this);
+            watchedWindow=widget->window();
+            if(watchedWindow!=widget)
+                watchedWindow->installEventFilter(this);
+        }
+        resume();
+        break;
+    case QEvent::WindowStateChange:
+    case QEvent::ShowToParent:
+        resume();
+        break;
+    default:
+        break;
+    }
+    return QObject::eventFilter(watched,event);
+}
+
+void GaugeFrameDriver::onFrameSwapped()
+{
+    lastFrameNs=clock.nsecsElapsed();
+    if(!running)
+        return;
+    //看不到时不再请求下一帧，等可见的事件或重绘再恢复
+    if(!isExposed()){
+        suspended=true;
+        return;
+    }
+    suspended=false;
+
+    const int fps=effectiveFps();
+    if(fps<=0){
+        //跟随vsync，update的合并和交换会把帧率限制在刷新率
+        widget->update();
+        return;
+    }
+    const qint64 interval_ns=1000000000LL/fps;
+    const qint64 remain_ms=(lastFrameNs+interval_ns-clock.nsecsElapsed())/1000000;
+    if(remain_ms<=0)
+        widget->update();
+    else
+        pacingTimer->start(int(remain_ms));
+}
+
+void GaugeFrameDriver::resume()
+{
+    if(!running||pacingTimer->isActive())
+        return;
+    suspended=false;
+    widget->update();
+}
+
+bool GaugeFrameDriver::isExposed() const
+{
+    if(!widget->isVisible())
+        return false;
+    QWidget *window=widget->window();
+    if(window->isMinimized())
+        return false;
+    QWindow *handle=window->windowHandle();
+    if(handle&&!handle->isExposed())
+        return false;
+    //被父控件裁剪掉，比如滚动区域外
+    return !widget->visibleRegion().isEmpty();
+}
+
+int GaugeFrameDriver::effectiveFps() const
+{
+    if(powerSave)
+        return targetFps>0?qMin(targetFps,int(PowerSaveFps)):int(PowerSaveFps);
+    return targetFps;
+}
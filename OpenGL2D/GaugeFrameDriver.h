@@ -0,0 +1,59 @@
+#pragma once
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+
+class QOpenGLWidget;
+
+//动画帧驱动
+//每次frameSwapped之后再请求下一帧，帧率跟随vsync，时间取单调时钟，与定时器抖动无关
+//控件隐藏、最小化、滚出可视区域或窗口未暴露时不再请求帧，完全停止，重新可见时恢复
+class GaugeFrameDriver : public QObject
+{
+    Q_OBJECT
+public:
+    explicit GaugeFrameDriver(QOpenGLWidget *widget);
+
+    void start();
+    void stop();
+    bool isRunning() const;
+    //运行中但因不可见而暂停
+    bool isSuspended() const;
+
+    //目标帧率，0表示跟随屏幕刷新
+    void setTargetFps(int fps);
+    int getTargetFps() const;
+    //省电模式，帧率不超过PowerSaveFps
+    void setPowerSave(bool enable);
+    bool isPowerSave() const;
+    static constexpr int PowerSaveFps = 15;
+    //实际的帧率上限，综合目标帧率和省电模式，0表示跟随屏幕刷新
+    int effectiveFps() const;
+
+    //单调时钟，从构造开始的秒数
+    double elapsed() const;
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private:
+    //一帧合成完成后决定下一帧的时机
+    void onFrameSwapped();
+    //恢复帧请求，可见时调用
+    void resume();
+    //控件当前是否能被看到
+    bool isExposed() const;
+
+private:
+    QOpenGLWidget *widget{ nullptr };
+    //低于刷新率时用来延后下一帧
+    QTimer *pacingTimer{ nullptr };
+    QElapsedTimer clock;
+    qint64 lastFrameNs{ 0 };
+    int targetFps{ 0 };
+    bool powerSave{ false };
+    bool running{ false };
+    bool suspended{ false };
+    //监听所在顶层窗口的状态变化
+    QObject *watchedWindow{ nullptr };
+};
@@ -0,0 +1,221 @@
+#include "GaugeMemory.h"
+
+#include <QMutexLocker>
+#include <QTextStream>
+#include <QMap>
+
+#include <algorithm>
+
+//字节数的可读形式
+static QString formatBytes(qint64 bytes)
+{
+    if(bytes>=1024*1024)
+        return QString("%1 MB").arg(bytes/1048576.0,0,'f',2);
+    if(bytes>=1024)
+        return QString("%1 KB").arg(bytes/1024.0,0,'f',1);
+    return QString("%1 B").arg(bytes);
+}
+
+//所属对象的描述，登记时取，对象销毁后dump仍可用
+static QString describeOwner(const QObject *owner)
+{
+    if(!owner)
+        return QStringLiteral("shared");
+    QString text=QString("%1(0x%2)").arg(QString::fromLatin1(owner->metaObject()->className()))
+            .arg(quintptr(owner),0,16);
+    if(!owner->objectName().isEmpty())
+        text+=" \""+owner->objectName()+"\"";
+    return text;
+}
+
+GaugeMemory *GaugeMemory::instance()
+{
+    static GaugeMemory memory;
+    return &memory;
+}
+
+GaugeMemory::GaugeMemory(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void GaugeMemory::track(int &handle, const QObject *owner, Kind kind, const QString &name, qint64 bytes)
+{
+    bool exceeded=false;
+    qint64 total_bytes=0;
+    qint64 budget_bytes=0;
+    {
+        QMutexLocker locker(&mutex);
+        if(handle<0||!entries.contains(handle)){
+            handle=nextHandle++;
+            Entry entry;
+            entry.owner=owner;
+            entry.ownerName=describeOwner(owner);
+            entries.insert(handle,entry);
+        }
+        Entry &entry=entries[handle];
+        total+=bytes-entry.bytes;
+        entry.kind=kind;
+        entry.name=name;
+        entry.bytes=bytes;
+        exceeded=checkBudget();
+        total_bytes=total;
+        budget_bytes=budget;
+    }
+    //不持锁发信号，接收方可以直接查询
+    if(exceeded)
+        emit budgetExceeded(total_bytes,budget_bytes);
+}
+
+int GaugeMemory::reserve(const QObject *owner, Kind kind, const QString &name)
+{
+    QMutexLocker locker(&mutex);
+    const int handle=nextHandle++;
+    Entry entry;
+    entry.owner=owner;
+    entry.ownerName=describeOwner(owner);
+    entry.kind=kind;
+    entry.name=name;
+    entries.insert(handle,entry);
+    return handle;
+}
+
+void GaugeMemory::untrack(int &handle)
+{
+    if(handle<0)
+        return;
+    QMutexLocker locker(&mutex);
+    auto iter=entries.find(handle);
+    if(iter!=entries.end()){
+        total-=iter->bytes;
+        entries.erase(iter);
+        checkBudget();
+    }
+    handle=-1;
+}
+
+qint64 GaugeMemory::totalBytes() const
+{
+    QMutexLocker locker(&mutex);
+    return total;
+}
+
+qint64 GaugeMemory::bytesFor(const QObject *owner) const
+{
+    QMutexLocker locker(&mutex);
+    qint64 bytes=0;
+    for(const Entry &entry:entries){
+        if(entry.owner==owner)
+            bytes+=entry.bytes;
+    }
+    return bytes;
+}
+
+qint64 GaugeMemory::bytesFor(Kind kind) const
+{
+    QMutexLocker locker(&mutex);
+    qint64 bytes=0;
+    for(const Entry &entry:entries){
+        if(entry.kind==kind)
+            bytes+=entry.bytes;
+    }
+    return bytes;
+}
+
+int GaugeMemory::objectCount() const
+{
+    QMutexLocker locker(&mutex);
+    return entries.size();
+}
+
+void GaugeMemory::setBudget(qint64 bytes)
+{
+    bool exceeded=false;
+    qint64 total_bytes=0;
+    {
+        QMutexLocker locker(&mutex);
+        budget=qMax<qint64>(0,bytes);
+        overBudget=false;
+        exceeded=checkBudget();
+        total_bytes=total;
+    }
+    if(exceeded)
+        emit budgetExceeded(total_bytes,bytes);
+}
+
+qint64 GaugeMemory::getBudget() const
+{
+    QMutexLocker locker(&mutex);
+    return budget;
+}
+
+QString GaugeMemory::dump() const
+{
+    QMutexLocker locker(&mutex);
+    QString text;
+    QTextStream stream(&text);
+    stream<<"GaugeMemory total "<<formatBytes(total)<<", "<<entries.size()<<" objects";
+    if(budget>0)
+        stream<<", budget "<<formatBytes(budget);
+    stream<<"\n";
+
+    //各类对象的合计
+    qint64 kind_bytes[KindCount]={};
+    int kind_count[KindCount]={};
+    for(const Entry &entry:entries){
+        kind_bytes[entry.kind]+=entry.bytes;
+        kind_count[entry.kind]++;
+    }
+    for(int i=0;i<KindCount;i++){
+        if(kind_count[i]>0)
+            stream<<"  "<<kindName(Kind(i))<<": "<<formatBytes(kind_bytes[i])<<" ("<<kind_count[i]<<")\n";
+    }
+
+    //按所属对象分组，组内按字节数从大到小
+    QMap<QString,QVector<const Entry*>> groups;
+    for(const Entry &entry:entries)
+        groups[entry.ownerName].append(&entry);
+    for(auto iter=groups.begin();iter!=groups.end();++iter){
+        QVector<const Entry*> &list=iter.value();
+        std::sort(list.begin(),list.end(),[](const Entry *a,const Entry *b){ return a->bytes>b->bytes; });
+        qint64 owner_bytes=0;
+        for(const Entry *entry:list)
+            owner_bytes+=entry->bytes;
+        stream<<iter.key()<<" "<<formatBytes(owner_bytes)<<"\n";
+        for(const Entry *entry:list)
+            stream<<"    "<<kindName(entry->kind)<<"  "<<entry->name<<"  "<<formatBytes(entry->bytes)<<"\n";
+    }
+    stream.flush();
+    return text;
+}
+
+qint64 GaugeMemory::framebufferBytes(const QSize &pixelSize, bool depthStencil, int samples, int colorBytes)
+{
+    const qint64 pixels=qint64(qMax(0,pixelSize.width()))*qMax(0,pixelSize.height());
+    const int bytes_per_pixel=colorBytes+(depthStencil?4:0);
+    //多重采样时另有一个解析用的单采样颜色缓冲
+    if(samples>0)
+        return pixels*bytes_per_pixel*samples+pixels*colorBytes;
+    return pixels*bytes_per_pixel;
+}
+
+QString GaugeMemory::kindName(Kind kind)
+{
+    switch(kind){
+    case Framebuffer: return QStringLiteral("framebuffer");
+    case Texture: return QStringLiteral("texture");
+    case Buffer: return QStringLiteral("buffer");
+    case Program: return QStringLiteral("program");
+    case VertexArray: return QStringLiteral("vertex array");
+    default: break;
+    }
+    return QStringLiteral("unknown");
+}
+
+bool GaugeMemory::checkBudget()
+{
+    const bool over=budget>0&&total>budget;
+    const bool crossed=over&&!overBudget;
+    overBudget=over;
+    return crossed;
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <QObject>
+#include <QString>
+#include <QSize>
+#include <QHash>
+#include <QVector>
+#include <QMutex>
+
+//仪表占用显存的统计
+//各处分配GL对象和FBO时按所属对象（控件，共享缓存为nullptr）登记估算的字节数，
+//可以查询单个控件、各类对象和整个进程的占用；超出预算时发出budgetExceeded，dump()输出明细附在问题报告里
+//估算按内部格式和尺寸计算，不含驱动的对齐和额外开销；可在任意线程登记
+class GaugeMemory : public QObject
+{
+    Q_OBJECT
+public:
+    enum Kind { Framebuffer, Texture, Buffer, Program, VertexArray, KindCount };
+
+    static GaugeMemory *instance();
+
+    //登记或更新一个对象，handle小于0时新登记并写回句柄，否则更新字节数和名称
+    void track(int &handle,const QObject *owner,Kind kind,const QString &name,qint64 bytes);
+    //先登记一个0字节的对象并返回句柄，总量不变，不检查预算也不发信号，
+    //可以在持有其他锁时调用，之后在锁外用track更新字节数
+    int reserve(const QObject *owner,Kind kind,const QString &name);
+    //注销并把handle置为-1
+    void untrack(int &handle);
+
+    qint64 totalBytes() const;
+    qint64 bytesFor(const QObject *owner) const;
+    qint64 bytesFor(Kind kind) const;
+    int objectCount() const;
+
+    //预算，字节，0表示不限，默认0
+    //总量从预算内变为超出时发出一次budgetExceeded，回落后再超出时再发
+    void setBudget(qint64 bytes);
+    qint64 getBudget() const;
+
+    //按所属对象分组的明细
+    QString dump() const;
+
+    //帧缓冲估算，colorBytes为每像素颜色字节数，默认RGBA8，depthStencil为24/8位深度模板，samples大于0时另加多重采样缓冲
+    static qint64 framebufferBytes(const QSize &pixelSize,bool depthStencil=false,int samples=0,int colorBytes=4);
+    static QString kindName(Kind kind);
+
+signals:
+    //在登记的线程发出，连接到GUI线程的对象时为队列连接
+    void budgetExceeded(qint64 totalBytes,qint64 budget);
+
+private:
+    explicit GaugeMemory(QObject *parent = nullptr);
+    //总量变化后检查预算，调用时需持有mutex，返回是否需要发信号
+    bool checkBudget();
+
+private:
+    struct Entry
+    {
+        const QObject *owner{ nullptr };
+        QString ownerName;
+        Kind kind{ Buffer };
+        QString name;
+        qint64 bytes{ 0 };
+    };
+    mutable QMutex mutex;
+    QHash<int,Entry> entries;
+    int nextHandle{ 0 };
+    qint64 total{ 0 };
+    qint64 budget{ 0 };
+    bool overBudget{ false };
+};
@@ -0,0 +1,192 @@
+#include "GaugeProfiler.h"
+
+#include <QWidget>
+#include <QWindow>
+#include <QScreen>
+#include <QGuiApplication>
+#include <QOpenGLContext>
+#include <QOpenGLTimerQuery>
+#include <QDebug>
+
+GaugeProfiler::GaugeProfiler(QWidget *widget)
+    : QObject(widget)
+    , widget(widget)
+{
+    //跨线程的队列连接需要注册
+    qRegisterMetaType<GaugeFrameStats>("GaugeFrameStats");
+    clock.start();
+}
+
+GaugeProfiler::~GaugeProfiler()
+{
+    //查询对象需要在上下文为当前时由release()释放
+    if(queriesCreated&&queries[0])
+        qWarning()<<"GaugeProfiler destroyed without release()";
+}
+
+void GaugeProfiler::setEnabled(bool enable)
+{
+    if(enabled==enable)
+        return;
+    enabled=enable;
+    //重新开始统计，旧的查询结果丢弃
+    lastBeginNs=-1;
+    lastContinuous=false;
+    pending[0]=false;
+    pending[1]=false;
+    activeQuery=-1;
+    resetInterval();
+}
+
+bool GaugeProfiler::isEnabled() const
+{
+    return enabled;
+}
+
+void GaugeProfiler::setReportInterval(int ms)
+{
+    reportInterval=qMax(0,ms);
+}
+
+int GaugeProfiler::getReportInterval() const
+{
+    return reportInterval;
+}
+
+GaugeFrameStats GaugeProfiler::stats() const
+{
+    return lastStats;
+}
+
+void GaugeProfiler::beginFrame(bool continuous, int targetFps)
+{
+    if(!enabled)
+        return;
+    frameBeginNs=clock.nsecsElapsed();
+    //连续动画中两帧间隔过长，中间缺的帧计为掉帧
+    if(continuous&&lastContinuous&&lastBeginNs>=0){
+        const qint64 expected_ns=expectedIntervalNs(targetFps);
+        const qint64 interval_ns=frameBeginNs-lastBeginNs;
+        if(interval_ns*2>expected_ns*3)
+            droppedFrames+=quint64(qMax<qint64>(1,(interval_ns+expected_ns/2)/expected_ns-1));
+    }
+    lastBeginNs=frameBeginNs;
+    lastContinuous=continuous;
+
+    if(!queriesCreated){
+        queriesCreated=true;
+        //计时查询是3.3核心功能，低版本看扩展
+        QOpenGLContext *context=QOpenGLContext::currentContext();
+        if(context){
+            const QSurfaceFormat format=context->format();
+            gpuSupported=format.version()>=qMakePair(3,3)||
+                    context->hasExtension(QByteArrayLiteral("GL_ARB_timer_query"));
+        }
+        if(gpuSupported){
+            for(int i=0;i<2;i++){
+                queries[i]=new QOpenGLTimerQuery(this);
+                if(!queries[i]->create())
+                    gpuSupported=false;
+            }
+        }
+    }
+    if(!gpuSupported)
+        return;
+
+    collectGpuResults();
+    //轮到的查询还没出结果时这一帧不计GPU时间，不等它
+    activeQuery=-1;
+    if(!pending[nextQuery]){
+        activeQuery=nextQuery;
+        queries[activeQuery]->begin();
+    }
+    nextQuery=(nextQuery+1)%2;
+}
+
+void GaugeProfiler::endFrame(const ProgressRenderer::Timings &timings)
+{
+    if(!enabled)
+        return;
+    if(activeQuery>=0){
+        queries[activeQuery]->end();
+        pending[activeQuery]=true;
+        activeQuery=-1;
+    }
+
+    const qint64 now_ns=clock.nsecsElapsed();
+    const qint64 frame_ns=now_ns-frameBeginNs;
+    frames++;
+    intervalFrames++;
+    cpuNs+=frame_ns;
+    cpuNsMax=qMax(cpuNsMax,frame_ns);
+    setupNs+=timings.setupNs;
+    drawNs+=timings.drawNs;
+    labelNs+=timings.labelNs;
+
+    const qint64 elapsed_ns=now_ns-intervalBeginNs;
+    if(elapsed_ns<qint64(reportInterval)*1000000)
+        return;
+
+    GaugeFrameStats stats;
+    stats.frames=frames;
+    stats.droppedFrames=droppedFrames;
+    stats.intervalFrames=intervalFrames;
+    stats.fps=elapsed_ns>0?intervalFrames*1e9/elapsed_ns:0;
+    stats.gpuMs=gpuSamples>0?gpuNs/1e6/gpuSamples:-1;
+    stats.cpuMs=cpuNs/1e6/intervalFrames;
+    stats.cpuMsMax=cpuNsMax/1e6;
+    stats.setupMs=setupNs/1e6/intervalFrames;
+    stats.drawMs=drawNs/1e6/intervalFrames;
+    stats.labelMs=labelNs/1e6/intervalFrames;
+    lastStats=stats;
+    resetInterval();
+    emit statsUpdated(stats);
+}
+
+void GaugeProfiler::release()
+{
+    for(int i=0;i<2;i++){
+        delete queries[i];
+        queries[i]=nullptr;
+        pending[i]=false;
+    }
+    activeQuery=-1;
+    queriesCreated=false;
+    gpuSupported=false;
+}
+
+void GaugeProfiler::collectGpuResults()
+{
+    for(int i=0;i<2;i++){
+        if(!pending[i]||!queries[i]->isResultAvailable())
+            continue;
+        //结果已经可用，waitForResult直接返回
+        gpuNs+=qint64(queries[i]->waitForResult());
+        gpuSamples++;
+        pending[i]=false;
+    }
+}
+
+qint64 GaugeProfiler::expectedIntervalNs(int targetFps) const
+{
+    qreal fps=targetFps;
+    if(fps<=0){
+        QWindow *handle=widget->window()->windowHandle();
+        QScreen *screen=handle?handle->screen():QGuiApplication::primaryScreen();
+        fps=screen?screen->refreshRate():60;
+    }
+    return qint64(1e9/qMax<qreal>(1,fps));
+}
+
+void GaugeProfiler::resetInterval()
+{
+    intervalBeginNs=clock.nsecsElapsed();
+    intervalFrames=0;
+    cpuNs=0;
+    cpuNsMax=0;
+    setupNs=0;
+    drawNs=0;
+    labelNs=0;
+    gpuNs=0;
+    gpuSamples=0;
+}
@@ -0,0 +1,95 @@
+#pragma once
+#include <QObject>
+#include <QElapsedTimer>
+#include <QMetaType>
+#include "ProgressRenderer.h"
+
+class QWidget;
+class QOpenGLTimerQuery;
+
+//一个统计周期的帧数据，耗时为周期内的平均值，单位毫秒
+struct GaugeFrameStats
+{
+    quint64 frames{ 0 };        //累计帧数
+    quint64 droppedFrames{ 0 }; //累计掉帧数
+    int intervalFrames{ 0 };    //本周期帧数
+    double fps{ 0 };            //本周期帧率
+    double gpuMs{ -1 };         //GPU耗时，不支持计时查询或还没有结果时为-1
+    double cpuMs{ 0 };          //整个paintGL的CPU耗时
+    double cpuMsMax{ 0 };       //本周期最慢的一帧
+    double setupMs{ 0 };        //视口、清屏、着色器和uniform
+    double drawMs{ 0 };         //绘制调用
+    double labelMs{ 0 };        //百分比文字
+};
+Q_DECLARE_METATYPE(GaugeFrameStats)
+
+//控件的帧耗时统计，默认关闭
+//GPU耗时用两个QOpenGLTimerQuery轮流查询，结果可用时才读取，不会阻塞等待GPU
+//statsUpdated按reportInterval节流发出，监控端直接连接信号即可，不用轮询
+class GaugeProfiler : public QObject
+{
+    Q_OBJECT
+public:
+    explicit GaugeProfiler(QWidget *widget);
+    ~GaugeProfiler();
+
+    void setEnabled(bool enable);
+    bool isEnabled() const;
+    //发出statsUpdated的最小间隔，默认1000ms
+    void setReportInterval(int ms);
+    int getReportInterval() const;
+    //最近一次发出的统计
+    GaugeFrameStats stats() const;
+
+    //paintGL开始和结束时调用，需要上下文为当前
+    //continuous表示正处于连续动画，帧间隔超过期望值1.5倍时计为掉帧
+    //targetFps为期望帧率，0表示屏幕刷新率
+    void beginFrame(bool continuous,int targetFps=0);
+    void endFrame(const ProgressRenderer::Timings &timings);
+    //释放计时查询，需要上下文为当前
+    void release();
+
+signals:
+    void statsUpdated(const GaugeFrameStats &stats);
+
+private:
+    //读取已经完成的查询
+    void collectGpuResults();
+    //期望的帧间隔，纳秒
+    qint64 expectedIntervalNs(int targetFps) const;
+    //清空周期内的累计值
+    void resetInterval();
+
+private:
+    QWidget *widget{ nullptr };
+    bool enabled{ false };
+    int reportInterval{ 1000 };
+    GaugeFrameStats lastStats;
+
+    //GPU计时查询，双缓冲
+    QOpenGLTimerQuery *queries[2]{ nullptr, nullptr };
+    bool pending[2]{ false, false };
+    int activeQuery{ -1 };
+    int nextQuery{ 0 };
+    bool queriesCreated{ false };
+    bool gpuSupported{ false };
+
+    //帧间隔和CPU耗时
+    QElapsedTimer clock;
+    qint64 frameBeginNs{ 0 };
+    qint64 lastBeginNs{ -1 };
+    bool lastContinuous{ false };
+    quint64 frames{ 0 };
+    quint64 droppedFrames{ 0 };
+
+    //本周期的累计值
+    qint64 intervalBeginNs{ 0 };
+    int intervalFrames{ 0 };
+    qint64 cpuNs{ 0 };
+    qint64 cpuNsMax{ 0 };
+    qint64 setupNs{ 0 };
+    qint64 drawNs{ 0 };
+    qint64 labelNs{ 0 };
+    qint64 gpuNs{ 0 };
+    int gpuSamples{ 0 };
+};
@@ -0,0 +1,216 @@
+#include "GaugeQuickItem.h"
+#include "GaugeQuickMaterial.h"
+
+#include <QQuickWindow>
+#include <QSGGeometryNode>
+#include <QOpenGLContext>
+#include <QtQml>
+#include <QDebug>
+
+#include <cmath>
+
+//波浪一个周期的时长，与WaveProgressBar一致
+static const double wave_period_s=5.4;
+
+GaugeQuickItem::GaugeQuickItem(QQuickItem *parent)
+    : QQuickItem(parent)
+{
+    setFlag(ItemHasContents);
+    clock.start();
+}
+
+void GaugeQuickItem::registerQmlTypes(const char *uri)
+{
+    qmlRegisterType<GaugeQuickItem>(uri,1,0,"GaugeItem");
+}
+
+void GaugeQuickItem::setType(GaugeType type)
+{
+    if(gaugeType==type)
+        return;
+    gaugeType=type;
+    updateAnimation();
+    update();
+    emit typeChanged();
+}
+
+GaugeQuickItem::GaugeType GaugeQuickItem::getType() const
+{
+    return gaugeType;
+}
+
+void GaugeQuickItem::setRange(double min, double max)
+{
+    if(max<=min||(progressMin==min&&progressMax==max))
+        return;
+    progressMin=min;
+    progressMax=max;
+    update();
+    emit rangeChanged();
+}
+
+void GaugeQuickItem::setMinimum(double min)
+{
+    setRange(min,progressMax);
+}
+
+double GaugeQuickItem::getMinimum() const
+{
+    return progressMin;
+}
+
+void GaugeQuickItem::setMaximum(double max)
+{
+    setRange(progressMin,max);
+}
+
+double GaugeQuickItem::getMaximum() const
+{
+    return progressMax;
+}
+
+void GaugeQuickItem::setValue(double value)
+{
+    if(progressValue==value)
+        return;
+    progressValue=value;
+    update();
+    emit valueChanged();
+}
+
+double GaugeQuickItem::getValue() const
+{
+    return progressValue;
+}
+
+void GaugeQuickItem::setPhase(double phase)
+{
+    if(wavePhase==phase)
+        return;
+    wavePhase=phase;
+    update();
+    emit phaseChanged();
+}
+
+double GaugeQuickItem::getPhase() const
+{
+    return wavePhase;
+}
+
+void GaugeQuickItem::setQuality(Quality quality)
+{
+    if(gaugeQuality==quality)
+        return;
+    gaugeQuality=quality;
+    update();
+    emit qualityChanged();
+}
+
+GaugeQuickItem::Quality GaugeQuickItem::getQuality() const
+{
+    return gaugeQuality;
+}
+
+QSGNode *GaugeQuickItem::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *)
+{
+    //在渲染线程调用，GUI线程此时阻塞，可以直接读成员
+    const float side=float(qMin(width(),height()));
+    if(side<=0){
+        delete oldNode;
+        return nullptr;
+    }
+    //着色器是#version 330 core，上下文达不到时不画
+    QOpenGLContext *context=QOpenGLContext::currentContext();
+    if(!context||context->format().majorVersion()*10+context->format().minorVersion()<33){
+        static bool warned=false;
+        if(!warned){
+            warned=true;
+            qWarning()<<"GaugeQuickItem: needs an OpenGL 3.3 core scene graph context";
+        }
+        delete oldNode;
+        return nullptr;
+    }
+
+    QSGGeometryNode *node=static_cast<QSGGeometryNode*>(oldNode);
+    if(!node){
+        node=new QSGGeometryNode;
+        //两个三角形，索引让四边形只存4个顶点
+        QSGGeometry *geometry=new QSGGeometry(GaugeQuickMaterial::attributes(),4,6,QSGGeometry::UnsignedShortType);
+        geometry->setDrawingMode(QSGGeometry::DrawTriangles);
+        quint16 *indices=geometry->indexDataAsUShort();
+        const quint16 quad[6]={ 0, 1, 2, 2, 1, 3 };
+        for(int i=0;i<6;i++)
+            indices[i]=quad[i];
+        node->setGeometry(geometry);
+        node->setFlags(QSGNode::OwnsGeometry|QSGNode::OwnsMaterial);
+    }
+    //类型或档位变了换材质，其余都在顶点里
+    const bool wave=(gaugeType==WaveGauge);
+    const GaugeShaders::Quality tier=GaugeShaders::resolve(GaugeShaders::Quality(gaugeQuality));
+    const GaugeQuickMaterial *material=static_cast<const GaugeQuickMaterial*>(node->material());
+    if(!material||material->isWave()!=wave||material->getQuality()!=tier){
+        node->setMaterial(new GaugeQuickMaterial(wave,tier));
+        node->markDirty(QSGNode::DirtyMaterial);
+    }
+
+    //以短边为边长居中，与控件一致
+    const float x=float(width()-side)*0.5f;
+    const float y=float(height()-side)*0.5f;
+    const qreal ratio=window()?window()->effectiveDevicePixelRatio():1.0;
+    const float smooth_width=float(qMax(3.0*ratio,1.5)/(side*ratio));
+    const float progress=qBound(0.0f,normalizedProgress(),1.0f);
+    const float time=wave?float(std::fmod(clock.nsecsElapsed()/1e9/wave_period_s+wavePhase,1.0)):0.0f;
+    GaugeQuickMaterial::Vertex *vertices=static_cast<GaugeQuickMaterial::Vertex*>(node->geometry()->vertexData());
+    //场景图y轴向下，仪表坐标y轴向上
+    const float corners[4][4]={
+        { x,      y,      -1.0f,  1.0f },
+        { x+side, y,       1.0f,  1.0f },
+        { x,      y+side, -1.0f, -1.0f },
+        { x+side, y+side,  1.0f, -1.0f }
+    };
+    for(int i=0;i<4;i++){
+        GaugeQuickMaterial::Vertex &vertex=vertices[i];
+        vertex.x=corners[i][0];
+        vertex.y=corners[i][1];
+        vertex.posX=corners[i][2];
+        vertex.posY=corners[i][3];
+        vertex.value=progress;
+        vertex.time=time;
+        vertex.smoothWidth=smooth_width;
+        vertex.reserved=0;
+    }
+    node->markDirty(QSGNode::DirtyGeometry);
+    return node;
+}
+
+void GaugeQuickItem::geometryChanged(const QRectF &newGeometry, const QRectF &oldGeometry)
+{
+    QQuickItem::geometryChanged(newGeometry,oldGeometry);
+    if(newGeometry.size()!=oldGeometry.size())
+        update();
+}
+
+void GaugeQuickItem::itemChange(ItemChange change, const ItemChangeData &value)
+{
+    QQuickItem::itemChange(change,value);
+    if(change==ItemSceneChange||change==ItemVisibleHasChanged)
+        updateAnimation();
+}
+
+void GaugeQuickItem::updateAnimation()
+{
+    QObject::disconnect(frameConnection);
+    frameConnection=QMetaObject::Connection();
+    //frameSwapped在渲染线程发出，以this为上下文排队到GUI线程再请求下一帧
+    if(gaugeType==WaveGauge&&isVisible()&&window()){
+        frameConnection=connect(window(),&QQuickWindow::frameSwapped,
+                                this,&QQuickItem::update,Qt::QueuedConnection);
+        update();
+    }
+}
+
+float GaugeQuickItem::normalizedProgress() const
+{
+    //把进度[min,max]归一化[0,1]
+    return (progressValue-progressMin)/(progressMax-progressMin);
+}
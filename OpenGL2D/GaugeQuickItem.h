@@ -0,0 +1,87 @@
+#pragma once
+#include <QQuickItem>
+#include <QElapsedTimer>
+#include "GaugeShaders.h"
+
+//Qt Quick的仪表
+//环形进度条和进度球画成场景图里的一个四边形节点，材质见GaugeQuickMaterial，
+//不经过离屏FBO，同类仪表由场景图渲染器合批，几百个仪表也只有一两次绘制
+//百分比文字在QML里用Text叠加；进度动画可用Behavior，进度球的波浪随窗口的每一帧推进
+class GaugeQuickItem : public QQuickItem
+{
+    Q_OBJECT
+    Q_PROPERTY(GaugeType type READ getType WRITE setType NOTIFY typeChanged)
+    Q_PROPERTY(double value READ getValue WRITE setValue NOTIFY valueChanged)
+    Q_PROPERTY(double minimum READ getMinimum WRITE setMinimum NOTIFY rangeChanged)
+    Q_PROPERTY(double maximum READ getMaximum WRITE setMaximum NOTIFY rangeChanged)
+    Q_PROPERTY(double phase READ getPhase WRITE setPhase NOTIFY phaseChanged)
+    Q_PROPERTY(Quality quality READ getQuality WRITE setQuality NOTIFY qualityChanged)
+public:
+    //仪表类型，与GaugeCanvas相同
+    enum GaugeType {
+        CircleGauge = 0, //环形进度条
+        WaveGauge = 1    //波浪进度球
+    };
+    Q_ENUM(GaugeType)
+    //画质档位，取值与GaugeShaders::Quality相同
+    enum Quality {
+        QualityDefault = GaugeShaders::QualityDefault,
+        QualityHigh = GaugeShaders::QualityHigh,
+        QualityMedium = GaugeShaders::QualityMedium,
+        QualityLow = GaugeShaders::QualityLow
+    };
+    Q_ENUM(Quality)
+
+    explicit GaugeQuickItem(QQuickItem *parent = nullptr);
+
+    //注册为QML类型GaugeItem，import uri 1.0
+    static void registerQmlTypes(const char *uri = "EasyOpenGL2D");
+
+    void setType(GaugeType type);
+    GaugeType getType() const;
+
+    void setRange(double min,double max);
+    void setMinimum(double min);
+    double getMinimum() const;
+    void setMaximum(double max);
+    double getMaximum() const;
+    void setValue(double value);
+    double getValue() const;
+
+    //波浪的相位偏移[0,1]，让相邻的进度球不同步
+    void setPhase(double phase);
+    double getPhase() const;
+
+    //画质档位，默认跟随GaugeShaders的全局设置
+    void setQuality(Quality quality);
+    Quality getQuality() const;
+
+signals:
+    void typeChanged();
+    void valueChanged();
+    void rangeChanged();
+    void phaseChanged();
+    void qualityChanged();
+
+protected:
+    QSGNode *updatePaintNode(QSGNode *oldNode,UpdatePaintNodeData *data) override;
+    void geometryChanged(const QRectF &newGeometry,const QRectF &oldGeometry) override;
+    void itemChange(ItemChange change,const ItemChangeData &value) override;
+
+private:
+    //进度球可见时每帧交换后请求下一帧
+    void updateAnimation();
+    //把进度[min,max]归一化[0,1]
+    float normalizedProgress() const;
+
+private:
+    GaugeType gaugeType{ CircleGauge };
+    double progressMin{ 0 };
+    double progressMax{ 100 };
+    double progressValue{ 0 };
+    double wavePhase{ 0 };
+    Quality gaugeQuality{ QualityDefault };
+    //波浪时间，单调时钟
+    QElapsedTimer clock;
+    QMetaObject::Connection frameConnection;
+};
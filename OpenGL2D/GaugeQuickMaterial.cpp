@@ -0,0 +1,102 @@
+#include "GaugeQuickMaterial.h"
+
+#include <QSGMaterialShader>
+#include <QOpenGLShaderProgram>
+
+//材质着色器，场景图每种材质类型只创建一个
+//逐仪表的数据都在顶点里，这里只更新矩阵和不透明度
+class GaugeQuickShader : public QSGMaterialShader
+{
+public:
+    GaugeQuickShader(bool wave,GaugeShaders::Quality quality)
+        : vertexSource(GaugeShaders::quickVertexSource())
+        , fragmentSource(wave?GaugeShaders::quickWaveFragment(quality)
+                             :GaugeShaders::quickCircleFragment(quality))
+    {
+    }
+
+    char const *const *attributeNames() const override
+    {
+        static const char *const names[]={ "qt_Vertex", "aPos", "aData", nullptr };
+        return names;
+    }
+
+    void updateState(const RenderState &state, QSGMaterial *, QSGMaterial *) override
+    {
+        if(state.isMatrixDirty())
+            program()->setUniformValue(matrixLocation,state.combinedMatrix());
+        if(state.isOpacityDirty())
+            program()->setUniformValue(opacityLocation,state.opacity());
+    }
+
+protected:
+    const char *vertexShader() const override
+    {
+        return vertexSource.constData();
+    }
+
+    const char *fragmentShader() const override
+    {
+        return fragmentSource.constData();
+    }
+
+    void initialize() override
+    {
+        matrixLocation=program()->uniformLocation("qt_Matrix");
+        opacityLocation=program()->uniformLocation("qt_Opacity");
+    }
+
+private:
+    QByteArray vertexSource;
+    QByteArray fragmentSource;
+    int matrixLocation{ -1 };
+    int opacityLocation{ -1 };
+};
+
+GaugeQuickMaterial::GaugeQuickMaterial(bool wave, GaugeShaders::Quality quality)
+    : wave(wave)
+    , tier(GaugeShaders::resolve(quality))
+{
+    //边缘是半透明的
+    setFlag(Blending);
+}
+
+QSGMaterialType *GaugeQuickMaterial::type() const
+{
+    //类型决定着色器，每种仪表和档位一个
+    static QSGMaterialType types[2][3];
+    return &types[wave?1:0][qBound(0,int(tier),2)];
+}
+
+QSGMaterialShader *GaugeQuickMaterial::createShader() const
+{
+    return new GaugeQuickShader(wave,tier);
+}
+
+int GaugeQuickMaterial::compare(const QSGMaterial *other) const
+{
+    //只有同类型的材质才会比较，没有其他状态
+    Q_UNUSED(other)
+    return 0;
+}
+
+bool GaugeQuickMaterial::isWave() const
+{
+    return wave;
+}
+
+GaugeShaders::Quality GaugeQuickMaterial::getQuality() const
+{
+    return tier;
+}
+
+const QSGGeometry::AttributeSet &GaugeQuickMaterial::attributes()
+{
+    static const QSGGeometry::Attribute data[]={
+        QSGGeometry::Attribute::createWithAttributeType(0,2,QSGGeometry::FloatType,QSGGeometry::PositionAttribute),
+        QSGGeometry::Attribute::createWithAttributeType(1,2,QSGGeometry::FloatType,QSGGeometry::TexCoordAttribute),
+        QSGGeometry::Attribute::createWithAttributeType(2,4,QSGGeometry::FloatType,QSGGeometry::UnknownAttribute)
+    };
+    static const QSGGeometry::AttributeSet set={ 3, int(sizeof(Vertex)), data };
+    return set;
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <QSGMaterial>
+#include <QSGGeometry>
+#include "GaugeShaders.h"
+
+//Qt Quick场景图的仪表材质
+//着色器与控件共用GaugeShaders的圆环/波浪计算，进度、时间、平滑宽度放在顶点里，
+//材质本身没有逐仪表的状态，同一类型和档位的仪表compare相等，由场景图渲染器合批成一次绘制
+//使用Qt5场景图的OpenGL后端，需要3.3 Core上下文，与控件相同
+class GaugeQuickMaterial : public QSGMaterial
+{
+public:
+    //一个顶点
+    struct Vertex
+    {
+        float x,y;          //场景图坐标
+        float posX,posY;    //仪表内坐标[-1,1]，y轴向上
+        float value;        //进度，已归一化
+        float time;         //波浪时间[0,1)
+        float smoothWidth;  //平滑宽度，按仪表像素大小计算
+        float reserved;
+    };
+
+    GaugeQuickMaterial(bool wave,GaugeShaders::Quality quality);
+
+    QSGMaterialType *type() const override;
+    QSGMaterialShader *createShader() const override;
+    int compare(const QSGMaterial *other) const override;
+
+    bool isWave() const;
+    //已按全局设置解析过的档位
+    GaugeShaders::Quality getQuality() const;
+
+    //顶点格式，与Vertex对应
+    static const QSGGeometry::AttributeSet &attributes();
+
+private:
+    bool wave{ false };
+    GaugeShaders::Quality tier{ GaugeShaders::QualityHigh };
+};
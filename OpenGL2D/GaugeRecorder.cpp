@@ -0,0 +1,326 @@
+#include "GaugeRecorder.h"
+#include "GaugeMemory.h"
+
+#include <QOpenGLWidget>
+#include <QOpenGLContext>
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QQueue>
+#include <QFile>
+#include <QDir>
+#include <QImage>
+#include <QAtomicInteger>
+#include <QDebug>
+
+#include <cstring>
+
+//读回的一帧，已经翻转为自上而下
+struct GaugeRecordFrame
+{
+    qint64 index{ 0 };
+    QSize size;
+    QByteArray pixels;
+};
+
+//GUI线程和写盘线程之间的队列，锁只在入队出队时持有，不跨越拷贝和写盘
+struct GaugeRecordQueue
+{
+    QMutex mutex;
+    QWaitCondition notEmpty;
+    QQueue<GaugeRecordFrame> frames;
+    qint64 queuedBytes{ 0 };
+    bool closed{ false };
+    QAtomicInteger<qint64> dropped{ 0 };
+    QThread *thread{ nullptr };
+};
+
+GaugeRecorder::GaugeRecorder(QOpenGLWidget *widget)
+    : QObject(widget)
+    , widget(widget)
+{
+}
+
+GaugeRecorder::~GaugeRecorder()
+{
+    if(queue){
+        {
+            QMutexLocker locker(&queue->mutex);
+            queue->closed=true;
+            queue->notEmpty.wakeAll();
+        }
+        queue->thread->wait();
+        delete queue->thread;
+        queue->thread=nullptr;
+    }
+    if(!ring.isEmpty())
+        qWarning()<<"GaugeRecorder destroyed without release()";
+}
+
+void GaugeRecorder::setBufferCount(int count)
+{
+    if(!recording)
+        bufferCount=qBound(2,count,16);
+}
+
+int GaugeRecorder::getBufferCount() const
+{
+    return bufferCount;
+}
+
+void GaugeRecorder::setMaxQueuedBytes(qint64 bytes)
+{
+    maxQueuedBytes=qMax<qint64>(0,bytes);
+}
+
+qint64 GaugeRecorder::getMaxQueuedBytes() const
+{
+    return maxQueuedBytes;
+}
+
+bool GaugeRecorder::start(const QString &path, Format format)
+{
+    if(recording)
+        return false;
+    //上一次的写盘线程还没结束时等它写完
+    if(queue){
+        queue->thread->wait();
+        delete queue->thread;
+        queue.reset();
+    }
+    QSharedPointer<QFile> file;
+    if(format==ImageSequence){
+        if(!QDir().mkpath(path)){
+            qWarning().noquote()<<"GaugeRecorder: cannot create"<<path;
+            return false;
+        }
+    }else{
+        file.reset(new QFile(path));
+        if(!file->open(QIODevice::WriteOnly)){
+            qWarning().noquote()<<"GaugeRecorder: cannot write"<<path;
+            return false;
+        }
+    }
+
+    queue.reset(new GaugeRecordQueue);
+    QSharedPointer<GaugeRecordQueue> shared_queue=queue;
+    queue->thread=QThread::create([this,shared_queue,path,format,file]{
+        const QDir dir(path);
+        QSize stream_size;
+        qint64 written=0;
+        for(;;)
+        {
+            GaugeRecordFrame frame;
+            {
+                QMutexLocker locker(&shared_queue->mutex);
+                while(shared_queue->frames.isEmpty()&&!shared_queue->closed)
+                    shared_queue->notEmpty.wait(&shared_queue->mutex);
+                if(shared_queue->frames.isEmpty())
+                    break;
+                frame=shared_queue->frames.dequeue();
+                shared_queue->queuedBytes-=frame.pixels.size();
+            }
+            bool ok=false;
+            if(format==ImageSequence){
+                const QImage image(reinterpret_cast<const uchar*>(frame.pixels.constData()),
+                                   frame.size.width(),frame.size.height(),QImage::Format_RGBA8888);
+                ok=image.save(dir.filePath(QString("frame_%1.png").arg(frame.index,6,10,QChar('0'))),"PNG");
+            }else{
+                //原始流没有帧头，尺寸以第一帧为准
+                if(!stream_size.isValid())
+                    stream_size=frame.size;
+                ok=frame.size==stream_size&&file->write(frame.pixels)==frame.pixels.size();
+            }
+            if(ok)
+                written++;
+            else
+                shared_queue->dropped.fetchAndAddRelaxed(1);
+        }
+        if(file)
+            file->close();
+        const qint64 dropped=shared_queue->dropped.loadAcquire();
+        QMetaObject::invokeMethod(this,[this,written,dropped]{
+            emit finished(written,dropped);
+        },Qt::QueuedConnection);
+    });
+    queue->thread->start();
+    captured=0;
+    stalled=0;
+    recording=true;
+    return true;
+}
+
+void GaugeRecorder::stop()
+{
+    if(!recording)
+        return;
+    //在途的帧取回后再关闭队列
+    if(inFlight>0&&widget->isValid()){
+        //析构时控件已经makeCurrent，这里不能doneCurrent
+        const bool current=QOpenGLContext::currentContext()==widget->context();
+        if(!current)
+            widget->makeCurrent();
+        collect(true);
+        if(!current)
+            widget->doneCurrent();
+    }
+    recording=false;
+    QMutexLocker locker(&queue->mutex);
+    queue->closed=true;
+    queue->notEmpty.wakeAll();
+}
+
+bool GaugeRecorder::isRecording() const
+{
+    return recording;
+}
+
+void GaugeRecorder::captureFrame()
+{
+    if(!recording)
+        return;
+    if(!functionsResolved){
+        initializeOpenGLFunctions();
+        functionsResolved=true;
+    }
+    //QOpenGLWidget的帧缓冲按设备像素分配
+    const qreal ratio=widget->devicePixelRatioF();
+    const QSize size(qRound(widget->width()*ratio),qRound(widget->height()*ratio));
+    if(size.isEmpty())
+        return;
+    if(size!=bufferSize||ring.size()!=bufferCount){
+        collect(true);
+        createBuffers(size);
+    }
+    //先取回已经完成的帧，环满时才等待最旧的一帧
+    collect(false);
+    if(inFlight==ring.size()){
+        stalled++;
+        readSlot(ring[tail]);
+        tail=(tail+1)%ring.size();
+        inFlight--;
+    }
+
+    Slot &slot=ring[head];
+    glBindFramebuffer(GL_READ_FRAMEBUFFER,widget->defaultFramebufferObject());
+    glBindBuffer(GL_PIXEL_PACK_BUFFER,slot.buffer);
+    glPixelStorei(GL_PACK_ALIGNMENT,4);
+    //目标是PBO时glReadPixels只排队拷贝，立即返回
+    glReadPixels(0,0,size.width(),size.height(),GL_RGBA,GL_UNSIGNED_BYTE,nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER,0);
+    slot.fence=glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE,0);
+    slot.frame=captured++;
+    head=(head+1)%ring.size();
+    inFlight++;
+}
+
+void GaugeRecorder::release()
+{
+    stop();
+    if(!functionsResolved)
+        return;
+    destroyBuffers();
+}
+
+qint64 GaugeRecorder::capturedFrames() const
+{
+    return captured;
+}
+
+qint64 GaugeRecorder::stalledFrames() const
+{
+    return stalled;
+}
+
+qint64 GaugeRecorder::droppedFrames() const
+{
+    return queue?queue->dropped.loadAcquire():0;
+}
+
+void GaugeRecorder::createBuffers(const QSize &size)
+{
+    destroyBuffers();
+    ring.resize(bufferCount);
+    const GLsizeiptr bytes=GLsizeiptr(size.width())*size.height()*4;
+    for(Slot &slot:ring){
+        glGenBuffers(1,&slot.buffer);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER,slot.buffer);
+        glBufferData(GL_PIXEL_PACK_BUFFER,bytes,nullptr,GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER,0);
+    bufferSize=size;
+    GaugeMemory::instance()->track(bufferMemory,widget,GaugeMemory::Buffer,
+                                   QString("recorder pbo %1x%2 x%3").arg(size.width()).arg(size.height()).arg(bufferCount),
+                                   qint64(bytes)*bufferCount);
+}
+
+void GaugeRecorder::destroyBuffers()
+{
+    for(Slot &slot:ring){
+        if(slot.fence)
+            glDeleteSync(slot.fence);
+        glDeleteBuffers(1,&slot.buffer);
+    }
+    ring.clear();
+    GaugeMemory::instance()->untrack(bufferMemory);
+    head=0;
+    tail=0;
+    inFlight=0;
+    bufferSize=QSize();
+}
+
+void GaugeRecorder::collect(bool wait)
+{
+    while(inFlight>0)
+    {
+        Slot &slot=ring[tail];
+        //按顺序取回，最旧的没完成时后面的也不看
+        if(!wait){
+            const GLenum status=glClientWaitSync(slot.fence,0,0);
+            if(status!=GL_ALREADY_SIGNALED&&status!=GL_CONDITION_SATISFIED)
+                break;
+        }
+        readSlot(slot);
+        tail=(tail+1)%ring.size();
+        inFlight--;
+    }
+}
+
+void GaugeRecorder::readSlot(Slot &slot)
+{
+    //未完成时映射会等待，stop和环满时才会走到这里
+    glDeleteSync(slot.fence);
+    slot.fence=nullptr;
+    const int stride=bufferSize.width()*4;
+    const qint64 bytes=qint64(stride)*bufferSize.height();
+    {
+        QMutexLocker locker(&queue->mutex);
+        //写盘跟不上时丢帧，不阻塞GUI线程
+        if(queue->queuedBytes+bytes>maxQueuedBytes){
+            queue->dropped.fetchAndAddRelaxed(1);
+            return;
+        }
+    }
+    GaugeRecordFrame frame;
+    frame.index=slot.frame;
+    frame.size=bufferSize;
+    frame.pixels.resize(int(bytes));
+    glBindBuffer(GL_PIXEL_PACK_BUFFER,slot.buffer);
+    const uchar *mapped=static_cast<const uchar*>(glMapBufferRange(GL_PIXEL_PACK_BUFFER,0,bytes,GL_MAP_READ_BIT));
+    if(mapped){
+        //GL的行自下而上，拷出时翻转
+        char *target=frame.pixels.data();
+        for(int y=0;y<bufferSize.height();y++)
+            std::memcpy(target+qint64(y)*stride,mapped+qint64(bufferSize.height()-1-y)*stride,size_t(stride));
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER,0);
+    if(!mapped){
+        queue->dropped.fetchAndAddRelaxed(1);
+        return;
+    }
+    QMutexLocker locker(&queue->mutex);
+    queue->queuedBytes+=bytes;
+    queue->frames.enqueue(frame);
+    queue->notEmpty.wakeOne();
+}
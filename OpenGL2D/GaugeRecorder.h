@@ -0,0 +1,88 @@
+#pragma once
+#include <QObject>
+#include <QOpenGLFunctions_3_3_Core>
+#include <QSharedPointer>
+#include <QVector>
+#include <QSize>
+
+class QOpenGLWidget;
+struct GaugeRecordQueue;
+
+//控件画面的录制，默认不录
+//每帧用glReadPixels读到像素缓冲对象（PBO）环里并插入栅栏，几帧之后栅栏已经完成时才映射拷出，
+//GUI线程不等待GPU；拷出的帧交给写盘线程按图片序列或原始流保存
+//GPU落后整个环时才等待最旧的一帧，计入stalledFrames；写盘跟不上、排队超过maxQueuedBytes时丢帧，计入droppedFrames
+class GaugeRecorder : public QObject, protected QOpenGLFunctions_3_3_Core
+{
+    Q_OBJECT
+public:
+    //ImageSequence：path为目录，每帧一张frame_000000.png
+    //RawStream：path为文件，逐帧追加RGBA8888像素，自上而下，尺寸变化后的帧丢弃
+    //  例：ffmpeg -f rawvideo -pix_fmt rgba -s 256x256 -r 60 -i gauge.rgba gauge.mp4
+    enum Format { ImageSequence, RawStream };
+
+    explicit GaugeRecorder(QOpenGLWidget *widget);
+    //等待写盘线程结束，PBO需要之前在上下文为当前时release()
+    ~GaugeRecorder();
+
+    //同时在途的帧数，默认4，开始录制前设置
+    void setBufferCount(int count);
+    int getBufferCount() const;
+    //写盘队列的上限，默认256MB
+    void setMaxQueuedBytes(qint64 bytes);
+    qint64 getMaxQueuedBytes() const;
+
+    bool start(const QString &path,Format format=ImageSequence);
+    //取回在途的帧后结束，写盘线程写完剩余帧后发出finished
+    void stop();
+    bool isRecording() const;
+
+    //paintGL末尾调用，读取控件帧缓冲，需要上下文为当前
+    void captureFrame();
+    //释放PBO和栅栏，需要上下文为当前，正在录制时先stop
+    void release();
+
+    //本次录制的统计
+    qint64 capturedFrames() const;
+    qint64 stalledFrames() const;
+    qint64 droppedFrames() const;
+
+signals:
+    //写盘线程写完，在GUI线程发出
+    void finished(qint64 writtenFrames,qint64 droppedFrames);
+
+private:
+    //一个PBO槽
+    struct Slot
+    {
+        GLuint buffer{ 0 };
+        GLsync fence{ nullptr };
+        qint64 frame{ 0 };
+    };
+    //按尺寸重建PBO环
+    void createBuffers(const QSize &size);
+    void destroyBuffers();
+    //取回已完成的帧，wait为true时等待全部在途帧
+    void collect(bool wait);
+    //映射一个完成的槽，拷出后交给写盘线程
+    void readSlot(Slot &slot);
+
+private:
+    QOpenGLWidget *widget{ nullptr };
+    int bufferCount{ 4 };
+    qint64 maxQueuedBytes{ 256*1024*1024 };
+    bool functionsResolved{ false };
+    bool recording{ false };
+    //PBO环，head为下一个要写入的槽，tail为最旧的在途槽
+    QVector<Slot> ring;
+    int head{ 0 };
+    int tail{ 0 };
+    int inFlight{ 0 };
+    QSize bufferSize;
+    int bufferMemory{ -1 };
+    //统计
+    qint64 captured{ 0 };
+    qint64 stalled{ 0 };
+    //写盘线程和队列
+    QSharedPointer<GaugeRecordQueue> queue;
+};
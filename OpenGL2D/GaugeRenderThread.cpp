@@ -0,0 +1,218 @@
+#include "GaugeRenderThread.h"
+#include "ProgressRenderer.h"
+#include "GLResourceCache.h"
+#include "GaugeMemory.h"
+
+#include <QThread>
+#include <QCoreApplication>
+#include <QOpenGLContext>
+#include <QOffscreenSurface>
+#include <QOpenGLFramebufferObject>
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+#include <QOpenGLVersionFunctionsFactory>
+#endif
+#include <QDebug>
+
+GaugeRenderThread::GaugeRenderThread(ProgressRenderer *renderer, QObject *parent)
+    : QObject(parent)
+    , renderer(renderer)
+    , memoryOwner(parent)
+{
+    renderer->setMemoryOwner(parent);
+}
+
+GaugeRenderThread::~GaugeRenderThread()
+{
+    stop();
+    delete renderer;
+}
+
+bool GaugeRenderThread::start()
+{
+    if(thread)
+        return true;
+    QOpenGLContext *share_context=QOpenGLContext::globalShareContext();
+    if(!share_context){
+        qWarning()<<"GaugeRenderThread: Qt::AA_ShareOpenGLContexts is not set";
+        return false;
+    }
+    //QOffscreenSurface需要在GUI线程创建
+    surface=new QOffscreenSurface;
+    surface->setFormat(share_context->format());
+    surface->create();
+    context=new QOpenGLContext;
+    context->setFormat(share_context->format());
+    context->setShareContext(share_context);
+    if(!context->create()){
+        qWarning()<<"GaugeRenderThread: failed to create shared context";
+        delete context;
+        context=nullptr;
+        surface->destroy();
+        delete surface;
+        surface=nullptr;
+        return false;
+    }
+    quit.storeRelease(0);
+    thread=QThread::create([this]{ run(); });
+    context->moveToThread(thread);
+    thread->start();
+    return true;
+}
+
+void GaugeRenderThread::stop()
+{
+    if(!thread)
+        return;
+    quit.storeRelease(1);
+    wake.release();
+    thread->wait();
+    delete thread;
+    thread=nullptr;
+    delete context;
+    context=nullptr;
+    surface->destroy();
+    delete surface;
+    surface=nullptr;
+    //下次启动从空的状态开始
+    for(int i=0;i<GaugeTripleBuffer<Frame>::Count;i++)
+        frames.at(i)=Frame();
+    wake.tryAcquire(wake.available());
+    wakePending.storeRelease(0);
+}
+
+bool GaugeRenderThread::isRunning() const
+{
+    return thread!=nullptr;
+}
+
+void GaugeRenderThread::setQuality(GaugeShaders::Quality quality)
+{
+    this->quality.storeRelease(quality);
+}
+
+void GaugeRenderThread::setLabelFont(const QFont &font)
+{
+    //字体很少改，这里加锁
+    QMutexLocker locker(&fontMutex);
+    labelFont=font;
+    fontDirty.storeRelease(1);
+}
+
+void GaugeRenderThread::setMeshGeometryEnabled(bool enable)
+{
+    meshGeometry.storeRelease(enable?1:0);
+}
+
+void GaugeRenderThread::requestFrame(const FrameRequest &request)
+{
+    requests.back()=request;
+    requests.publish();
+    //工作线程忙时它画完会自己再取，不用再唤醒
+    if(wakePending.testAndSetOrdered(0,1))
+        wake.release();
+}
+
+const GaugeRenderThread::Frame &GaugeRenderThread::latestFrame(QOpenGLFunctions_3_3_Core *gl)
+{
+    if(frames.hasFresh()){
+        //旧的一份交还给工作线程，上次paintGL对它的贴图已经提交，在这之后插栅栏，
+        //工作线程重用前让GPU等它；只在换帧时插，不是每次paintGL都插
+        Frame &old_frame=frames.front();
+        if(old_frame.texture){
+            old_frame.readFence=gl->glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE,0);
+            //提交后工作线程的上下文才能看到
+            gl->glFlush();
+        }
+        frames.fetch();
+        //栅栏由工作线程在重用这一份时删除，这里只让GPU等待
+        const Frame &frame=frames.front();
+        if(frame.fence)
+            gl->glWaitSync(frame.fence,0,GL_TIMEOUT_IGNORED);
+    }
+    return frames.front();
+}
+
+void GaugeRenderThread::run()
+{
+    if(!context->makeCurrent(surface)){
+        qWarning()<<"GaugeRenderThread: makeCurrent failed";
+        context->moveToThread(qApp->thread());
+        return;
+    }
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    QOpenGLFunctions_3_3_Core *gl=QOpenGLVersionFunctionsFactory::get<QOpenGLFunctions_3_3_Core>(context);
+#else
+    QOpenGLFunctions_3_3_Core *gl=context->versionFunctions<QOpenGLFunctions_3_3_Core>();
+#endif
+    gl->initializeOpenGLFunctions();
+    //同一共享组里GUI线程也在用这些程序，uniform不能共用
+    GLResourceCache::setThreadPrivatePrograms(true);
+    renderer->initialize();
+
+    for(;;)
+    {
+        wake.acquire();
+        if(quit.loadAcquire())
+            break;
+        //先清标记再取参数，之后的提交会重新唤醒
+        wakePending.storeRelease(0);
+        if(!requests.fetch())
+            continue;
+        const FrameRequest request=requests.front();
+        if(request.fboSize.isEmpty())
+            continue;
+
+        renderer->setQuality(GaugeShaders::Quality(quality.loadAcquire()));
+        renderer->setMeshGeometryEnabled(meshGeometry.loadAcquire()!=0);
+        if(fontDirty.testAndSetOrdered(1,0)){
+            QMutexLocker locker(&fontMutex);
+            renderer->setLabelFont(labelFont);
+        }
+
+        //写端这一份GUI线程不再访问，但它之前的贴图可能还在GPU上，先让GPU等它读完再覆盖或重建
+        Frame &frame=frames.back();
+        if(frame.readFence){
+            gl->glWaitSync(frame.readFence,0,GL_TIMEOUT_IGNORED);
+            gl->glDeleteSync(frame.readFence);
+            frame.readFence=nullptr;
+        }
+        if(frame.fence){
+            gl->glDeleteSync(frame.fence);
+            frame.fence=nullptr;
+        }
+        if(!frame.fbo||frame.fbo->size()!=request.fboSize){
+            delete frame.fbo;
+            frame.fbo=new QOpenGLFramebufferObject(request.fboSize);
+            GaugeMemory::instance()->track(frame.memoryHandle,memoryOwner,GaugeMemory::Framebuffer,
+                                           QString("render thread frame %1x%2").arg(request.fboSize.width()).arg(request.fboSize.height()),
+                                           GaugeMemory::framebufferBytes(request.fboSize));
+        }
+        frame.fbo->bind();
+        renderer->setPixelScale(request.pixelScale);
+        renderer->render(request.fboSize.width(),request.fboSize.height(),request.progress,request.time);
+        frame.fbo->release();
+        frame.texture=frame.fbo->texture();
+        frame.size=request.fboSize;
+        //提交后GUI线程的上下文才能看到这些命令
+        frame.fence=gl->glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE,0);
+        gl->glFlush();
+        frames.publish();
+        emit frameReady();
+    }
+
+    //GUI线程已经不再使用纹理
+    gl->glFinish();
+    for(int i=0;i<GaugeTripleBuffer<Frame>::Count;i++){
+        Frame &frame=frames.at(i);
+        if(frame.fence)
+            gl->glDeleteSync(frame.fence);
+        if(frame.readFence)
+            gl->glDeleteSync(frame.readFence);
+        delete frame.fbo;
+        GaugeMemory::instance()->untrack(frame.memoryHandle);
+        frame=Frame();
+    }
+    renderer->release();
+    context->doneCurrent();
+    context->moveToThread(qApp->thread());
+}
@@ -0,0 +1,95 @@
+#pragma once
+#include <QObject>
+#include <QOpenGLFunctions_3_3_Core>
+#include <QSize>
+#include <QFont>
+#include <QMutex>
+#include <QAtomicInt>
+#include <QSemaphore>
+#include "GaugeTripleBuffer.h"
+#include "GaugeShaders.h"
+
+class QThread;
+class QOpenGLContext;
+class QOffscreenSurface;
+class QOpenGLFramebufferObject;
+class ProgressRenderer;
+
+//在工作线程绘制一个仪表
+//工作线程有自己的共享上下文，绘制到FBO的纹理里；控件在paintGL里提交参数、贴最新完成的一帧
+//参数和完成的帧都经GaugeTripleBuffer交接，热路径不加锁；只在工作线程空闲时用信号量唤醒
+//完成的帧带栅栏，GUI线程用glWaitSync在GPU上等待，不阻塞CPU；
+//GUI线程交还一帧时也附上栅栏，工作线程重用这份纹理前同样在GPU上等GUI线程的贴图完成
+//需要Qt::AA_ShareOpenGLContexts
+class GaugeRenderThread : public QObject
+{
+    Q_OBJECT
+public:
+    //一帧的参数，fboSize为设备像素，pixelScale见ProgressRenderer::setPixelScale
+    struct FrameRequest
+    {
+        QSize fboSize;
+        float pixelScale{ 1 };
+        float progress{ 0 };
+        float time{ 0 };
+    };
+    //完成的一帧，texture为0表示还没有
+    struct Frame
+    {
+        GLuint texture{ 0 };
+        QSize size;
+        GLsync fence{ nullptr };     //工作线程绘制完成
+        GLsync readFence{ nullptr }; //GUI线程最后一次读取完成
+        QOpenGLFramebufferObject *fbo{ nullptr };
+        int memoryHandle{ -1 };
+    };
+
+    //接管renderer，启动前可以设置它的字体等样式，之后只能经本类的接口修改
+    explicit GaugeRenderThread(ProgressRenderer *renderer,QObject *parent = nullptr);
+    ~GaugeRenderThread();
+
+    //在GUI线程调用，失败时返回false并保持在GUI线程绘制
+    bool start();
+    //等待工作线程退出并释放它的资源，之后不能再用latestFrame()的纹理
+    void stop();
+    bool isRunning() const;
+
+    //样式，下一帧生效
+    void setQuality(GaugeShaders::Quality quality);
+    void setLabelFont(const QFont &font);
+    void setMeshGeometryEnabled(bool enable);
+
+    //提交一帧，参数比工作线程快时只保留最新的
+    void requestFrame(const FrameRequest &request);
+    //取最新完成的一帧，需要GUI线程的上下文为当前；纹理可用前已排入GPU等待
+    const Frame &latestFrame(QOpenGLFunctions_3_3_Core *gl);
+
+signals:
+    //工作线程完成一帧，按队列连接到GUI线程
+    void frameReady();
+
+private:
+    void run();
+
+private:
+    ProgressRenderer *renderer{ nullptr };
+    //显存登记的所属对象，工作线程里不调用parent()
+    const QObject *memoryOwner{ nullptr };
+    QThread *thread{ nullptr };
+    QOpenGLContext *context{ nullptr };
+    QOffscreenSurface *surface{ nullptr };
+    //GUI线程写、工作线程读
+    GaugeTripleBuffer<FrameRequest> requests;
+    //工作线程写、GUI线程读
+    GaugeTripleBuffer<Frame> frames;
+    //唤醒工作线程，wakePending为1时已经有一次唤醒未处理
+    QSemaphore wake;
+    QAtomicInt wakePending{ 0 };
+    QAtomicInt quit{ 0 };
+    //样式
+    QAtomicInt quality{ GaugeShaders::QualityDefault };
+    QAtomicInt meshGeometry{ 0 };
+    QAtomicInt fontDirty{ 0 };
+    QMutex fontMutex;
+    QFont labelFont;
+};
@@ -0,0 +1,205 @@
+#include "GaugeResolutionScaler.h"
+#include "GaugeMemory.h"
+
+#include <QOpenGLContext>
+#include <QOpenGLFramebufferObject>
+#include <QDebug>
+
+#include <cmath>
+
+//每档缩放的步长
+static const float scale_step=0.125f;
+
+GaugeResolutionScaler::GaugeResolutionScaler()
+{
+}
+
+GaugeResolutionScaler::~GaugeResolutionScaler()
+{
+    //FBO和查询需要在上下文为当前时由release()释放
+    if(initialized)
+        qWarning()<<"GaugeResolutionScaler destroyed without release()";
+}
+
+void GaugeResolutionScaler::setBudget(double ms)
+{
+    budget=qMax(0.01,ms);
+    overFrames=0;
+    underFrames=0;
+}
+
+double GaugeResolutionScaler::getBudget() const
+{
+    return budget;
+}
+
+void GaugeResolutionScaler::setMinimumScale(float scale)
+{
+    minimumScale=qBound(scale_step,scale,1.0f);
+    level=qMin(level,maxLevel());
+}
+
+float GaugeResolutionScaler::getMinimumScale() const
+{
+    return minimumScale;
+}
+
+void GaugeResolutionScaler::setHysteresis(int frames)
+{
+    hysteresis=qMax(1,frames);
+}
+
+int GaugeResolutionScaler::getHysteresis() const
+{
+    return hysteresis;
+}
+
+void GaugeResolutionScaler::setMemoryOwner(const QObject *owner)
+{
+    memoryOwner=owner;
+}
+
+float GaugeResolutionScaler::scale() const
+{
+    return qMax(minimumScale,1.0f-level*scale_step);
+}
+
+double GaugeResolutionScaler::lastFrameMs() const
+{
+    return lastMs;
+}
+
+QOpenGLFramebufferObject *GaugeResolutionScaler::begin(const QSize &pixelSize)
+{
+    if(!initialized){
+        initializeOpenGLFunctions();
+        blitter.create();
+        //时间戳查询是3.3核心功能，计数位数为0表示实现不支持
+        GLint bits=0;
+        glGetQueryiv(GL_TIMESTAMP,GL_QUERY_COUNTER_BITS,&bits);
+        timestampSupported=bits>0;
+        if(timestampSupported)
+            glGenQueries(QueryCount*2,&queries[0][0]);
+        initialized=true;
+    }
+    collect();
+
+    targetSize=pixelSize;
+    const float current_scale=scale();
+    const QSize fbo_size(qMax(1,int(std::ceil(pixelSize.width()*current_scale))),
+                         qMax(1,int(std::ceil(pixelSize.height()*current_scale))));
+    if(!fbo||fbo->size()!=fbo_size){
+        delete fbo;
+        fbo=new QOpenGLFramebufferObject(fbo_size);
+        //放大时线性过滤
+        glBindTexture(GL_TEXTURE_2D,fbo->texture());
+        glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MIN_FILTER,GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAG_FILTER,GL_LINEAR);
+        glBindTexture(GL_TEXTURE_2D,0);
+        GaugeMemory::instance()->track(fboMemory,memoryOwner,GaugeMemory::Framebuffer,
+                                       QString("adaptive resolution %1x%2").arg(fbo_size.width()).arg(fbo_size.height()),
+                                       GaugeMemory::framebufferBytes(fbo_size));
+    }
+
+    //轮到的查询还没出结果时这一帧不计时，不等它
+    activeQuery=-1;
+    if(timestampSupported){
+        if(!pending[nextQuery]){
+            activeQuery=nextQuery;
+            glQueryCounter(queries[activeQuery][0],GL_TIMESTAMP);
+        }
+        nextQuery=(nextQuery+1)%QueryCount;
+    }else{
+        cpuTimer.start();
+    }
+    fbo->bind();
+    return fbo;
+}
+
+void GaugeResolutionScaler::end(GLuint targetFbo)
+{
+    if(!fbo)
+        return;
+    if(activeQuery>=0){
+        glQueryCounter(queries[activeQuery][1],GL_TIMESTAMP);
+        pending[activeQuery]=true;
+        activeQuery=-1;
+    }else if(!timestampSupported){
+        adjust(cpuTimer.nsecsElapsed()/1e6);
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER,targetFbo);
+    glViewport(0,0,targetSize.width(),targetSize.height());
+    glDisable(GL_BLEND);
+    blitter.bind();
+    blitter.blit(fbo->texture(),QMatrix4x4(),QOpenGLTextureBlitter::OriginBottomLeft);
+    blitter.release();
+}
+
+void GaugeResolutionScaler::release()
+{
+    if(!initialized)
+        return;
+    delete fbo;
+    fbo=nullptr;
+    GaugeMemory::instance()->untrack(fboMemory);
+    blitter.destroy();
+    if(timestampSupported)
+        glDeleteQueries(QueryCount*2,&queries[0][0]);
+    for(int i=0;i<QueryCount;i++)
+        pending[i]=false;
+    activeQuery=-1;
+    initialized=false;
+}
+
+void GaugeResolutionScaler::collect()
+{
+    //按提交顺序从最旧的开始读
+    for(int n=0;n<QueryCount;n++){
+        const int i=(nextQuery+n)%QueryCount;
+        if(!pending[i])
+            continue;
+        GLint available=0;
+        glGetQueryObjectiv(queries[i][1],GL_QUERY_RESULT_AVAILABLE,&available);
+        if(!available)
+            break;
+        GLuint64 begin_ns=0,end_ns=0;
+        glGetQueryObjectui64v(queries[i][0],GL_QUERY_RESULT,&begin_ns);
+        glGetQueryObjectui64v(queries[i][1],GL_QUERY_RESULT,&end_ns);
+        pending[i]=false;
+        adjust((end_ns-begin_ns)/1e6);
+    }
+}
+
+void GaugeResolutionScaler::adjust(double ms)
+{
+    lastMs=ms;
+    const float current_scale=scale();
+    if(ms>budget){
+        underFrames=0;
+        if(++overFrames>=hysteresis&&level<maxLevel()){
+            level++;
+            overFrames=0;
+        }
+        return;
+    }
+    overFrames=0;
+    if(level==0)
+        return;
+    //片元数与缩放的平方成正比，估计升一档后的耗时
+    const float up_scale=qMin(1.0f,current_scale+scale_step);
+    const double predicted=ms*(up_scale*up_scale)/(current_scale*current_scale);
+    if(predicted<budget*0.8){
+        if(++underFrames>=hysteresis*4){
+            level--;
+            underFrames=0;
+        }
+    }else{
+        underFrames=0;
+    }
+}
+
+int GaugeResolutionScaler::maxLevel() const
+{
+    return int(std::floor((1.0f-minimumScale)/scale_step+0.001f));
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <QOpenGLFunctions_3_3_Core>
+#include <QOpenGLTextureBlitter>
+#include <QElapsedTimer>
+#include <QSize>
+
+class QOpenGLFramebufferObject;
+class QObject;
+
+//自适应分辨率：仪表本体先画到缩小的内部FBO，再线性过滤放大到控件
+//缩放按实测的GPU耗时调整，每档1/8：连续hysteresis帧超出预算降一档，
+//连续4倍帧数估计升档后仍低于预算的80%才升一档，耗时在预算附近时不会来回跳
+//GPU耗时用GL_TIMESTAMP查询，结果出来时才读取，不等待GPU，也不与GaugeProfiler的计时查询冲突
+class GaugeResolutionScaler : protected QOpenGLFunctions_3_3_Core
+{
+public:
+    GaugeResolutionScaler();
+    ~GaugeResolutionScaler();
+
+    //每帧仪表本体的耗时预算，毫秒，默认1ms
+    void setBudget(double ms);
+    double getBudget() const;
+    //最小缩放，默认0.5
+    void setMinimumScale(float scale);
+    float getMinimumScale() const;
+    //连续超出预算多少帧降一档，默认3，升档需要4倍的帧数
+    void setHysteresis(int frames);
+    int getHysteresis() const;
+
+    //内部FBO在GaugeMemory中登记的所属对象，默认nullptr
+    void setMemoryOwner(const QObject *owner);
+
+    //当前缩放
+    float scale() const;
+    //最近测到的一帧耗时，毫秒，还没有时为-1
+    double lastFrameMs() const;
+
+    //开始一帧，绑定并返回按当前缩放的内部FBO，pixelSize为目标像素尺寸，需要上下文为当前
+    QOpenGLFramebufferObject *begin(const QSize &pixelSize);
+    //结束计时，把内部FBO放大绘制到targetFbo
+    void end(GLuint targetFbo);
+    //释放FBO和查询，需要上下文为当前
+    void release();
+
+private:
+    //读取已经出结果的查询
+    void collect();
+    //按一帧的耗时调整档位
+    void adjust(double ms);
+    //最小缩放对应的档位
+    int maxLevel() const;
+
+private:
+    static constexpr int QueryCount = 3;
+    double budget{ 1.0 };
+    float minimumScale{ 0.5f };
+    int hysteresis{ 3 };
+    //缩放档位，0为原分辨率
+    int level{ 0 };
+    int overFrames{ 0 };
+    int underFrames{ 0 };
+    double lastMs{ -1 };
+    //内部FBO和放大用的blitter
+    QOpenGLFramebufferObject *fbo{ nullptr };
+    QOpenGLTextureBlitter blitter;
+    QSize targetSize;
+    //显存登记
+    const QObject *memoryOwner{ nullptr };
+    int fboMemory{ -1 };
+    bool initialized{ false };
+    //时间戳查询，每帧一对，轮流使用
+    bool timestampSupported{ false };
+    GLuint queries[QueryCount][2];
+    bool pending[QueryCount]{ false, false, false };
+    int activeQuery{ -1 };
+    int nextQuery{ 0 };
+    //不支持时间戳查询时用CPU时间
+    QElapsedTimer cpuTimer;
+};
@@ -0,0 +1,348 @@
+#include "GaugeRhiRenderer.h"
+#include "GlyphAtlas.h"
+
+#include <QFile>
+#include <QFontInfo>
+#include <QDebug>
+
+//构建时生成的.qsb在qrc的这个前缀下，见OpenGL2D.pri
+static const char *shader_prefix=":/OpenGL2D/shaders/";
+//uniform块：mat4 clipCorr + vec4 params，std140
+static const quint32 uniform_size=64+16;
+//文字的uniform块：mat4 clipCorr + vec4 viewSize + vec4 color
+static const quint32 label_uniform_size=64+16+16;
+//文字顶点缓冲的初始容量，按字符数，"100.00 %"为8个
+static const int label_capacity=16;
+
+GaugeRhiRenderer::GaugeRhiRenderer(GaugeType type)
+    : type(type)
+{
+}
+
+GaugeRhiRenderer::~GaugeRhiRenderer()
+{
+    release();
+}
+
+GaugeRhiRenderer::GaugeType GaugeRhiRenderer::gaugeType() const
+{
+    return type;
+}
+
+void GaugeRhiRenderer::setQuality(GaugeShaders::Quality quality)
+{
+    //管线在下一帧按新档位重建
+    this->quality=quality;
+}
+
+GaugeShaders::Quality GaugeRhiRenderer::getQuality() const
+{
+    return quality;
+}
+
+void GaugeRhiRenderer::setLabelFont(const QFont &font)
+{
+    labelFont=font;
+    //图集随字体变化，下次绘制时重建
+    releaseLabel();
+}
+
+QFont GaugeRhiRenderer::getLabelFont() const
+{
+    return labelFont;
+}
+
+void GaugeRhiRenderer::setLabelVisible(bool visible)
+{
+    labelVisible=visible;
+}
+
+bool GaugeRhiRenderer::isLabelVisible() const
+{
+    return labelVisible;
+}
+
+bool GaugeRhiRenderer::initialize(QRhi *rhi, QRhiRenderPassDescriptor *renderPass, int sampleCount)
+{
+    release();
+    if(!rhi||!renderPass)
+        return false;
+    this->rhi=rhi;
+    this->renderPass=renderPass;
+    this->sampleCount=qMax(1,sampleCount);
+
+    vertexBuffer=rhi->newBuffer(QRhiBuffer::Immutable,QRhiBuffer::VertexBuffer,8*sizeof(float));
+    uniformBuffer=rhi->newBuffer(QRhiBuffer::Dynamic,QRhiBuffer::UniformBuffer,uniform_size);
+    if(!vertexBuffer->create()||!uniformBuffer->create()){
+        qWarning()<<"GaugeRhiRenderer: failed to create buffers";
+        release();
+        return false;
+    }
+    vertexUploaded=false;
+
+    bindings=rhi->newShaderResourceBindings();
+    bindings->setBindings({
+        QRhiShaderResourceBinding::uniformBuffer(0,QRhiShaderResourceBinding::VertexStage|QRhiShaderResourceBinding::FragmentStage,uniformBuffer)
+    });
+    if(!bindings->create()){
+        qWarning()<<"GaugeRhiRenderer: failed to create shader resource bindings";
+        release();
+        return false;
+    }
+    return true;
+}
+
+void GaugeRhiRenderer::release()
+{
+    releaseLabel();
+    delete pipeline;
+    pipeline=nullptr;
+    delete bindings;
+    bindings=nullptr;
+    delete uniformBuffer;
+    uniformBuffer=nullptr;
+    delete vertexBuffer;
+    vertexBuffer=nullptr;
+    vertexUploaded=false;
+    rhi=nullptr;
+    renderPass=nullptr;
+}
+
+bool GaugeRhiRenderer::isInitialized() const
+{
+    return rhi!=nullptr;
+}
+
+void GaugeRhiRenderer::render(QRhiCommandBuffer *cb, QRhiRenderTarget *target,
+                              float progress, float time, float pixelScale)
+{
+    if(!rhi||!cb||!target)
+        return;
+    const GaugeShaders::Quality tier=GaugeShaders::resolve(quality);
+    if(!pipeline||pipelineQuality!=tier){
+        if(!createPipeline(tier))
+            return;
+    }
+
+    const QSize size=target->pixelSize();
+    const int side=qMin(size.width(),size.height());
+    QRhiResourceUpdateBatch *updates=rhi->nextResourceUpdateBatch();
+    if(!vertexUploaded){
+        //三角形带，仪表坐标y轴向上
+        static const float quad[8]={ -1.0f, -1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f };
+        updates->uploadStaticBuffer(vertexBuffer,quad);
+        vertexUploaded=true;
+    }
+    //平滑宽度按逻辑像素算，与控件一致
+    const float smooth_width=side>0?qMax(3.0f*pixelScale,1.5f)/side:0.0f;
+    const float params[4]={ qBound(0.0f,progress,1.0f), time, smooth_width, 0.0f };
+    updates->updateDynamicBuffer(uniformBuffer,0,64,rhi->clipSpaceCorrMatrix().constData());
+    updates->updateDynamicBuffer(uniformBuffer,64,16,params);
+    const bool draw_label=labelVisible&&side>0&&(labelPipeline||createLabelResources(updates));
+    if(draw_label)
+        updateLabel(updates,size,pixelScale,params[0]);
+
+    cb->beginPass(target,Qt::black,{ 1.0f, 0 },updates);
+    if(side>0){
+        cb->setGraphicsPipeline(pipeline);
+        //QRhiViewport的原点在左下角，居中时与左上角相同
+        cb->setViewport(QRhiViewport((size.width()-side)/2,(size.height()-side)/2,side,side));
+        cb->setShaderResources();
+        const QRhiCommandBuffer::VertexInput input(vertexBuffer,0);
+        cb->setVertexInput(0,1,&input);
+        cb->draw(4);
+    }
+    if(draw_label&&labelVertexCount>0){
+        cb->setGraphicsPipeline(labelPipeline);
+        cb->setViewport(QRhiViewport(0,0,size.width(),size.height()));
+        cb->setShaderResources();
+        const QRhiCommandBuffer::VertexInput input(labelVertexBuffer,0);
+        cb->setVertexInput(0,1,&input);
+        cb->draw(labelVertexCount);
+    }
+    cb->endPass();
+}
+
+QShader GaugeRhiRenderer::loadShader(const QString &name)
+{
+    QFile file(QString::fromLatin1(shader_prefix)+name+QStringLiteral(".qsb"));
+    if(!file.open(QIODevice::ReadOnly))
+        return QShader();
+    return QShader::fromSerialized(file.readAll());
+}
+
+bool GaugeRhiRenderer::createPipeline(GaugeShaders::Quality tier)
+{
+    delete pipeline;
+    pipeline=nullptr;
+
+    QString tier_name;
+    switch(tier)
+    {
+    case GaugeShaders::QualityLow: tier_name="low"; break;
+    case GaugeShaders::QualityMedium: tier_name="medium"; break;
+    default: tier_name="high"; break;
+    }
+    const QShader vertex=loadShader(QStringLiteral("gauge.vert"));
+    const QShader fragment=loadShader(QString("%1_%2.frag")
+                                      .arg(type==WaveGauge?"wave":"circle").arg(tier_name));
+    if(!vertex.isValid()||!fragment.isValid()){
+        qWarning()<<"GaugeRhiRenderer: missing precompiled shaders, was qsb run at build time?";
+        return false;
+    }
+
+    pipeline=rhi->newGraphicsPipeline();
+    //与GL控件相同，黑底上按alpha叠加
+    QRhiGraphicsPipeline::TargetBlend blend;
+    blend.enable=true;
+    blend.srcColor=QRhiGraphicsPipeline::SrcAlpha;
+    blend.dstColor=QRhiGraphicsPipeline::One;
+    blend.srcAlpha=QRhiGraphicsPipeline::SrcAlpha;
+    blend.dstAlpha=QRhiGraphicsPipeline::One;
+    pipeline->setTargetBlends({ blend });
+    pipeline->setTopology(QRhiGraphicsPipeline::TriangleStrip);
+    pipeline->setSampleCount(sampleCount);
+    pipeline->setShaderStages({
+        { QRhiShaderStage::Vertex, vertex },
+        { QRhiShaderStage::Fragment, fragment }
+    });
+    QRhiVertexInputLayout layout;
+    layout.setBindings({ { 2*sizeof(float) } });
+    layout.setAttributes({ { 0, 0, QRhiVertexInputAttribute::Float2, 0 } });
+    pipeline->setVertexInputLayout(layout);
+    pipeline->setShaderResourceBindings(bindings);
+    pipeline->setRenderPassDescriptor(renderPass);
+    if(!pipeline->create()){
+        qWarning()<<"GaugeRhiRenderer: failed to create graphics pipeline";
+        delete pipeline;
+        pipeline=nullptr;
+        return false;
+    }
+    pipelineQuality=tier;
+    return true;
+}
+
+bool GaugeRhiRenderer::createLabelResources(QRhiResourceUpdateBatch *updates)
+{
+    releaseLabel();
+    const QShader vertex=loadShader(QStringLiteral("label.vert"));
+    const QShader fragment=loadShader(QStringLiteral("label.frag"));
+    if(!vertex.isValid()||!fragment.isValid()){
+        qWarning()<<"GaugeRhiRenderer: missing precompiled label shaders";
+        labelVisible=false;
+        return false;
+    }
+
+    //单通道距离场，按行上传，行宽有对齐
+    labelAtlas=GlyphAtlas::atlas(labelFont);
+    const QImage &image=labelAtlas->image();
+    labelTexture=rhi->newTexture(QRhiTexture::R8,image.size());
+    labelSampler=rhi->newSampler(QRhiSampler::Linear,QRhiSampler::Linear,QRhiSampler::None,
+                                 QRhiSampler::ClampToEdge,QRhiSampler::ClampToEdge);
+    labelVertexBuffer=rhi->newBuffer(QRhiBuffer::Dynamic,QRhiBuffer::VertexBuffer,
+                                     label_capacity*6*4*sizeof(float));
+    labelUniformBuffer=rhi->newBuffer(QRhiBuffer::Dynamic,QRhiBuffer::UniformBuffer,label_uniform_size);
+    if(!labelTexture->create()||!labelSampler->create()||
+            !labelVertexBuffer->create()||!labelUniformBuffer->create()){
+        qWarning()<<"GaugeRhiRenderer: failed to create label resources";
+        releaseLabel();
+        labelVisible=false;
+        return false;
+    }
+    QRhiTextureSubresourceUploadDescription subresource(image.constBits(),quint32(image.sizeInBytes()));
+    subresource.setDataStride(quint32(image.bytesPerLine()));
+    subresource.setSourceSize(image.size());
+    updates->uploadTexture(labelTexture,QRhiTextureUploadDescription(QRhiTextureUploadEntry(0,0,subresource)));
+
+    labelBindings=rhi->newShaderResourceBindings();
+    labelBindings->setBindings({
+        QRhiShaderResourceBinding::uniformBuffer(0,QRhiShaderResourceBinding::VertexStage|QRhiShaderResourceBinding::FragmentStage,labelUniformBuffer),
+        QRhiShaderResourceBinding::sampledTexture(1,QRhiShaderResourceBinding::FragmentStage,labelTexture,labelSampler)
+    });
+
+    labelPipeline=rhi->newGraphicsPipeline();
+    //与LabelRenderer相同，普通的alpha混合
+    QRhiGraphicsPipeline::TargetBlend blend;
+    blend.enable=true;
+    blend.srcColor=QRhiGraphicsPipeline::SrcAlpha;
+    blend.dstColor=QRhiGraphicsPipeline::OneMinusSrcAlpha;
+    blend.srcAlpha=QRhiGraphicsPipeline::SrcAlpha;
+    blend.dstAlpha=QRhiGraphicsPipeline::OneMinusSrcAlpha;
+    labelPipeline->setTargetBlends({ blend });
+    labelPipeline->setSampleCount(sampleCount);
+    labelPipeline->setShaderStages({
+        { QRhiShaderStage::Vertex, vertex },
+        { QRhiShaderStage::Fragment, fragment }
+    });
+    QRhiVertexInputLayout layout;
+    layout.setBindings({ { 4*sizeof(float) } });
+    layout.setAttributes({
+        { 0, 0, QRhiVertexInputAttribute::Float2, 0 },
+        { 0, 1, QRhiVertexInputAttribute::Float2, 2*sizeof(float) }
+    });
+    labelPipeline->setVertexInputLayout(layout);
+    labelPipeline->setShaderResourceBindings(labelBindings);
+    labelPipeline->setRenderPassDescriptor(renderPass);
+    if(!labelBindings->create()||!labelPipeline->create()){
+        qWarning()<<"GaugeRhiRenderer: failed to create label pipeline";
+        releaseLabel();
+        labelVisible=false;
+        return false;
+    }
+    return true;
+}
+
+void GaugeRhiRenderer::releaseLabel()
+{
+    delete labelPipeline;
+    labelPipeline=nullptr;
+    delete labelBindings;
+    labelBindings=nullptr;
+    delete labelUniformBuffer;
+    labelUniformBuffer=nullptr;
+    delete labelVertexBuffer;
+    labelVertexBuffer=nullptr;
+    delete labelSampler;
+    labelSampler=nullptr;
+    delete labelTexture;
+    labelTexture=nullptr;
+    labelAtlas.reset();
+    labelText.clear();
+    labelView=QSizeF();
+    labelVertexCount=0;
+}
+
+void GaugeRhiRenderer::updateLabel(QRhiResourceUpdateBatch *updates, const QSize &pixelSize,
+                                   float pixelScale, float progress)
+{
+    //文字按逻辑像素排版，字号不随设备像素比变化，与ProgressRenderer一致
+    const QString text=QString::number(progress*100,'f',2)+" %";
+    const QSizeF view(pixelSize.width()/pixelScale,pixelSize.height()/pixelScale);
+    if(text==labelText&&view==labelView)
+        return;
+
+    QVector<float> vertices;
+    labelAtlas->layout(text,QPointF(view.width()/2.0,view.height()/2.0),
+                       QFontInfo(labelFont).pixelSize(),vertices);
+    const quint32 bytes=quint32(vertices.size()*sizeof(float));
+    if(bytes>labelVertexBuffer->size()){
+        //标签管线不引用顶点缓冲，直接换一个大的
+        delete labelVertexBuffer;
+        labelVertexBuffer=rhi->newBuffer(QRhiBuffer::Dynamic,QRhiBuffer::VertexBuffer,bytes);
+        if(!labelVertexBuffer->create()){
+            labelVertexCount=0;
+            return;
+        }
+    }
+    if(bytes>0)
+        updates->updateDynamicBuffer(labelVertexBuffer,0,bytes,vertices.constData());
+    labelVertexCount=vertices.size()/4;
+
+    //白色文字，与LabelRenderer的默认颜色相同
+    const float uniforms[8]={ float(view.width()), float(view.height()), 0.0f, 0.0f,
+                              1.0f, 1.0f, 1.0f, 1.0f };
+    updates->updateDynamicBuffer(labelUniformBuffer,0,64,rhi->clipSpaceCorrMatrix().constData());
+    updates->updateDynamicBuffer(labelUniformBuffer,64,32,uniforms);
+    labelText=text;
+    labelView=view;
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include <QString>
+#include <QFont>
+#include <QSharedPointer>
+#include <rhi/qrhi.h>
+#include "GaugeShaders.h"
+
+class GlyphAtlas;
+
+//QRhi后端的仪表渲染，Qt6.7起可用，由GaugeRhiWidget调用，也可以画到任意QRhi渲染目标
+//着色器在构建时由qsb编译成.qsb包（SPIR-V、GLSL、HLSL、MSL），运行时按当前图形API取其中一份，
+//启动时没有GLSL的编译链接；圆环/波浪的计算与GaugeShaders相同，源码在shaders目录
+//百分比文字与LabelRenderer共用GlyphAtlas的距离场图集和排版，只在文字或尺寸变化时重新上传顶点
+class GaugeRhiRenderer
+{
+public:
+    //仪表类型，与GaugeCanvas相同
+    enum GaugeType {
+        CircleGauge = 0, //环形进度条
+        WaveGauge = 1    //波浪进度球
+    };
+
+    explicit GaugeRhiRenderer(GaugeType type = CircleGauge);
+    ~GaugeRhiRenderer();
+
+    GaugeType gaugeType() const;
+
+    //画质档位，每档一个预编译的片段着色器，换档时重建管线
+    void setQuality(GaugeShaders::Quality quality);
+    GaugeShaders::Quality getQuality() const;
+
+    //百分比文字，字体默认QFont("Microsoft YaHei",16)
+    void setLabelFont(const QFont &font);
+    QFont getLabelFont() const;
+    void setLabelVisible(bool visible);
+    bool isLabelVisible() const;
+
+    //创建缓冲和资源绑定，renderPass为之后绘制的目标的渲染通道
+    //rhi或渲染通道变了需要先release再调用
+    bool initialize(QRhi *rhi,QRhiRenderPassDescriptor *renderPass,int sampleCount = 1);
+    void release();
+    bool isInitialized() const;
+
+    //记录一帧：清屏后以短边为边长居中绘制，再在中心画百分比文字
+    //[progress]归一化的进度，[time]波浪时间[0,1)，[pixelScale]设备像素比，用来算平滑宽度
+    void render(QRhiCommandBuffer *cb,QRhiRenderTarget *target,
+                float progress,float time,float pixelScale = 1.0f);
+
+    //读取qrc里的.qsb，name如"circle_high.frag"
+    static QShader loadShader(const QString &name);
+
+private:
+    bool createPipeline(GaugeShaders::Quality tier);
+    //图集纹理、文字管线，第一次绘制文字时创建
+    bool createLabelResources(QRhiResourceUpdateBatch *updates);
+    void releaseLabel();
+    //文字或视图尺寸变了才重新排版上传
+    void updateLabel(QRhiResourceUpdateBatch *updates,const QSize &pixelSize,float pixelScale,float progress);
+
+private:
+    GaugeType type;
+    GaugeShaders::Quality quality{ GaugeShaders::QualityDefault };
+    QRhi *rhi{ nullptr };
+    QRhiRenderPassDescriptor *renderPass{ nullptr };
+    int sampleCount{ 1 };
+    //四边形顶点，静态，第一帧上传
+    QRhiBuffer *vertexBuffer{ nullptr };
+    bool vertexUploaded{ false };
+    //clipCorr和参数，每帧更新
+    QRhiBuffer *uniformBuffer{ nullptr };
+    QRhiShaderResourceBindings *bindings{ nullptr };
+    QRhiGraphicsPipeline *pipeline{ nullptr };
+    //当前管线对应的档位，已解析
+    GaugeShaders::Quality pipelineQuality{ GaugeShaders::QualityDefault };
+
+    //百分比文字
+    bool labelVisible{ true };
+    QFont labelFont{ "Microsoft YaHei", 16 };
+    QSharedPointer<const GlyphAtlas> labelAtlas;
+    QRhiTexture *labelTexture{ nullptr };
+    QRhiSampler *labelSampler{ nullptr };
+    QRhiBuffer *labelVertexBuffer{ nullptr };
+    QRhiBuffer *labelUniformBuffer{ nullptr };
+    QRhiShaderResourceBindings *labelBindings{ nullptr };
+    QRhiGraphicsPipeline *labelPipeline{ nullptr };
+    //已上传的文字和视图尺寸（逻辑像素）
+    QString labelText;
+    QSizeF labelView;
+    int labelVertexCount{ 0 };
+};
@@ -0,0 +1,141 @@
+#include "GaugeRhiWidget.h"
+#include "GaugeValueFeed.h"
+
+#include <QDebug>
+
+#include <cmath>
+
+//波浪一个周期的时长，与WaveProgressBar一致
+static const double wave_period_s=5.4;
+
+GaugeRhiWidget::GaugeRhiWidget(GaugeRhiRenderer::GaugeType type, QWidget *parent)
+    : QRhiWidget(parent)
+    , renderer(type)
+{
+    bool ok=false;
+    const Api api=apiFromEnvironment(&ok);
+    if(ok)
+        setApi(api);
+
+    animation=new QPropertyAnimation(this,"drawValue");
+    animation->setDuration(2000); //动画持续时间
+    animation->setEasingCurve(QEasingCurve::OutQuart); //先快后慢
+    clock.start();
+}
+
+GaugeRhiWidget::~GaugeRhiWidget()
+{
+}
+
+GaugeRhiRenderer::GaugeType GaugeRhiWidget::gaugeType() const
+{
+    return renderer.gaugeType();
+}
+
+void GaugeRhiWidget::setRange(double min, double max)
+{
+    if(max<=min)
+        return;
+    progressMin=min;
+    progressMax=max;
+    update();
+}
+
+void GaugeRhiWidget::setValue(double value)
+{
+    if(value<progressMin||value>progressMax)
+        return;
+    progressValue=value;
+    //从当前绘制的值继续，动画进行中时只改终点不重新计时
+    GaugeValueFeed::retarget(animation,progressDraw,progressValue);
+}
+
+double GaugeRhiWidget::getDrawValue() const
+{
+    return progressDraw;
+}
+
+void GaugeRhiWidget::setDrawValue(double value)
+{
+    progressDraw=value;
+    update();
+}
+
+void GaugeRhiWidget::setQuality(GaugeShaders::Quality quality)
+{
+    renderer.setQuality(quality);
+    update();
+}
+
+GaugeShaders::Quality GaugeRhiWidget::getQuality() const
+{
+    return renderer.getQuality();
+}
+
+void GaugeRhiWidget::setLabelFont(const QFont &font)
+{
+    renderer.setLabelFont(font);
+    update();
+}
+
+QFont GaugeRhiWidget::getLabelFont() const
+{
+    return renderer.getLabelFont();
+}
+
+QRhiWidget::Api GaugeRhiWidget::apiFromEnvironment(bool *ok)
+{
+    const QString name=qEnvironmentVariable("GAUGE_RHI_API").trimmed().toLower();
+    if(ok)
+        *ok=true;
+    if(name=="opengl"||name=="gl")
+        return Api::OpenGL;
+    if(name=="vulkan")
+        return Api::Vulkan;
+    if(name=="d3d11")
+        return Api::Direct3D11;
+    if(name=="d3d12")
+        return Api::Direct3D12;
+    if(name=="metal")
+        return Api::Metal;
+    if(name=="null")
+        return Api::Null;
+    if(ok)
+        *ok=false;
+    if(!name.isEmpty())
+        qWarning()<<"GaugeRhiWidget: unknown GAUGE_RHI_API"<<name;
+    return Api::OpenGL;
+}
+
+void GaugeRhiWidget::initialize(QRhiCommandBuffer *)
+{
+    //尺寸变化时也会调用，渲染通道保持兼容，只有QRhi或采样数变了才重建
+    if(renderer.isInitialized()&&rendererRhi==rhi()&&rendererSamples==sampleCount())
+        return;
+    rendererRhi=rhi();
+    rendererSamples=sampleCount();
+    if(!renderer.initialize(rhi(),renderTarget()->renderPassDescriptor(),sampleCount()))
+        rendererRhi=nullptr;
+}
+
+void GaugeRhiWidget::render(QRhiCommandBuffer *cb)
+{
+    const bool wave=(renderer.gaugeType()==GaugeRhiRenderer::WaveGauge);
+    const float time=wave?float(std::fmod(clock.nsecsElapsed()/1e9/wave_period_s,1.0)):0.0f;
+    renderer.render(cb,renderTarget(),normalizedProgress(progressDraw),time,float(devicePixelRatioF()));
+    //进度球一直在动，在render里请求下一帧，跟随窗口的刷新节奏
+    if(wave)
+        update();
+}
+
+void GaugeRhiWidget::releaseResources()
+{
+    renderer.release();
+    rendererRhi=nullptr;
+}
+
+float GaugeRhiWidget::normalizedProgress(double value) const
+{
+    //把进度[min,max]归一化[0,1]
+    return (value-progressMin)/(progressMax-progressMin);
+}
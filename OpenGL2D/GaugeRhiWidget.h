@@ -0,0 +1,62 @@
+#pragma once
+#include <QRhiWidget>
+#include <QElapsedTimer>
+#include <QPropertyAnimation>
+#include "GaugeRhiRenderer.h"
+
+//龚建波：QRhi后端的进度条，Qt6.7起可用，接口与CircleProgressBar/WaveProgressBar的基本部分一致
+//绘制走Qt6的图形抽象层，可以是OpenGL、Vulkan、Direct3D或Metal，着色器为构建时预编译的.qsb
+//图形API默认为平台默认值，设置环境变量GAUGE_RHI_API可以指定
+class GaugeRhiWidget : public QRhiWidget
+{
+    Q_OBJECT
+    Q_PROPERTY(double drawValue READ getDrawValue WRITE setDrawValue)
+public:
+    explicit GaugeRhiWidget(GaugeRhiRenderer::GaugeType type = GaugeRhiRenderer::CircleGauge,
+                            QWidget *parent = nullptr);
+    ~GaugeRhiWidget();
+
+    GaugeRhiRenderer::GaugeType gaugeType() const;
+
+    void setRange(double min,double max);
+    void setValue(double value);
+
+    double getDrawValue() const;
+    void setDrawValue(double value);
+
+    //画质档位，换档时重建管线，不需要编译着色器
+    void setQuality(GaugeShaders::Quality quality);
+    GaugeShaders::Quality getQuality() const;
+
+    //百分比文字的字体，默认QFont("Microsoft YaHei",16)
+    void setLabelFont(const QFont &font);
+    QFont getLabelFont() const;
+
+    //按环境变量GAUGE_RHI_API选择图形API：opengl、vulkan、d3d11、d3d12、metal、null
+    //未设置或不认识时ok为false，返回值无意义
+    static Api apiFromEnvironment(bool *ok = nullptr);
+
+protected:
+    void initialize(QRhiCommandBuffer *cb) override;
+    void render(QRhiCommandBuffer *cb) override;
+    void releaseResources() override;
+
+private:
+    //把进度[min,max]归一化[0,1]
+    float normalizedProgress(double value) const;
+
+private:
+    GaugeRhiRenderer renderer;
+    //renderer创建时的QRhi和采样数，变了要重建
+    QRhi *rendererRhi{ nullptr };
+    int rendererSamples{ 0 };
+    //属性动画
+    QPropertyAnimation *animation{ nullptr };
+    //波浪时间，单调时钟
+    QElapsedTimer clock;
+    //进度值
+    double progressMin{ 0 };
+    double progressMax{ 100 };
+    double progressValue{ 0 }; //设置的值
+    double progressDraw{ 0 }; //绘制临时值
+};
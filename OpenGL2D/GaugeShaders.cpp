@@ -0,0 +1,398 @@
+#include "GaugeShaders.h"
+
+#include <QAtomicInt>
+#include <QFile>
+#include <QDebug>
+
+//全局默认档位
+static QAtomicInt default_quality(GaugeShaders::QualityHigh);
+
+//着色器代码
+//in输入，out输出,uniform从cpu向gpu发送
+//[aPos]两个三角的顶点数据
+//[thePos]表示当前像素点
+static const char *vertex_str=R"(#version 330 core
+                              layout (location = 0) in vec2 aPos;
+                              out vec2 thePos;
+                              void main()
+                              {
+                                gl_Position = vec4(aPos, 0.0, 1.0);
+                                thePos = aPos;
+                              })";
+
+//圆环网格
+//[aPos]xy为单位圆上的方向，z为0内圈、1外圈
+//[aRadii]内外圈半径，外圈已按多边形外接放大
+static const char *mesh_vertex_str=R"(#version 330 core
+                                   layout (location = 0) in vec3 aPos;
+                                   uniform vec2 aRadii;
+                                   out vec2 thePos;
+                                   void main()
+                                   {
+                                     vec2 pos = aPos.xy*mix(aRadii.x,aRadii.y,aPos.z);
+                                     gl_Position = vec4(pos, 0.0, 1.0);
+                                     thePos = pos;
+                                   })";
+
+//实例化绘制共用的顶点着色器
+//[aPos]两个三角的顶点数据，每个实例共用
+//[aRect]实例的像素区域x,y,w,h，以短边为边长居中
+//[aData]实例的进度、相位、样式
+//[thePos]表示当前像素点在仪表内的坐标[-1,1]，窗口坐标y轴向下，仪表坐标y轴向上
+static const char *canvas_vertex_str=R"(#version 330 core
+                                     layout (location = 0) in vec2 aPos;
+                                     layout (location = 1) in vec4 aRect;
+                                     layout (location = 2) in vec4 aData;
+                                     uniform vec2 aViewSize;
+                                     out vec2 thePos;
+                                     flat out vec4 theData;
+                                     flat out float theSmoothWidth;
+                                     void main()
+                                     {
+                                       float side = max(min(aRect.z,aRect.w),1.0);
+                                       vec2 center = aRect.xy+aRect.zw*0.5;
+                                       vec2 pixel = center+vec2(aPos.x,-aPos.y)*side*0.5;
+                                       gl_Position = vec4(pixel.x/aViewSize.x*2.0-1.0,
+                                                          1.0-pixel.y/aViewSize.y*2.0,
+                                                          0.0, 1.0);
+                                       thePos = aPos;
+                                       theData = aData;
+                                       theSmoothWidth = 3.0/side;
+                                     })";
+
+//Qt Quick场景图
+//[qt_Vertex]场景图的顶点坐标，合批时由渲染器变换到批次的根节点下
+//[aPos]仪表内的坐标[-1,1]，y轴向上
+//[aData]进度、时间、平滑宽度，同一个仪表的四个顶点相同
+static const char *quick_vertex_str=R"(#version 330 core
+                                    in vec4 qt_Vertex;
+                                    in vec2 aPos;
+                                    in vec4 aData;
+                                    uniform mat4 qt_Matrix;
+                                    out vec2 thePos;
+                                    flat out vec4 theData;
+                                    void main()
+                                    {
+                                      gl_Position = qt_Matrix*qt_Vertex;
+                                      thePos = aPos;
+                                      theData = aData;
+                                    })";
+
+//环形进度条和进度球的像素计算在shaders/gauge.glsl，与QRhi后端共用，从qrc读取，见gaugeBody()
+
+//GPU缓动，GPU_EASING时由着色器计算进度，CPU只上传一次起止值和时间
+//[aEasing]起点、终点、开始时间、时长，进度已归一化；开始时间由CPU换算成0
+//[aCurve]曲线，见GaugeEasing::Curve
+//[aNow]距开始的秒数，CPU端用double时钟算好，float只需表示几秒
+//曲线对整个绘制是统一的，分支不会在像素间发散
+static const char *easing_str=R"(
+                              #ifdef GPU_EASING
+                              uniform vec4 aEasing;
+                              uniform int aCurve;
+                              uniform float aNow;
+                              float easedValue()
+                              {
+                                float u = clamp((aNow-aEasing.z)/max(aEasing.w,0.000001),0.0,1.0);
+                                float r = 1.0-u;
+                                float k = u;
+                                if(aCurve==1) k = 1.0-r*r;
+                                else if(aCurve==2) k = 1.0-r*r*r;
+                                else if(aCurve==3) k = 1.0-r*r*r*r;
+                                else if(aCurve==4) k = u<0.5 ? 4.0*u*u*u : 1.0-4.0*r*r*r;
+                                return mix(aEasing.x,aEasing.y,k);
+                              }
+                              #define GAUGE_VALUE easedValue()
+                              #else
+                              #define GAUGE_VALUE aValue
+                              #endif
+                              )";
+
+static const char *circle_main_str=R"(
+                                   uniform float aValue;
+                                   uniform float aSmoothWidth;
+                                   in vec2 thePos;
+                                   out vec4 FragColor;
+                                   void main()
+                                   {
+                                     FragColor = circleColor(thePos,GAUGE_VALUE,aSmoothWidth);
+                                   })";
+
+static const char *wave_main_str=R"(
+                                 uniform float aValue;
+                                 uniform float aTime;
+                                 uniform float aSmoothWidth;
+                                 in vec2 thePos;
+                                 out vec4 FragColor;
+                                 void main()
+                                 {
+                                   FragColor = waveColor(thePos,GAUGE_VALUE,aTime,aSmoothWidth);
+                                 })";
+
+//画布：进度和平滑宽度从实例数据读取，颜色乘以调色板
+static const char *canvas_circle_main_str=R"(
+                                          uniform vec3 aPalette[4];
+                                          in vec2 thePos;
+                                          flat in vec4 theData;
+                                          flat in float theSmoothWidth;
+                                          out vec4 FragColor;
+                                          void main()
+                                          {
+                                            FragColor = circleColor(thePos,theData.x,theSmoothWidth);
+                                            FragColor.rgb *= aPalette[int(theData.z)];
+                                          })";
+
+//画布：[aTime]为全局时间，加上实例的相位偏移
+static const char *canvas_wave_main_str=R"(
+                                        uniform vec3 aPalette[4];
+                                        uniform float aTime;
+                                        in vec2 thePos;
+                                        flat in vec4 theData;
+                                        flat in float theSmoothWidth;
+                                        out vec4 FragColor;
+                                        void main()
+                                        {
+                                          float theTime = fract(aTime+theData.y);
+                                          FragColor = waveColor(thePos,theData.x,theTime,theSmoothWidth);
+                                          FragColor.rgb *= aPalette[int(theData.z)];
+                                        })";
+
+//场景图：按预乘alpha混合，乘以节点的不透明度
+static const char *quick_circle_main_str=R"(
+                                         uniform float qt_Opacity;
+                                         in vec2 thePos;
+                                         flat in vec4 theData;
+                                         out vec4 FragColor;
+                                         void main()
+                                         {
+                                           vec4 color = circleColor(thePos,theData.x,theData.z);
+                                           FragColor = vec4(color.rgb*color.a,color.a)*qt_Opacity;
+                                         })";
+
+static const char *quick_wave_main_str=R"(
+                                       uniform float qt_Opacity;
+                                       in vec2 thePos;
+                                       flat in vec4 theData;
+                                       out vec4 FragColor;
+                                       void main()
+                                       {
+                                         vec4 color = waveColor(thePos,theData.x,theData.y,theData.z);
+                                         FragColor = vec4(color.rgb*color.a,color.a)*qt_Opacity;
+                                       })";
+
+//百分比文字
+//[aPos]字符矩形顶点，单位与窗口坐标一致，y轴向下
+//[aUV]图集纹理坐标
+static const char *label_vertex_str=R"(#version 330 core
+                                    layout (location = 0) in vec2 aPos;
+                                    layout (location = 1) in vec2 aUV;
+                                    uniform vec2 aViewSize;
+                                    out vec2 theUV;
+                                    void main()
+                                    {
+                                      gl_Position = vec4(aPos.x/aViewSize.x*2.0-1.0,
+                                                         1.0-aPos.y/aViewSize.y*2.0,
+                                                         0.0, 1.0);
+                                      theUV = aUV;
+                                    })";
+//距离场0.5处为字形边缘，用fwidth得到一个像素对应的距离变化做抗锯齿
+static const char *label_fragment_str=R"(#version 330 core
+                                      uniform sampler2D aAtlas;
+                                      uniform vec4 aColor;
+                                      in vec2 theUV;
+                                      out vec4 FragColor;
+                                      void main()
+                                      {
+                                        float dist = texture(aAtlas,theUV).r;
+                                        float w = max(fwidth(dist)*0.7,0.0001);
+                                        float alpha = smoothstep(0.5-w,0.5+w,dist);
+                                        FragColor = vec4(aColor.rgb,aColor.a*alpha);
+                                      })";
+
+//预烘焙帧回放
+//[aFrames]一个周期的帧，每层一帧
+//[aLayer]当前帧的层号
+static const char *atlas_fragment_str=R"(#version 330 core
+                                      uniform sampler2DArray aFrames;
+                                      uniform float aLayer;
+                                      in vec2 thePos;
+                                      out vec4 FragColor;
+                                      void main()
+                                      {
+                                        FragColor = texture(aFrames,vec3(thePos*0.5+0.5,aLayer));
+                                      })";
+
+void GaugeShaders::setDefaultQuality(Quality quality)
+{
+    if(quality==QualityDefault)
+        quality=QualityHigh;
+    default_quality.storeRelease(quality);
+}
+
+GaugeShaders::Quality GaugeShaders::defaultQuality()
+{
+    return Quality(default_quality.loadAcquire());
+}
+
+GaugeShaders::Quality GaugeShaders::resolve(Quality quality)
+{
+    return quality==QualityDefault?defaultQuality():quality;
+}
+
+QString GaugeShaders::programKey(const QString &name, Quality quality)
+{
+    return name+QStringLiteral(".q")+QString::number(resolve(quality));
+}
+
+GaugeShaders::ProgramSource GaugeShaders::programSource(Program program, Quality quality, Variants variants)
+{
+    ProgramSource source;
+    switch(program)
+    {
+    case CircleProgram:
+        source.key=programKey(QStringLiteral("CircleProgressBar"),quality)+variantSuffix(variants);
+        source.vertex=variants.testFlag(MeshVariant)?meshVertexSource():vertexSource();
+        source.fragment=circleFragment(quality,variants);
+        break;
+    case WaveProgram:
+        source.key=programKey(QStringLiteral("WaveProgressBar"),quality)+variantSuffix(variants);
+        source.vertex=variants.testFlag(MeshVariant)?meshVertexSource():vertexSource();
+        source.fragment=waveFragment(quality,variants);
+        break;
+    case CanvasCircleProgram:
+        source.key=programKey(QStringLiteral("GaugeCanvas.Circle"),quality);
+        source.vertex=canvasVertexSource();
+        source.fragment=canvasCircleFragment(quality);
+        break;
+    case CanvasWaveProgram:
+        source.key=programKey(QStringLiteral("GaugeCanvas.Wave"),quality);
+        source.vertex=canvasVertexSource();
+        source.fragment=canvasWaveFragment(quality);
+        break;
+    case LabelProgram:
+        source.key=QStringLiteral("Label");
+        source.vertex=labelVertexSource();
+        source.fragment=labelFragmentSource();
+        break;
+    case AtlasProgram:
+        source.key=QStringLiteral("WaveAtlas");
+        source.vertex=vertexSource();
+        source.fragment=atlasFragmentSource();
+        break;
+    default:
+        break;
+    }
+    return source;
+}
+
+QByteArray GaugeShaders::vertexSource()
+{
+    return QByteArray(vertex_str);
+}
+
+QByteArray GaugeShaders::meshVertexSource()
+{
+    return QByteArray(mesh_vertex_str);
+}
+
+QByteArray GaugeShaders::circleFragment(Quality quality, Variants variants)
+{
+    return header(quality,variants)+gaugeBody()+easing_str+circle_main_str;
+}
+
+QByteArray GaugeShaders::waveFragment(Quality quality, Variants variants)
+{
+    return header(quality,variants)+gaugeBody()+easing_str+wave_main_str;
+}
+
+QByteArray GaugeShaders::canvasVertexSource()
+{
+    return QByteArray(canvas_vertex_str);
+}
+
+QByteArray GaugeShaders::canvasCircleFragment(Quality quality)
+{
+    return header(quality)+gaugeBody()+canvas_circle_main_str;
+}
+
+QByteArray GaugeShaders::canvasWaveFragment(Quality quality)
+{
+    return header(quality)+gaugeBody()+canvas_wave_main_str;
+}
+
+QByteArray GaugeShaders::quickVertexSource()
+{
+    return QByteArray(quick_vertex_str);
+}
+
+QByteArray GaugeShaders::quickCircleFragment(Quality quality)
+{
+    return header(quality)+gaugeBody()+quick_circle_main_str;
+}
+
+QByteArray GaugeShaders::quickWaveFragment(Quality quality)
+{
+    return header(quality)+gaugeBody()+quick_wave_main_str;
+}
+
+QByteArray GaugeShaders::labelVertexSource()
+{
+    return QByteArray(label_vertex_str);
+}
+
+QByteArray GaugeShaders::labelFragmentSource()
+{
+    return QByteArray(label_fragment_str);
+}
+
+QVector<GaugeShaders::Variants> GaugeShaders::programVariants(Program program)
+{
+    QVector<Variants> variants;
+    variants<<NoVariant;
+    if(program==CircleProgram||program==WaveProgram)
+        variants<<GpuEasingVariant<<MeshVariant<<(GpuEasingVariant|MeshVariant);
+    return variants;
+}
+
+QString GaugeShaders::variantSuffix(Variants variants)
+{
+    QString suffix;
+    if(variants.testFlag(GpuEasingVariant))
+        suffix+=QStringLiteral(".e");
+    if(variants.testFlag(MeshVariant))
+        suffix+=QStringLiteral(".m");
+    return suffix;
+}
+
+QByteArray GaugeShaders::atlasFragmentSource()
+{
+    return QByteArray(atlas_fragment_str);
+}
+
+bool GaugeShaders::isQualityIndependent(Program program)
+{
+    return program==LabelProgram||program==AtlasProgram;
+}
+
+QByteArray GaugeShaders::header(Quality quality, Variants variants)
+{
+    QByteArray source("#version 330 core\n");
+    if(variants.testFlag(GpuEasingVariant))
+        source+="#define GPU_EASING\n";
+    //各档位对应的开关在gauge.glsl里按GAUGE_QUALITY展开，与qsb编译的QRhi着色器一致
+    source+="#define GAUGE_QUALITY "+QByteArray::number(int(resolve(quality)))+"\n";
+    return source;
+}
+
+QByteArray GaugeShaders::gaugeBody()
+{
+    //只读一次，预编译线程和GUI线程都可能调用，局部静态变量的初始化是线程安全的
+    static const QByteArray body=[]{
+        QFile file(QStringLiteral(":/OpenGL2D/shaders/gauge.glsl"));
+        if(!file.open(QIODevice::ReadOnly)){
+            qWarning()<<"GaugeShaders: missing"<<file.fileName();
+            return QByteArray();
+        }
+        return file.readAll();
+    }();
+    return body;
+}
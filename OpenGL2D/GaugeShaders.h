@@ -0,0 +1,92 @@
+#pragma once
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+#include <QFlags>
+
+//进度条着色器源码
+//同一份GLSL按画质档位拼接#define开关，生成不同的特化程序
+//  GAUGE_QUALITY 画质档位，展开成哪些开关见shaders/gauge.glsl，QRhi后端的着色器也包含这个文件
+//  GPU_EASING    进度由着色器按缓动参数和当前时间计算，见GaugeEasing
+class GaugeShaders
+{
+public:
+    //画质档位
+    enum Quality {
+        QualityDefault = -1, //跟随全局设置
+        QualityHigh = 0,     //原始算法
+        QualityMedium = 1,   //近似函数+无分支
+        QualityLow = 2       //在Medium基础上去掉一层波浪
+    };
+
+    //全局默认档位，实例设置为QualityDefault时使用
+    static void setDefaultQuality(Quality quality);
+    static Quality defaultQuality();
+    //QualityDefault换成全局档位
+    static Quality resolve(Quality quality);
+    //着色器程序在缓存中的key，区分档位
+    static QString programKey(const QString &name,Quality quality);
+
+    //所有着色器程序，预编译时逐个遍历
+    enum Program {
+        CircleProgram,       //CircleProgressBar
+        WaveProgram,         //WaveProgressBar
+        CanvasCircleProgram, //GaugeCanvas的环形进度条
+        CanvasWaveProgram,   //GaugeCanvas的进度球
+        LabelProgram,        //百分比文字，与档位无关
+        AtlasProgram,        //预烘焙波浪帧的回放，与档位无关
+        ProgramCount
+    };
+    //程序在缓存中的key和源码
+    struct ProgramSource {
+        QString key;
+        QByteArray vertex;
+        QByteArray fragment;
+    };
+    //单个控件程序的特化，只对CircleProgram/WaveProgram有效
+    enum Variant {
+        NoVariant = 0,
+        GpuEasingVariant = 0x1, //进度由着色器按缓动参数计算
+        MeshVariant = 0x2       //圆环/圆盘网格代替全窗口矩形，见meshVertexSource
+    };
+    Q_DECLARE_FLAGS(Variants,Variant)
+    static ProgramSource programSource(Program program,Quality quality,Variants variants=NoVariant);
+    //程序可能用到的所有特化组合，NoVariant在最前，预编译时遍历
+    static QVector<Variants> programVariants(Program program);
+
+    //单个控件：全窗口矩形
+    static QByteArray vertexSource();
+    //圆环网格：顶点为单位方向和内外圈标记，半径由uniform给出
+    static QByteArray meshVertexSource();
+    static QByteArray circleFragment(Quality quality,Variants variants=NoVariant);
+    static QByteArray waveFragment(Quality quality,Variants variants=NoVariant);
+
+    //画布：实例化绘制
+    static QByteArray canvasVertexSource();
+    static QByteArray canvasCircleFragment(Quality quality);
+    static QByteArray canvasWaveFragment(Quality quality);
+
+    //Qt Quick场景图：进度等数据放在顶点里，同类仪表可以合批，见GaugeQuickMaterial
+    static QByteArray quickVertexSource();
+    static QByteArray quickCircleFragment(Quality quality);
+    static QByteArray quickWaveFragment(Quality quality);
+
+    //百分比文字：SDF字形图集
+    static QByteArray labelVertexSource();
+    static QByteArray labelFragmentSource();
+
+    //预烘焙帧回放：纹理数组按层取一帧
+    static QByteArray atlasFragmentSource();
+    //与档位无关的程序，预编译时只编译一次
+    static bool isQualityIndependent(Program program);
+
+private:
+    //#version和#define头
+    static QByteArray header(Quality quality,Variants variants=NoVariant);
+    //shaders/gauge.glsl，圆环和进度球的公共计算
+    static QByteArray gaugeBody();
+    //特化在缓存key中的后缀
+    static QString variantSuffix(Variants variants);
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(GaugeShaders::Variants)
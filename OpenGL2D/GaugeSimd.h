@@ -0,0 +1,141 @@
+#pragma once
+#include <QtGlobal>
+
+#include <algorithm>
+#include <cmath>
+
+//SIMD的float向量，CPU光栅化和动画管理共用
+//  AVX2   编译时开启(-mavx2或/arch:AVX2)，一次8个
+//  SSE2   x86/x64默认，一次4个
+//  Scalar 其他平台，一次1个
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define GAUGE_SIMD_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define GAUGE_SIMD_SSE2
+#endif
+
+namespace GaugeSimd {
+
+//FloatN：一组float，比较运算得到掩码，配合select做无分支选择
+#if defined(GAUGE_SIMD_AVX2)
+struct FloatN
+{
+    enum { Size = 8 };
+    __m256 v;
+    FloatN() {}
+    FloatN(__m256 v):v(v) {}
+    FloatN(float f):v(_mm256_set1_ps(f)) {}
+    static FloatN load(const float *p) { return _mm256_loadu_ps(p); }
+    static FloatN ramp() { return _mm256_setr_ps(0,1,2,3,4,5,6,7); }
+    void store(float *p) const { _mm256_storeu_ps(p,v); }
+};
+inline FloatN operator+(FloatN a,FloatN b) { return _mm256_add_ps(a.v,b.v); }
+inline FloatN operator-(FloatN a,FloatN b) { return _mm256_sub_ps(a.v,b.v); }
+inline FloatN operator*(FloatN a,FloatN b) { return _mm256_mul_ps(a.v,b.v); }
+inline FloatN operator/(FloatN a,FloatN b) { return _mm256_div_ps(a.v,b.v); }
+inline FloatN operator<(FloatN a,FloatN b) { return _mm256_cmp_ps(a.v,b.v,_CMP_LT_OQ); }
+inline FloatN operator<=(FloatN a,FloatN b) { return _mm256_cmp_ps(a.v,b.v,_CMP_LE_OQ); }
+inline FloatN operator>(FloatN a,FloatN b) { return _mm256_cmp_ps(a.v,b.v,_CMP_GT_OQ); }
+inline FloatN operator>=(FloatN a,FloatN b) { return _mm256_cmp_ps(a.v,b.v,_CMP_GE_OQ); }
+inline FloatN operator==(FloatN a,FloatN b) { return _mm256_cmp_ps(a.v,b.v,_CMP_EQ_OQ); }
+inline FloatN operator!=(FloatN a,FloatN b) { return _mm256_cmp_ps(a.v,b.v,_CMP_NEQ_UQ); }
+inline FloatN operator&(FloatN a,FloatN b) { return _mm256_and_ps(a.v,b.v); }
+inline FloatN vmin(FloatN a,FloatN b) { return _mm256_min_ps(a.v,b.v); }
+inline FloatN vmax(FloatN a,FloatN b) { return _mm256_max_ps(a.v,b.v); }
+inline FloatN vsqrt(FloatN a) { return _mm256_sqrt_ps(a.v); }
+inline FloatN vabs(FloatN a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f),a.v); }
+//mask为真取a，否则取b
+inline FloatN select(FloatN mask,FloatN a,FloatN b) { return _mm256_blendv_ps(b.v,a.v,mask.v); }
+//[0,1]的rgb打包为0xffRRGGBB
+inline void storePixels(quint32 *dst,FloatN r,FloatN g,FloatN b)
+{
+    const __m256 scale=_mm256_set1_ps(255.0f);
+    const __m256 zero=_mm256_setzero_ps();
+    const __m256i ir=_mm256_cvtps_epi32(_mm256_mul_ps(_mm256_min_ps(_mm256_max_ps(r.v,zero),_mm256_set1_ps(1.0f)),scale));
+    const __m256i ig=_mm256_cvtps_epi32(_mm256_mul_ps(_mm256_min_ps(_mm256_max_ps(g.v,zero),_mm256_set1_ps(1.0f)),scale));
+    const __m256i ib=_mm256_cvtps_epi32(_mm256_mul_ps(_mm256_min_ps(_mm256_max_ps(b.v,zero),_mm256_set1_ps(1.0f)),scale));
+    __m256i px=_mm256_or_si256(_mm256_slli_epi32(ir,16),_mm256_slli_epi32(ig,8));
+    px=_mm256_or_si256(px,ib);
+    px=_mm256_or_si256(px,_mm256_set1_epi32(static_cast<int>(0xff000000u)));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst),px);
+}
+#elif defined(GAUGE_SIMD_SSE2)
+struct FloatN
+{
+    enum { Size = 4 };
+    __m128 v;
+    FloatN() {}
+    FloatN(__m128 v):v(v) {}
+    FloatN(float f):v(_mm_set1_ps(f)) {}
+    static FloatN load(const float *p) { return _mm_loadu_ps(p); }
+    static FloatN ramp() { return _mm_setr_ps(0,1,2,3); }
+    void store(float *p) const { _mm_storeu_ps(p,v); }
+};
+inline FloatN operator+(FloatN a,FloatN b) { return _mm_add_ps(a.v,b.v); }
+inline FloatN operator-(FloatN a,FloatN b) { return _mm_sub_ps(a.v,b.v); }
+inline FloatN operator*(FloatN a,FloatN b) { return _mm_mul_ps(a.v,b.v); }
+inline FloatN operator/(FloatN a,FloatN b) { return _mm_div_ps(a.v,b.v); }
+inline FloatN operator<(FloatN a,FloatN b) { return _mm_cmplt_ps(a.v,b.v); }
+inline FloatN operator<=(FloatN a,FloatN b) { return _mm_cmple_ps(a.v,b.v); }
+inline FloatN operator>(FloatN a,FloatN b) { return _mm_cmpgt_ps(a.v,b.v); }
+inline FloatN operator>=(FloatN a,FloatN b) { return _mm_cmpge_ps(a.v,b.v); }
+inline FloatN operator==(FloatN a,FloatN b) { return _mm_cmpeq_ps(a.v,b.v); }
+inline FloatN operator!=(FloatN a,FloatN b) { return _mm_cmpneq_ps(a.v,b.v); }
+inline FloatN operator&(FloatN a,FloatN b) { return _mm_and_ps(a.v,b.v); }
+inline FloatN vmin(FloatN a,FloatN b) { return _mm_min_ps(a.v,b.v); }
+inline FloatN vmax(FloatN a,FloatN b) { return _mm_max_ps(a.v,b.v); }
+inline FloatN vsqrt(FloatN a) { return _mm_sqrt_ps(a.v); }
+inline FloatN vabs(FloatN a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f),a.v); }
+//mask为真取a，否则取b，SSE2没有blendv，用与或组合
+inline FloatN select(FloatN mask,FloatN a,FloatN b) { return _mm_or_ps(_mm_and_ps(mask.v,a.v),_mm_andnot_ps(mask.v,b.v)); }
+//[0,1]的rgb打包为0xffRRGGBB
+inline void storePixels(quint32 *dst,FloatN r,FloatN g,FloatN b)
+{
+    const __m128 scale=_mm_set1_ps(255.0f);
+    const __m128 zero=_mm_setzero_ps();
+    const __m128i ir=_mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(r.v,zero),_mm_set1_ps(1.0f)),scale));
+    const __m128i ig=_mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(g.v,zero),_mm_set1_ps(1.0f)),scale));
+    const __m128i ib=_mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(b.v,zero),_mm_set1_ps(1.0f)),scale));
+    __m128i px=_mm_or_si128(_mm_slli_epi32(ir,16),_mm_slli_epi32(ig,8));
+    px=_mm_or_si128(px,ib);
+    px=_mm_or_si128(px,_mm_set1_epi32(static_cast<int>(0xff000000u)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst),px);
+}
+#else
+//标量版本，掩码用1.0/0.0表示
+struct FloatN
+{
+    enum { Size = 1 };
+    float v;
+    FloatN() {}
+    FloatN(float f):v(f) {}
+    static FloatN load(const float *p) { return *p; }
+    static FloatN ramp() { return 0.0f; }
+    void store(float *p) const { *p=v; }
+};
+inline FloatN operator+(FloatN a,FloatN b) { return a.v+b.v; }
+inline FloatN operator-(FloatN a,FloatN b) { return a.v-b.v; }
+inline FloatN operator*(FloatN a,FloatN b) { return a.v*b.v; }
+inline FloatN operator/(FloatN a,FloatN b) { return a.v/b.v; }
+inline FloatN operator<(FloatN a,FloatN b) { return a.v<b.v?1.0f:0.0f; }
+inline FloatN operator<=(FloatN a,FloatN b) { return a.v<=b.v?1.0f:0.0f; }
+inline FloatN operator>(FloatN a,FloatN b) { return a.v>b.v?1.0f:0.0f; }
+inline FloatN operator>=(FloatN a,FloatN b) { return a.v>=b.v?1.0f:0.0f; }
+inline FloatN operator==(FloatN a,FloatN b) { return a.v==b.v?1.0f:0.0f; }
+inline FloatN operator!=(FloatN a,FloatN b) { return a.v!=b.v?1.0f:0.0f; }
+inline FloatN operator&(FloatN a,FloatN b) { return (a.v!=0.0f&&b.v!=0.0f)?1.0f:0.0f; }
+inline FloatN vmin(FloatN a,FloatN b) { return std::min(a.v,b.v); }
+inline FloatN vmax(FloatN a,FloatN b) { return std::max(a.v,b.v); }
+inline FloatN vsqrt(FloatN a) { return std::sqrt(a.v); }
+inline FloatN vabs(FloatN a) { return std::abs(a.v); }
+inline FloatN select(FloatN mask,FloatN a,FloatN b) { return mask.v!=0.0f?a:b; }
+inline void storePixels(quint32 *dst,FloatN r,FloatN g,FloatN b)
+{
+    auto channel=[](float c){ return quint32(std::lround(std::min(std::max(c,0.0f),1.0f)*255.0f)); };
+    *dst=0xff000000u|(channel(r.v)<<16)|(channel(g.v)<<8)|channel(b.v);
+}
+#endif
+
+} // namespace GaugeSimd
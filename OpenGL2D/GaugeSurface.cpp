@@ -0,0 +1,100 @@
+#include "GaugeSurface.h"
+#include "GLCapabilities.h"
+
+#include <QOpenGLWidget>
+#include <QOpenGLContext>
+#include <QDebug>
+
+//GL_ARB_ES2_compatibility，4.1起为核心
+#ifndef GL_RGB565
+#define GL_RGB565 0x8D62
+#endif
+
+bool GaugeSurface::apply(QOpenGLWidget *widget, Mode mode)
+{
+    if(!widget)
+        return false;
+    //初始化后Qt不会再重建FBO，只能在显示前设置
+    if(widget->isValid()){
+        qWarning()<<"GaugeSurface: surface mode must be set before the widget is shown";
+        return false;
+    }
+    widget->setFormat(format(mode,widget->format()));
+    widget->setTextureFormat(textureFormat(mode));
+    //整个控件都会被不透明的底色覆盖，父控件不用先画它下面的部分
+    widget->setAttribute(Qt::WA_OpaquePaintEvent,mode!=Default);
+    widget->setAttribute(Qt::WA_NoSystemBackground,mode!=Default);
+    return true;
+}
+
+QSurfaceFormat GaugeSurface::format(Mode mode, const QSurfaceFormat &base)
+{
+    QSurfaceFormat format=base;
+    if(mode==Default)
+        return format;
+    format.setDepthBufferSize(0);
+    format.setStencilBufferSize(0);
+    format.setSamples(0);
+    format.setAlphaBufferSize(0);
+    if(mode==LowBandwidth16&&supportsRgb565()){
+        format.setRedBufferSize(5);
+        format.setGreenBufferSize(6);
+        format.setBlueBufferSize(5);
+    }
+    return format;
+}
+
+GLenum GaugeSurface::textureFormat(Mode mode)
+{
+    switch(mode){
+    case LowBandwidth16:
+        if(supportsRgb565())
+            return GL_RGB565;
+        return GL_RGB8;
+    case LowBandwidth:
+        return GL_RGB8;
+    default:
+        return GL_RGBA8;
+    }
+}
+
+int GaugeSurface::bytesPerPixel(Mode mode)
+{
+    return textureFormat(mode)==GL_RGB565?2:4;
+}
+
+QString GaugeSurface::modeName(Mode mode)
+{
+    switch(mode){
+    case LowBandwidth: return QStringLiteral("low");
+    case LowBandwidth16: return QStringLiteral("low16");
+    default: return QStringLiteral("default");
+    }
+}
+
+GaugeSurface::Mode GaugeSurface::parseMode(const QString &name, bool *ok)
+{
+    const QString text=name.trimmed().toLower();
+    if(ok)
+        *ok=true;
+    if(text=="low")
+        return LowBandwidth;
+    if(text=="low16")
+        return LowBandwidth16;
+    if(ok)
+        *ok=(text=="default");
+    return Default;
+}
+
+bool GaugeSurface::supportsRgb565()
+{
+    QOpenGLContext *context=QOpenGLContext::currentContext();
+    if(context&&!context->isOpenGLES()){
+        const QSurfaceFormat format=context->format();
+        return format.majorVersion()*10+format.minorVersion()>=41||
+                context->hasExtension(QByteArrayLiteral("GL_ARB_ES2_compatibility"));
+    }
+    if(context)
+        return true;
+    return GLCapabilities::current().rgb565;
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <QSurfaceFormat>
+#include <QString>
+#include <qopengl.h>
+
+class QOpenGLWidget;
+
+//控件的表面格式
+//仪表只在不透明底色上画平面颜色和半透明边缘，用不到深度模板、多重采样和alpha通道
+//低带宽模式请求够用的最小格式：去掉深度模板和多重采样，颜色不带alpha，16位模式再降为RGB565
+//Qt5的QOpenGLWidget总会给自己的FBO加深度模板，控件不清除也不写入它，只占显存；
+//窗口表面、静态缓存等其他缓冲按这里的格式分配
+class GaugeSurface
+{
+public:
+    enum Mode {
+        Default = 0,        //不修改，RGBA8
+        LowBandwidth = 1,   //RGB8，无深度模板
+        LowBandwidth16 = 2  //RGB565，无深度模板，驱动不支持时退回RGB8
+    };
+
+    //在控件第一次显示前设置表面格式、FBO纹理格式和不透明绘制属性，控件已经初始化时不生效，返回false
+    static bool apply(QOpenGLWidget *widget,Mode mode);
+    //在base上按模式去掉不需要的缓冲
+    static QSurfaceFormat format(Mode mode,const QSurfaceFormat &base=QSurfaceFormat::defaultFormat());
+    //颜色缓冲的内部格式，有当前上下文时按它判断是否支持RGB565，否则按GLCapabilities
+    static GLenum textureFormat(Mode mode);
+    //颜色缓冲每像素的字节数，RGB8一般按4字节对齐存放
+    static int bytesPerPixel(Mode mode);
+
+    //命令行和日志用的名字：default、low、low16
+    static QString modeName(Mode mode);
+    static Mode parseMode(const QString &name,bool *ok=nullptr);
+
+private:
+    static bool supportsRgb565();
+};
@@ -0,0 +1,41 @@
+#pragma once
+#include <QAtomicInt>
+
+//单写单读的无锁交接，写端和读端各持有一份，中间一份用原子交换传递
+//写端写完back()后publish()，读端fetch()成功时front()换成最新的一份；
+//读端没取走时写端继续覆盖中间那份，两端都不等待对方
+template<typename T>
+class GaugeTripleBuffer
+{
+public:
+    //写端正在写的一份
+    T &back() { return items[backIndex]; }
+    //交出写好的一份，换回上一份中间值继续写
+    void publish() {
+        backIndex=middle.fetchAndStoreOrdered(backIndex|FreshBit)&IndexMask;
+    }
+    //写端是否交出了读端还没取的一份，只在读端调用
+    bool hasFresh() const {
+        return middle.loadAcquire()&FreshBit;
+    }
+    //有新的一份时换到读端，返回是否换了
+    bool fetch() {
+        if(!(middle.loadAcquire()&FreshBit))
+            return false;
+        frontIndex=middle.fetchAndStoreOrdered(frontIndex)&IndexMask;
+        return true;
+    }
+    //读端持有的一份，读端在fetch()交还前可以改写它，比如附上自己的栅栏
+    const T &front() const { return items[frontIndex]; }
+    T &front() { return items[frontIndex]; }
+    //初始化和清理时按下标访问，两端都不在使用时调用
+    T &at(int index) { return items[index]; }
+    static constexpr int Count = 3;
+
+private:
+    enum { IndexMask = 3, FreshBit = 4 };
+    T items[Count];
+    int backIndex{ 0 };
+    QAtomicInt middle{ 1 };
+    int frontIndex{ 2 };
+};
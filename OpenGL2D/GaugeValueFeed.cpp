@@ -0,0 +1,51 @@
+#include "GaugeValueFeed.h"
+
+#include <QVariantAnimation>
+
+#include <cstring>
+
+bool GaugeValueFeed::store(double value)
+{
+    quint64 bits=0;
+    std::memcpy(&bits,&value,sizeof(bits));
+    valueBits.storeRelease(bits);
+    //从0变1的那次写入负责请求刷新
+    return pending.fetchAndStoreOrdered(1)==0;
+}
+
+bool GaugeValueFeed::take(double &value)
+{
+    if(pending.fetchAndStoreOrdered(0)==0)
+        return false;
+    //清掉标记后才读值，期间的新写入会重新置位，下一帧再取一次
+    const quint64 bits=valueBits.loadAcquire();
+    std::memcpy(&value,&bits,sizeof(value));
+    return true;
+}
+
+bool GaugeValueFeed::hasPending() const
+{
+    return pending.loadAcquire()!=0;
+}
+
+void GaugeValueFeed::retarget(QVariantAnimation *animation, double current, double target)
+{
+    if(animation->state()==QAbstractAnimation::Running&&animation->duration()>0){
+        //value(u)=start+(end-start)*E(u)，保持u0和value(u0)=current不变求新的start
+        const double u=animation->currentTime()/double(animation->duration());
+        const double eased=animation->easingCurve().valueForProgress(u);
+        //剩余的缓动太少时反推的起点会很大，直接重新开始
+        if(eased<0.99){
+            const double start=(current-target*eased)/(1.0-eased);
+            QVariantAnimation::KeyValues values;
+            values<<qMakePair(0.0,QVariant(start))<<qMakePair(1.0,QVariant(target));
+            animation->setKeyValues(values);
+            return;
+        }
+    }
+    animation->stop();
+    QVariantAnimation::KeyValues values;
+    values<<qMakePair(0.0,QVariant(current))<<qMakePair(1.0,QVariant(target));
+    animation->setKeyValues(values);
+    animation->start();
+}
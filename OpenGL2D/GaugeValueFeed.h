@@ -0,0 +1,27 @@
+#pragma once
+#include <QAtomicInteger>
+
+class QVariantAnimation;
+
+//跨线程的进度值输入
+//任意一个线程写入，写入只是两次原子存储，不加锁；连续写入互相覆盖，只保留最新值
+//GUI线程每帧取一次最新值，没取走之前的写入不会再请求刷新
+class GaugeValueFeed
+{
+public:
+    //写入最新值，返回true表示之前没有待取的值，调用方需要请求一次刷新
+    bool store(double value);
+    //取走最新值，没有新值时返回false
+    bool take(double &value);
+    bool hasPending() const;
+
+    //把动画改为从当前值平滑走向target
+    //动画进行中时反推新的起点，使当前值和缓动进度保持不变，不重新开始计时；
+    //已停止或快结束时从current重新开始
+    static void retarget(QVariantAnimation *animation,double current,double target);
+
+private:
+    //double的位模式
+    QAtomicInteger<quint64> valueBits{ 0 };
+    QAtomicInt pending{ 0 };
+};
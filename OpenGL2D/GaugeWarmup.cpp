@@ -0,0 +1,140 @@
+#include "GaugeWarmup.h"
+#include "GaugeShaders.h"
+#include "GLResourceCache.h"
+
+#include <QThread>
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
+#include <QOffscreenSurface>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QVector>
+#include <QDebug>
+
+GaugeWarmup::GaugeWarmup(QObject *parent)
+    : QObject(parent)
+{
+}
+
+GaugeWarmup::~GaugeWarmup()
+{
+    wait();
+    onThreadFinished();
+}
+
+bool GaugeWarmup::start()
+{
+    if(thread)
+        return false;
+    QOpenGLContext *share_context=QOpenGLContext::globalShareContext();
+    if(!share_context){
+        qWarning()<<"GaugeWarmup: Qt::AA_ShareOpenGLContexts is not set";
+        return false;
+    }
+    //QOffscreenSurface需要在GUI线程创建
+    surface=new QOffscreenSurface;
+    surface->setFormat(share_context->format());
+    surface->create();
+    context=new QOpenGLContext;
+    context->setFormat(share_context->format());
+    context->setShareContext(share_context);
+    if(!context->create()){
+        qWarning()<<"GaugeWarmup: failed to create shared context";
+        onThreadFinished();
+        return false;
+    }
+
+    thread=QThread::create([this]{ run(); });
+    context->moveToThread(thread);
+    connect(thread,&QThread::finished,this,[this]{
+        onThreadFinished();
+        emit finished(programCount(),elapsedMs());
+    });
+    thread->start();
+    return true;
+}
+
+bool GaugeWarmup::isRunning() const
+{
+    return thread&&thread->isRunning();
+}
+
+void GaugeWarmup::wait()
+{
+    if(thread)
+        thread->wait();
+}
+
+int GaugeWarmup::programCount() const
+{
+    return programs.loadAcquire();
+}
+
+qint64 GaugeWarmup::elapsedMs() const
+{
+    return compileMs.loadAcquire();
+}
+
+void GaugeWarmup::run()
+{
+    if(!context->makeCurrent(surface)){
+        qWarning()<<"GaugeWarmup: makeCurrent failed";
+        context->moveToThread(qApp->thread());
+        return;
+    }
+    QElapsedTimer timer;
+    timer.start();
+    //当前默认档位最先用到，排在前面
+    QVector<GaugeShaders::Quality> qualities;
+    qualities<<GaugeShaders::defaultQuality();
+    for(GaugeShaders::Quality quality:{GaugeShaders::QualityHigh,GaugeShaders::QualityMedium,GaugeShaders::QualityLow}){
+        if(!qualities.contains(quality))
+            qualities<<quality;
+    }
+    QThread *gui_thread=qApp->thread();
+    int count=0;
+    for(GaugeShaders::Quality quality:qualities){
+        for(int i=0;i<GaugeShaders::ProgramCount;i++){
+            const GaugeShaders::Program program=GaugeShaders::Program(i);
+            //文字等程序与档位无关，只编译一次
+            if(GaugeShaders::isQualityIndependent(program)&&quality!=qualities.first())
+                continue;
+            //GPU缓动、网格等特化也要预编译，开启后第一次paintGL同样不编译
+            for(GaugeShaders::Variants variants:GaugeShaders::programVariants(program)){
+                const GaugeShaders::ProgramSource source=GaugeShaders::programSource(program,quality,variants);
+                QSharedPointer<QOpenGLShaderProgram> shader_program=GLResourceCache::instance()->program(
+                            source.key,source.vertex.constData(),source.fragment.constData());
+                //失败的程序不在缓存里，也不让它常驻
+                if(!shader_program||!shader_program->isLinked())
+                    continue;
+                //程序对象交给GUI线程使用
+                if(shader_program->thread()==QThread::currentThread())
+                    shader_program->moveToThread(gui_thread);
+                GLResourceCache::instance()->retain(shader_program);
+                count++;
+            }
+        }
+    }
+    //确保其他上下文使用前编译链接已经完成
+    context->functions()->glFinish();
+    programs.storeRelease(count);
+    compileMs.storeRelease(int(timer.elapsed()));
+    context->doneCurrent();
+    context->moveToThread(gui_thread);
+}
+
+void GaugeWarmup::onThreadFinished()
+{
+    if(thread){
+        thread->wait();
+        delete thread;
+        thread=nullptr;
+    }
+    delete context;
+    context=nullptr;
+    if(surface){
+        surface->destroy();
+        delete surface;
+        surface=nullptr;
+    }
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <QObject>
+#include <QAtomicInt>
+
+class QThread;
+class QOpenGLContext;
+class QOffscreenSurface;
+
+//着色器预编译
+//启动时在工作线程上用共享上下文编译链接GaugeShaders中所有程序的所有档位和特化，
+//结果常驻GLResourceCache，同时写入Qt的程序二进制磁盘缓存，
+//控件第一次paintGL时直接命中，不在GUI线程编译
+//需要Qt::AA_ShareOpenGLContexts，程序建在全局共享组里
+class GaugeWarmup : public QObject
+{
+    Q_OBJECT
+public:
+    explicit GaugeWarmup(QObject *parent = nullptr);
+    //等待工作线程结束
+    ~GaugeWarmup();
+
+    //在GUI线程调用，开始后台编译，没有全局共享上下文时返回false
+    bool start();
+    bool isRunning() const;
+    //阻塞等待编译完成
+    void wait();
+
+    //完成后有效：编译的程序数，以及工作线程上的编译耗时，
+    //这部分时间原本会在各控件第一次显示时卡住GUI线程
+    int programCount() const;
+    qint64 elapsedMs() const;
+
+signals:
+    //在GUI线程发出
+    void finished(int programs,qint64 ms);
+
+private:
+    //工作线程：编译所有程序
+    void run();
+    //线程结束后在GUI线程清理上下文
+    void onThreadFinished();
+
+private:
+    QThread *thread{ nullptr };
+    QOpenGLContext *context{ nullptr };
+    QOffscreenSurface *surface{ nullptr };
+    QAtomicInt programs{ 0 };
+    QAtomicInt compileMs{ 0 };
+};
@@ -0,0 +1,203 @@
+#include "GlyphAtlas.h"
+
+#include <QPainter>
+#include <QFontMetricsF>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QVector>
+#include <QtMath>
+
+const QString &GlyphAtlas::characters()
+{
+    static const QString chars=QStringLiteral("0123456789.% -");
+    return chars;
+}
+
+QSharedPointer<const GlyphAtlas> GlyphAtlas::atlas(const QFont &font)
+{
+    static QMutex mutex;
+    static QHash<QString,QSharedPointer<const GlyphAtlas>> atlases;
+
+    //不同字号共用BasePixelSize生成的图集
+    QFont base_font(font);
+    base_font.setPixelSize(BasePixelSize);
+    const QString key=base_font.key();
+
+    QMutexLocker locker(&mutex);
+    QSharedPointer<const GlyphAtlas> glyph_atlas=atlases.value(key);
+    if(!glyph_atlas){
+        glyph_atlas=QSharedPointer<const GlyphAtlas>(new GlyphAtlas(base_font));
+        atlases.insert(key,glyph_atlas);
+    }
+    return glyph_atlas;
+}
+
+QString GlyphAtlas::key() const
+{
+    return atlasKey;
+}
+
+const QImage &GlyphAtlas::image() const
+{
+    return atlasImage;
+}
+
+const GlyphAtlas::Glyph *GlyphAtlas::glyph(QChar ch) const
+{
+    auto iter=glyphs.constFind(ch);
+    return iter==glyphs.constEnd()?nullptr:&iter.value();
+}
+
+qreal GlyphAtlas::lineHeight() const
+{
+    return height;
+}
+
+void GlyphAtlas::layout(const QString &text, const QPointF &center, qreal pixelSize, QVector<float> &vertices) const
+{
+    const qreal scale=pixelSize/BasePixelSize;
+    qreal text_w=0;
+    for(const QChar ch:text){
+        const Glyph *glyph=this->glyph(ch);
+        if(glyph)
+            text_w+=glyph->advance;
+    }
+    //与原QPainter版本一致：水平居中，基线在中心下方半个行高
+    qreal pen_x=center.x()-text_w*scale/2;
+    const qreal baseline=center.y()+height*scale/2;
+    for(const QChar ch:text){
+        const Glyph *glyph=this->glyph(ch);
+        if(!glyph)
+            continue;
+        if(!glyph->uv.isEmpty()){
+            const float x0=float(pen_x+glyph->quad.left()*scale);
+            const float y0=float(baseline+glyph->quad.top()*scale);
+            const float x1=float(pen_x+glyph->quad.right()*scale);
+            const float y1=float(baseline+glyph->quad.bottom()*scale);
+            const float u0=float(glyph->uv.left());
+            const float v0=float(glyph->uv.top());
+            const float u1=float(glyph->uv.right());
+            const float v1=float(glyph->uv.bottom());
+            const float quad[] = {
+                x0, y0, u0, v0,
+                x1, y0, u1, v0,
+                x1, y1, u1, v1,
+
+                x1, y1, u1, v1,
+                x0, y1, u0, v1,
+                x0, y0, u0, v0,
+            };
+            for(float value:quad)
+                vertices.append(value);
+        }
+        pen_x+=glyph->advance*scale;
+    }
+}
+
+GlyphAtlas::GlyphAtlas(const QFont &font)
+{
+    atlasKey=font.key();
+    const QFontMetricsF metrics(font);
+    height=metrics.height();
+
+    //每个字形一个格子，四周外扩Spread，按行排布
+    struct Cell
+    {
+        QChar ch;
+        QRect rect;
+        QRectF bounds;
+    };
+    const int atlas_w=512;
+    QVector<Cell> cells;
+    int cell_x=0;
+    int cell_y=0;
+    int row_h=0;
+    for(const QChar ch:characters()){
+        Glyph &glyph=glyphs[ch];
+#if QT_VERSION >= QT_VERSION_CHECK(5, 11, 0)
+        glyph.advance=metrics.horizontalAdvance(ch);
+#else
+        glyph.advance=metrics.width(ch);
+#endif
+        //bounds相对基线上的笔位置
+        const QRectF bounds=metrics.boundingRect(ch);
+        if(bounds.isEmpty())
+            continue; //空格只有步进
+        const int cell_w=qCeil(bounds.width())+Spread*2;
+        const int cell_h=qCeil(bounds.height())+Spread*2;
+        if(cell_x+cell_w>atlas_w){
+            cell_x=0;
+            cell_y+=row_h;
+            row_h=0;
+        }
+        Cell cell;
+        cell.ch=ch;
+        cell.rect=QRect(cell_x,cell_y,cell_w,cell_h);
+        cell.bounds=bounds;
+        cells.append(cell);
+        cell_x+=cell_w;
+        row_h=qMax(row_h,cell_h);
+    }
+
+    const int atlas_h=qMax(1,cell_y+row_h);
+    atlasImage=QImage(atlas_w,atlas_h,QImage::Format_Grayscale8);
+    atlasImage.fill(0);
+    for(const Cell &cell:cells){
+        //先画出字形覆盖率，再转为距离场
+        QImage coverage(cell.rect.size(),QImage::Format_ARGB32_Premultiplied);
+        coverage.fill(Qt::transparent);
+        QPainter painter(&coverage);
+        painter.setFont(font);
+        painter.setPen(Qt::white);
+        painter.drawText(QPointF(Spread-cell.bounds.left(),Spread-cell.bounds.top()),QString(cell.ch));
+        painter.end();
+        buildDistanceField(coverage,atlasImage,cell.rect.topLeft());
+
+        Glyph &glyph=glyphs[cell.ch];
+        glyph.uv=QRectF(cell.rect.x()/qreal(atlas_w),cell.rect.y()/qreal(atlas_h),
+                        cell.rect.width()/qreal(atlas_w),cell.rect.height()/qreal(atlas_h));
+        glyph.quad=QRectF(cell.bounds.left()-Spread,cell.bounds.top()-Spread,
+                          cell.rect.width(),cell.rect.height());
+    }
+}
+
+void GlyphAtlas::buildDistanceField(const QImage &coverage, QImage &target, const QPoint &offset)
+{
+    const int w=coverage.width();
+    const int h=coverage.height();
+    //alpha过半算字形内部
+    QVector<uchar> inside(w*h);
+    for(int y=0;y<h;y++){
+        const QRgb *line=reinterpret_cast<const QRgb*>(coverage.constScanLine(y));
+        for(int x=0;x<w;x++)
+            inside[y*w+x]=qAlpha(line[x])>=128?1:0;
+    }
+
+    //在Spread范围内找最近的内外交界，只在生成时算一次，直接暴力搜索
+    const int max_d2=Spread*Spread;
+    for(int y=0;y<h;y++){
+        uchar *line=target.scanLine(offset.y()+y)+offset.x();
+        for(int x=0;x<w;x++){
+            const uchar in=inside[y*w+x];
+            int best=max_d2;
+            for(int dy=-Spread;dy<=Spread;dy++){
+                const int yy=y+dy;
+                for(int dx=-Spread;dx<=Spread;dx++){
+                    const int d2=dx*dx+dy*dy;
+                    if(d2>=best)
+                        continue;
+                    const int xx=x+dx;
+                    //格子外都算外部
+                    const uchar other=(xx<0||yy<0||xx>=w||yy>=h)?0:inside[yy*w+xx];
+                    if(other!=in)
+                        best=d2;
+                }
+            }
+            //像素中心到交界约差半个像素
+            const qreal dist=qMax(qreal(0),qSqrt(qreal(best))-qreal(0.5));
+            const qreal signed_dist=in?dist:-dist;
+            const qreal value=qBound(qreal(0),qreal(0.5)+signed_dist/(2*Spread),qreal(1));
+            line[x]=uchar(qRound(value*255));
+        }
+    }
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <QFont>
+#include <QImage>
+#include <QRectF>
+#include <QHash>
+#include <QSharedPointer>
+#include <QVector>
+
+//有向距离场(SDF)字形图集，只包含进度文字需要的字符
+//同一字体在进程内只生成一次，纹理上传由LabelRenderer经GLResourceCache完成
+class GlyphAtlas
+{
+public:
+    //单个字形，尺寸和偏移单位为生成时的像素（BasePixelSize字号）
+    struct Glyph
+    {
+        QRectF uv;       //图集中的纹理坐标[0,1]
+        QRectF quad;     //相对笔位置（基线）的矩形，含距离场外扩
+        qreal advance{ 0 };
+    };
+    //图集包含的字符
+    static const QString &characters();
+    //生成图集时的字号，缩放时距离场保持清晰
+    static constexpr int BasePixelSize = 48;
+    //距离场外扩的像素
+    static constexpr int Spread = 6;
+
+    //取字体对应的图集，同一字体只生成一次
+    static QSharedPointer<const GlyphAtlas> atlas(const QFont &font);
+
+    //图集key，用于纹理缓存
+    QString key() const;
+    //单通道距离场，0.5为字形边缘
+    const QImage &image() const;
+    const Glyph *glyph(QChar ch) const;
+    //BasePixelSize字号下的行高，与QFontMetrics::height对应
+    qreal lineHeight() const;
+    //排版一段文字，水平居中，基线在center下方半个行高
+    //每个字符追加6个顶点x,y,u,v到vertices，坐标单位与center相同，y轴向下
+    void layout(const QString &text,const QPointF &center,qreal pixelSize,QVector<float> &vertices) const;
+
+private:
+    explicit GlyphAtlas(const QFont &font);
+    //由字形覆盖的alpha计算有向距离
+    static void buildDistanceField(const QImage &coverage,QImage &target,const QPoint &offset);
+
+private:
+    QString atlasKey;
+    QImage atlasImage;
+    QHash<QChar,Glyph> glyphs;
+    qreal height{ 0 };
+};
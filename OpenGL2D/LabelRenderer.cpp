@@ -0,0 +1,160 @@
+#include "LabelRenderer.h"
+#include "GlyphAtlas.h"
+#include "GLResourceCache.h"
+#include "GaugeMemory.h"
+#include "GaugeShaders.h"
+
+#include <QFontInfo>
+#include <QVector2D>
+#include <QVector4D>
+
+LabelRenderer::LabelRenderer()
+{
+    setFont(font);
+}
+
+LabelRenderer::~LabelRenderer()
+{
+}
+
+void LabelRenderer::initialize()
+{
+    if(initialized)
+        return;
+    //为当前上下文初始化OpenGL函数解析
+    initializeOpenGLFunctions();
+
+    //着色器代码见GaugeShaders
+    const GaugeShaders::ProgramSource source=
+            GaugeShaders::programSource(GaugeShaders::LabelProgram,GaugeShaders::QualityDefault);
+    shaderProgram=GLResourceCache::instance()->program(
+                source.key,source.vertex.constData(),source.fragment.constData());
+    vao.create();
+    vao.bind();
+    vbo.create();
+    vbo.setUsagePattern(QOpenGLBuffer::DynamicDraw);
+    vbo.bind();
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * 4, nullptr);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * 4,
+                          reinterpret_cast<void*>(sizeof(GLfloat) * 2));
+    vao.release();
+    vbo.release();
+    GaugeMemory::instance()->track(vaoMemory,memoryOwner,GaugeMemory::VertexArray,"label vao",0);
+    GaugeMemory::instance()->track(vboMemory,memoryOwner,GaugeMemory::Buffer,"label vertices",0);
+    uploadedItems.clear();
+    itemsChanged=true;
+    initialized=true;
+}
+
+void LabelRenderer::release()
+{
+    if(!initialized)
+        return;
+    vao.destroy();
+    vbo.destroy();
+    GaugeMemory::instance()->untrack(vaoMemory);
+    GaugeMemory::instance()->untrack(vboMemory);
+    atlasTexture.reset();
+    shaderProgram.reset();
+    initialized=false;
+}
+
+bool LabelRenderer::isInitialized() const
+{
+    return initialized;
+}
+
+void LabelRenderer::setFont(const QFont &font)
+{
+    this->font=font;
+    fontPixelSize=QFontInfo(font).pixelSize();
+    QSharedPointer<const GlyphAtlas> new_atlas=GlyphAtlas::atlas(font);
+    if(new_atlas!=atlas){
+        atlas=new_atlas;
+        //纹理在下次绘制时从缓存取，这里不一定有当前上下文
+        atlasTexture.reset();
+    }
+    uploadedItems.clear();
+    itemsChanged=true;
+}
+
+QFont LabelRenderer::getFont() const
+{
+    return font;
+}
+
+void LabelRenderer::setColor(const QColor &color)
+{
+    this->color=color;
+}
+
+void LabelRenderer::setMemoryOwner(const QObject *owner)
+{
+    memoryOwner=owner;
+}
+
+void LabelRenderer::clear()
+{
+    items.clear();
+    itemsChanged=true;
+}
+
+void LabelRenderer::addText(const QString &text, const QPointF &center, qreal pixelSize)
+{
+    LabelItem item;
+    item.text=text;
+    item.center=center;
+    item.pixelSize=pixelSize>0?pixelSize:fontPixelSize;
+    items.append(item);
+    itemsChanged=true;
+}
+
+void LabelRenderer::render(int width, int height, qreal devicePixelRatio)
+{
+    if(!initialized||items.isEmpty()||width<=0||height<=0)
+        return;
+    if(!atlasTexture)
+        atlasTexture=GLResourceCache::instance()->texture(atlas->key(),atlas->image());
+    //没有重新添加文字时不比较，重新添加了但没变时沿用上次的顶点
+    if(itemsChanged){
+        if(items!=uploadedItems)
+            rebuildVertices();
+        itemsChanged=false;
+    }
+    if(vertexCount<=0)
+        return;
+
+    glViewport(0, 0, width, height);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    shaderProgram->bind();
+    shaderProgram->setUniformValue("aViewSize", QVector2D(width/devicePixelRatio,height/devicePixelRatio));
+    shaderProgram->setUniformValue("aColor", QVector4D(color.redF(),color.greenF(),color.blueF(),color.alphaF()));
+    shaderProgram->setUniformValue("aAtlas", 0);
+    atlasTexture->bind(0);
+    vao.bind();
+
+    glDrawArrays(GL_TRIANGLES, 0, vertexCount);
+
+    vao.release();
+    atlasTexture->release(0);
+    shaderProgram->release();
+}
+
+void LabelRenderer::rebuildVertices()
+{
+    QVector<GLfloat> vertices;
+    for(const LabelItem &item:items)
+        atlas->layout(item.text,item.center,item.pixelSize,vertices);
+
+    vbo.bind();
+    vbo.allocate(vertices.constData(),vertices.size()*int(sizeof(GLfloat)));
+    vbo.release();
+    GaugeMemory::instance()->track(vboMemory,memoryOwner,GaugeMemory::Buffer,"label vertices",
+                                   vertices.size()*qint64(sizeof(GLfloat)));
+    vertexCount=vertices.size()/4;
+    uploadedItems=items;
+}
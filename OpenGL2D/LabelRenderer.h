@@ -0,0 +1,80 @@
+#pragma once
+#include <QOpenGLFunctions_3_3_Core>
+#include <QOpenGLShaderProgram>
+#include <QOpenGLVertexArrayObject>
+#include <QOpenGLBuffer>
+#include <QOpenGLTexture>
+#include <QSharedPointer>
+#include <QVector>
+#include <QColor>
+#include <QFont>
+
+class GlyphAtlas;
+
+//百分比文字的GL绘制，替代每帧的QPainter
+//字形来自缓存的SDF图集，每个字符一个带纹理的矩形，所有文字一次绘制
+//clear/addText后才比较文字，文字不变时不重新生成顶点
+class LabelRenderer : protected QOpenGLFunctions_3_3_Core
+{
+public:
+    LabelRenderer();
+    ~LabelRenderer();
+
+    //在当前上下文初始化，绘制前调用一次
+    void initialize();
+    //释放资源，需要初始化时的上下文为当前
+    void release();
+    bool isInitialized() const;
+
+    //字体，默认QFont("Microsoft YaHei",16)
+    void setFont(const QFont &font);
+    QFont getFont() const;
+    void setColor(const QColor &color);
+    //GaugeMemory中登记的所属对象，默认nullptr，initialize前设置
+    void setMemoryOwner(const QObject *owner);
+
+    //开始新的一批文字，文字不变时不必每帧调用，render沿用上一批
+    void clear();
+    //添加一段文字，center为文字中心，pixelSize为字号像素，<=0时使用字体字号
+    void addText(const QString &text,const QPointF &center,qreal pixelSize=-1);
+    //绘制到当前帧缓冲，width/height为目标像素尺寸
+    //devicePixelRatio为每个坐标单位对应的像素数，center和字号按坐标单位给出
+    void render(int width,int height,qreal devicePixelRatio=1);
+
+private:
+    //一段待绘制的文字
+    struct LabelItem
+    {
+        QString text;
+        QPointF center;
+        qreal pixelSize;
+        bool operator==(const LabelItem &other) const {
+            return text==other.text&&center==other.center&&pixelSize==other.pixelSize;
+        }
+    };
+    void rebuildVertices();
+
+private:
+    //着色器程序，同一共享组内的实例共用
+    QSharedPointer<QOpenGLShaderProgram> shaderProgram;
+    //顶点数组对象
+    QOpenGLVertexArrayObject vao;
+    //每个字符6个顶点，x,y,u,v
+    QOpenGLBuffer vbo{ QOpenGLBuffer::VertexBuffer };
+    //图集纹理，同一共享组内的实例共用
+    QSharedPointer<QOpenGLTexture> atlasTexture;
+    QSharedPointer<const GlyphAtlas> atlas;
+    QFont font{ "Microsoft YaHei", 16 };
+    qreal fontPixelSize{ 0 };
+    QColor color{ Qt::white };
+    QVector<LabelItem> items;
+    QVector<LabelItem> uploadedItems;
+    //clear/addText之后才需要和uploadedItems比较
+    bool itemsChanged{ true };
+    int vertexCount{ 0 };
+    //GaugeMemory的登记
+    const QObject *memoryOwner{ nullptr };
+    int vaoMemory{ -1 };
+    int vboMemory{ -1 };
+    bool initialized{ false };
+};
@@ -1,7 +1,126 @@
 HEADERS += \
     $$PWD/CircleProgressBar.h \
-    $$PWD/WaveProgressBar.h
+    $$PWD/CircleProgressRenderer.h \
+    $$PWD/GaugeAnimator.h \
+    $$PWD/GaugeBackend.h \
+    $$PWD/GaugeCanvas.h \
+    $$PWD/GaugeDataSource.h \
+    $$PWD/GaugeEasing.h \
+    $$PWD/GaugeFrameDriver.h \
+    $$PWD/GaugeMemory.h \
+    $$PWD/GaugeProfiler.h \
+    $$PWD/GaugeRecorder.h \
+    $$PWD/GaugeRenderThread.h \
+    $$PWD/GaugeResolutionScaler.h \
+    $$PWD/GaugeShaders.h \
+    $$PWD/GaugeSimd.h \
+    $$PWD/GaugeSurface.h \
+    $$PWD/GaugeTripleBuffer.h \
+    $$PWD/GaugeValueFeed.h \
+    $$PWD/GaugeWarmup.h \
+    $$PWD/GLCapabilities.h \
+    $$PWD/GLResourceCache.h \
+    $$PWD/GlyphAtlas.h \
+    $$PWD/LabelRenderer.h \
+    $$PWD/ProgressRenderer.h \
+    $$PWD/SharedGaugeMemory.h \
+    $$PWD/SharedMemorySource.h \
+    $$PWD/SoftwareProgressBar.h \
+    $$PWD/SoftwareRasterizer.h \
+    $$PWD/WaveAtlas.h \
+    $$PWD/WaveProgressBar.h \
+    $$PWD/WaveProgressRenderer.h
 
 SOURCES += \
     $$PWD/CircleProgressBar.cpp \
-    $$PWD/WaveProgressBar.cpp
+    $$PWD/CircleProgressRenderer.cpp \
+    $$PWD/GaugeAnimator.cpp \
+    $$PWD/GaugeBackend.cpp \
+    $$PWD/GaugeCanvas.cpp \
+    $$PWD/GaugeEasing.cpp \
+    $$PWD/GaugeFrameDriver.cpp \
+    $$PWD/GaugeMemory.cpp \
+    $$PWD/GaugeProfiler.cpp \
+    $$PWD/GaugeRecorder.cpp \
+    $$PWD/GaugeRenderThread.cpp \
+    $$PWD/GaugeResolutionScaler.cpp \
+    $$PWD/GaugeShaders.cpp \
+    $$PWD/GaugeSurface.cpp \
+    $$PWD/GaugeValueFeed.cpp \
+    $$PWD/GaugeWarmup.cpp \
+    $$PWD/GLCapabilities.cpp \
+    $$PWD/GLResourceCache.cpp \
+    $$PWD/GlyphAtlas.cpp \
+    $$PWD/LabelRenderer.cpp \
+    $$PWD/ProgressRenderer.cpp \
+    $$PWD/SharedGaugeMemory.cpp \
+    $$PWD/SharedMemorySource.cpp \
+    $$PWD/SoftwareProgressBar.cpp \
+    $$PWD/SoftwareRasterizer.cpp \
+    $$PWD/WaveAtlas.cpp \
+    $$PWD/WaveProgressBar.cpp \
+    $$PWD/WaveProgressRenderer.cpp
+
+#环形进度条和进度球的公共计算，GL后端运行时从qrc读取，QRhi后端由qsb在构建时包含
+gauge_glsl.files = $$PWD/shaders/gauge.glsl
+gauge_glsl.base = $$PWD/shaders
+gauge_glsl.prefix = /OpenGL2D/shaders
+RESOURCES += gauge_glsl
+
+#Qt Quick场景图节点，Qt5的OpenGL场景图材质接口
+qtHaveModule(quick):lessThan(QT_MAJOR_VERSION, 6) {
+    QT += quick
+    HEADERS += \
+        $$PWD/GaugeQuickItem.h \
+        $$PWD/GaugeQuickMaterial.h
+    SOURCES += \
+        $$PWD/GaugeQuickItem.cpp \
+        $$PWD/GaugeQuickMaterial.cpp
+}
+
+#Qt6的QOpenGL*类和QOpenGLWidget在单独的模块
+greaterThan(QT_MAJOR_VERSION, 5): QT += opengl openglwidgets
+
+#QRhi后端，Qt6.7起有QRhiWidget；着色器在构建时由qsb编译成.qsb放进资源，运行时不编译GLSL
+#每种画质档位一个片段着色器，只传GAUGE_QUALITY，各档位的开关在shaders/gauge.glsl里展开，与GaugeShaders::header相同
+greaterThan(QT_MAJOR_VERSION, 5):versionAtLeast(QT_VERSION, 6.7.0):qtHaveModule(shadertools) {
+    DEFINES += GAUGE_RHI
+    HEADERS += \
+        $$PWD/GaugeRhiRenderer.h \
+        $$PWD/GaugeRhiWidget.h
+    SOURCES += \
+        $$PWD/GaugeRhiRenderer.cpp \
+        $$PWD/GaugeRhiWidget.cpp
+
+    GAUGE_QSB = $$shell_quote($$shell_path($$[QT_HOST_BINS]/qsb))
+    GAUGE_QSB_TARGETS = --glsl \"100 es,120,150,300 es,330\" --hlsl 50 --msl 12
+    GAUGE_QSB_DIR = $$OUT_PWD/gauge_shaders
+    #不分档位的着色器：顶点着色器和文字
+    GAUGE_PLAIN_SHADERS = $$PWD/shaders/gauge.vert $$PWD/shaders/label.vert $$PWD/shaders/label.frag
+    GAUGE_FRAG_SHADERS = $$PWD/shaders/circle.frag $$PWD/shaders/wave.frag
+
+    gauge_qsb.input = GAUGE_PLAIN_SHADERS
+    gauge_qsb.output = $$GAUGE_QSB_DIR/${QMAKE_FILE_BASE}${QMAKE_FILE_EXT}.qsb
+    gauge_qsb.commands = $$GAUGE_QSB $$GAUGE_QSB_TARGETS -o ${QMAKE_FILE_OUT} ${QMAKE_FILE_NAME}
+    gauge_qsb.CONFIG += no_link target_predeps
+    QMAKE_EXTRA_COMPILERS += gauge_qsb
+    for(shader, GAUGE_PLAIN_SHADERS): GAUGE_QSB_FILES += $$GAUGE_QSB_DIR/$$basename(shader).qsb
+
+    #档位名按GaugeShaders::Quality的顺序，下标即GAUGE_QUALITY
+    gauge_quality = 0
+    for(tier, $$list(high medium low)) {
+        compiler = gauge_qsb_$${tier}
+        $${compiler}.input = GAUGE_FRAG_SHADERS
+        $${compiler}.output = $$GAUGE_QSB_DIR/${QMAKE_FILE_BASE}_$${tier}.frag.qsb
+        $${compiler}.commands = $$GAUGE_QSB $$GAUGE_QSB_TARGETS -DGAUGE_QUALITY=$$gauge_quality -o ${QMAKE_FILE_OUT} ${QMAKE_FILE_NAME}
+        $${compiler}.depends = $$PWD/shaders/gauge.glsl
+        $${compiler}.CONFIG += no_link target_predeps
+        QMAKE_EXTRA_COMPILERS += $$compiler
+        for(gauge, $$list(circle wave)): GAUGE_QSB_FILES += $$GAUGE_QSB_DIR/$${gauge}_$${tier}.frag.qsb
+        gauge_quality = $$num_add($$gauge_quality, 1)
+    }
+    gauge_shaders.files = $$GAUGE_QSB_FILES
+    gauge_shaders.base = $$GAUGE_QSB_DIR
+    gauge_shaders.prefix = /OpenGL2D/shaders
+    RESOURCES += gauge_shaders
+}
@@ -0,0 +1,317 @@
+#include "ProgressRenderer.h"
+#include "GLResourceCache.h"
+#include "GLCapabilities.h"
+#include "GaugeMemory.h"
+
+#include <QElapsedTimer>
+#include <QDebug>
+
+#include <cmath>
+
+ProgressRenderer::ProgressRenderer()
+{
+}
+
+ProgressRenderer::~ProgressRenderer()
+{
+    //GL资源需要在上下文为当前时由release()释放
+    if(initialized)
+        qWarning()<<"ProgressRenderer destroyed without release()";
+}
+
+void ProgressRenderer::initialize()
+{
+    if(initialized)
+        return;
+    //为当前上下文初始化OpenGL函数解析
+    initializeOpenGLFunctions();
+    //用真实上下文核对启动时缓存的驱动信息
+    GLCapabilities::revalidate();
+
+    //着色器程序和矩形顶点从缓存中取，同一共享组内只编译上传一次
+    updateProgram();
+    vbo=GLResourceCache::instance()->quadBuffer();
+    vao.create();
+    vao.bind();
+    vbo->bind();
+
+    // position attribute
+    int attr = -1;
+    attr = shaderProgram->attributeLocation("aPos");
+    //setAttributeBuffer(int location, GLenum type, int offset, int tupleSize, int stride = 0)
+    shaderProgram->setAttributeBuffer(attr, GL_FLOAT, 0, 2, sizeof(GLfloat) * 2);
+    shaderProgram->enableAttributeArray(attr);
+    vao.release();
+    GaugeMemory::instance()->track(vaoMemory,memoryOwner,GaugeMemory::VertexArray,"gauge vao",0);
+    label.initialize();
+    initialized=true;
+}
+
+void ProgressRenderer::release()
+{
+    if(!initialized)
+        return;
+    label.release();
+    vao.destroy();
+    vbo.reset();
+    if(meshVao.isCreated())
+        meshVao.destroy();
+    GaugeMemory::instance()->untrack(vaoMemory);
+    GaugeMemory::instance()->untrack(meshVaoMemory);
+    meshVbo.reset();
+    meshSegmentCount=0;
+    shaderProgram.reset();
+    initialized=false;
+}
+
+bool ProgressRenderer::isInitialized() const
+{
+    return initialized;
+}
+
+void ProgressRenderer::render(int width, int height, float progress, float time)
+{
+    if(!initialized)
+        return;
+    //计时关闭时不读时钟
+    QElapsedTimer timer;
+    if(timingEnabled)
+        timer.start();
+    renderGauge(width,height,progress,time);
+    const qint64 gauge_ns=timingEnabled?timer.nsecsElapsed():0;
+    //GPU缓动时文字用同一公式
+    if(gpuEasing)
+        progress=easing.valueAt(easingNow);
+    renderLabel(width,height,progress);
+    if(timingEnabled)
+        timings.labelNs=timer.nsecsElapsed()-gauge_ns;
+}
+
+void ProgressRenderer::renderGauge(int width, int height, float progress, float time)
+{
+    //以短边为边长，保持比例
+    const int item_w=width>height?height:width;
+    if(!initialized||item_w<=0)
+        return;
+    //计时关闭时不读时钟
+    QElapsedTimer timer;
+    if(timingEnabled)
+        timer.start();
+    glViewport((width-item_w)/2,
+               (height-item_w)/2,
+               item_w,
+               item_w);
+
+    const QColor clear_color=clearColor();
+    glClearColor(clear_color.redF(), clear_color.greenF(), clear_color.blueF(), 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    glEnable(GL_BLEND);
+    //基于源像素Alpha通道值的半透明混合函数
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+    //开启多重采样抗锯齿，貌似没啥效果
+    //glEnable(GL_MULTISAMPLE);
+
+    if(GaugeShaders::resolve(quality)!=programQuality||
+            gpuEasing!=programVariants.testFlag(GaugeShaders::GpuEasingVariant)||
+            meshGeometry!=programVariants.testFlag(GaugeShaders::MeshVariant))
+        updateProgram();
+    shaderProgram->bind();
+    if(gpuEasing){
+        //进度交给着色器计算，时间只传相对开始时间的秒数，float在长时间运行后不会变粗
+        shaderProgram->setUniformValue("aEasing",easing.start,easing.end,0.0f,easing.duration);
+        shaderProgram->setUniformValue("aCurve",GLint(easing.curve));
+        shaderProgram->setUniformValue("aNow",easing.elapsed(easingNow));
+    }else{
+        shaderProgram->setUniformValue("aValue", progress);
+    }
+    //aSmoothWidth用来计算平滑所需宽度，根据不同的大小来计算，这里用3个逻辑像素的宽度
+    //缩得很小时不少于1.5个目标像素，否则边缘出现锯齿
+    const float smooth_width=qMax(3.0f*pixelScale,1.5f)/item_w;
+    shaderProgram->setUniformValue("aSmoothWidth", smooth_width);
+    updateUniforms(shaderProgram.data(),time);
+    QOpenGLVertexArrayObject *draw_vao=&vao;
+    vertexCount=6;
+    if(meshGeometry){
+        const int segments=meshSegments(item_w);
+        if(segments!=meshSegmentCount)
+            updateMesh(segments);
+        //半径各放宽一个像素，外圈按多边形外接放大，边的中点也不会切到圆
+        const float pixel=2.0f/item_w;
+        float inner=0,outer=0;
+        coverage(smooth_width,inner,outer);
+        inner=qMax(0.0f,inner-pixel);
+        outer=(outer+pixel)/float(std::cos(3.14159265/segments));
+        shaderProgram->setUniformValue("aRadii",inner,outer);
+        draw_vao=&meshVao;
+        vertexCount=segments*6;
+    }
+    draw_vao->bind();
+    const qint64 setup_ns=timingEnabled?timer.nsecsElapsed():0;
+
+    glDrawArrays(GL_TRIANGLES, 0, vertexCount);
+
+    draw_vao->release();
+    shaderProgram->release();
+    if(timingEnabled){
+        timings.setupNs=setup_ns;
+        timings.drawNs=timer.nsecsElapsed()-setup_ns;
+        timings.labelNs=0;
+    }
+}
+
+void ProgressRenderer::renderLabel(int width, int height, float progress)
+{
+    if(!initialized||!labelVisible)
+        return;
+    //文字按逻辑像素排版，字号不随设备像素比和缩放变化
+    label.clear();
+    label.addText(QString::number(progress*100,'f',2)+" %",QPointF(width/pixelScale/2.0,height/pixelScale/2.0));
+    label.render(width,height,pixelScale);
+}
+
+void ProgressRenderer::setMemoryOwner(const QObject *owner)
+{
+    memoryOwner=owner;
+    label.setMemoryOwner(owner);
+}
+
+void ProgressRenderer::setPixelScale(float scale)
+{
+    pixelScale=scale>0?scale:1;
+}
+
+float ProgressRenderer::getPixelScale() const
+{
+    return pixelScale;
+}
+
+void ProgressRenderer::setQuality(GaugeShaders::Quality quality)
+{
+    this->quality=quality;
+}
+
+GaugeShaders::Quality ProgressRenderer::getQuality() const
+{
+    return quality;
+}
+
+void ProgressRenderer::setLabelFont(const QFont &font)
+{
+    label.setFont(font);
+}
+
+QFont ProgressRenderer::getLabelFont() const
+{
+    return label.getFont();
+}
+
+void ProgressRenderer::setLabelVisible(bool visible)
+{
+    labelVisible=visible;
+}
+
+bool ProgressRenderer::isLabelVisible() const
+{
+    return labelVisible;
+}
+
+void ProgressRenderer::setGpuEasingEnabled(bool enable)
+{
+    gpuEasing=enable;
+}
+
+bool ProgressRenderer::isGpuEasingEnabled() const
+{
+    return gpuEasing;
+}
+
+void ProgressRenderer::setEasing(const GaugeEasing &easing, double now)
+{
+    this->easing=easing;
+    easingNow=now;
+}
+
+void ProgressRenderer::setMeshGeometryEnabled(bool enable)
+{
+    meshGeometry=enable;
+}
+
+bool ProgressRenderer::isMeshGeometryEnabled() const
+{
+    return meshGeometry;
+}
+
+int ProgressRenderer::lastVertexCount() const
+{
+    return vertexCount;
+}
+
+int ProgressRenderer::meshSegments(int size)
+{
+    //外接多边形比圆多出的宽度R*(1/cos(PI/N)-1)不超过一个像素，取2的幂，尺寸变化时少换网格
+    const double radius=qMax(1.0,size*0.5);
+    const double min_segments=3.14159265/std::acos(radius/(radius+1.0));
+    int segments=16;
+    while(segments<256&&segments<min_segments)
+        segments*=2;
+    return segments;
+}
+
+void ProgressRenderer::setTimingEnabled(bool enable)
+{
+    timingEnabled=enable;
+    timings=Timings();
+}
+
+bool ProgressRenderer::isTimingEnabled() const
+{
+    return timingEnabled;
+}
+
+ProgressRenderer::Timings ProgressRenderer::lastTimings() const
+{
+    return timings;
+}
+
+void ProgressRenderer::updateProgram()
+{
+    programQuality=GaugeShaders::resolve(quality);
+    programVariants=GaugeShaders::NoVariant;
+    if(gpuEasing)
+        programVariants|=GaugeShaders::GpuEasingVariant;
+    if(meshGeometry)
+        programVariants|=GaugeShaders::MeshVariant;
+    const GaugeShaders::ProgramSource source=GaugeShaders::programSource(programType(),programQuality,programVariants);
+    shaderProgram=GLResourceCache::instance()->program(
+                source.key,source.vertex.constData(),source.fragment.constData());
+}
+
+void ProgressRenderer::updateMesh(int segments)
+{
+    meshVbo=GLResourceCache::instance()->ringBuffer(segments);
+    meshSegmentCount=segments;
+    if(!meshVao.isCreated()){
+        meshVao.create();
+        GaugeMemory::instance()->track(meshVaoMemory,memoryOwner,GaugeMemory::VertexArray,"gauge mesh vao",0);
+    }
+    meshVao.bind();
+    meshVbo->bind();
+    //与mesh_vertex_str的aPos对应，位置固定为0
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * 3, nullptr);
+    glEnableVertexAttribArray(0);
+    meshVao.release();
+}
+
+void ProgressRenderer::coverage(float smoothWidth, float &inner, float &outer) const
+{
+    Q_UNUSED(smoothWidth)
+    inner=0;
+    outer=1.41421356f;
+}
+
+void ProgressRenderer::updateUniforms(QOpenGLShaderProgram *program, float time)
+{
+    Q_UNUSED(program)
+    Q_UNUSED(time)
+}
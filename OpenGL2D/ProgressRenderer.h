@@ -0,0 +1,132 @@
+#pragma once
+#include <QOpenGLFunctions_3_3_Core>
+#include <QOpenGLShaderProgram>
+#include <QOpenGLVertexArrayObject>
+#include <QOpenGLBuffer>
+#include <QSharedPointer>
+#include <QColor>
+#include "LabelRenderer.h"
+#include "GaugeShaders.h"
+#include "GaugeEasing.h"
+
+//进度条绘制的公共部分，不依赖QOpenGLWidget
+//窗口、离屏FBO、基准测试共用同一套着色器和绘制流程
+class ProgressRenderer : protected QOpenGLFunctions_3_3_Core
+{
+public:
+    //一次render各阶段的CPU耗时，纳秒
+    struct Timings {
+        qint64 setupNs{ 0 }; //视口、清屏、着色器和uniform
+        qint64 drawNs{ 0 };  //绘制调用
+        qint64 labelNs{ 0 }; //百分比文字
+    };
+
+    ProgressRenderer();
+    virtual ~ProgressRenderer();
+
+    //在当前上下文初始化着色器和顶点，绘制前调用一次
+    void initialize();
+    //释放资源，需要初始化时的上下文为当前
+    void release();
+    bool isInitialized() const;
+
+    //绘制到当前帧缓冲，width/height为目标像素尺寸，以短边为边长居中
+    //progress为归一化的进度[0,1]，time为归一化的动画时间[0,1)
+    //百分比文字在同一趟里用GL绘制
+    void render(int width,int height,float progress,float time=0);
+    //只绘制仪表本体，文字另外绘制时使用（如降分辨率绘制后放大）
+    void renderGauge(int width,int height,float progress,float time=0);
+    //只绘制百分比文字，仪表本体由别处绘制时使用（如WaveAtlas回放）
+    void renderLabel(int width,int height,float progress);
+
+    //每个逻辑像素对应的目标像素数，即设备像素比乘以内部缩放，默认1
+    //抗锯齿宽度和文字大小按逻辑像素计算，换屏幕或缩放时看起来不变
+    void setPixelScale(float scale);
+    float getPixelScale() const;
+
+    //画质档位，默认跟随GaugeShaders的全局设置
+    void setQuality(GaugeShaders::Quality quality);
+    GaugeShaders::Quality getQuality() const;
+
+    //百分比文字的字体和可见性
+    void setLabelFont(const QFont &font);
+    QFont getLabelFont() const;
+    void setLabelVisible(bool visible);
+    bool isLabelVisible() const;
+
+    //GPU缓动，默认关闭
+    //开启后着色器按easing在now时的值绘制，render的progress不再使用，文字按CPU端的同一公式计算
+    void setGpuEasingEnabled(bool enable);
+    bool isGpuEasingEnabled() const;
+    void setEasing(const GaugeEasing &easing,double now);
+
+    //圆环网格，默认关闭，用全窗口矩形
+    //开启后只绘制覆盖仪表可见部分的圆环或圆盘，比抗锯齿边缘略大，透明的角落和环内不再执行片元着色器
+    //分段数按尺寸选择，多边形外接于圆，边缘误差不超过一个像素
+    void setMeshGeometryEnabled(bool enable);
+    bool isMeshGeometryEnabled() const;
+    //上次render中仪表本体的顶点数，不含文字
+    int lastVertexCount() const;
+    //size像素边长下使用的圆环分段数
+    static int meshSegments(int size);
+
+    //GaugeMemory中登记的所属对象，一般为所在控件，默认nullptr，initialize前设置
+    void setMemoryOwner(const QObject *owner);
+
+    //分阶段计时，默认关闭，开启后每次render更新lastTimings
+    void setTimingEnabled(bool enable);
+    bool isTimingEnabled() const;
+    Timings lastTimings() const;
+
+protected:
+    //使用的着色器程序，源码和缓存key见GaugeShaders
+    virtual GaugeShaders::Program programType() const=0;
+    virtual QColor clearColor() const=0;
+    //设置除aValue/aSmoothWidth以外的uniform
+    virtual void updateUniforms(QOpenGLShaderProgram *program,float time);
+    //仪表有颜色的半径范围[inner,outer]，坐标与thePos一致，smoothWidth为抗锯齿宽度
+    //默认整个矩形
+    virtual void coverage(float smoothWidth,float &inner,float &outer) const;
+
+private:
+    //档位变化时从缓存换一个程序，顶点属性位置固定，VAO不用重建
+    void updateProgram();
+    //换一个分段数的圆环网格
+    void updateMesh(int segments);
+
+private:
+    //着色器程序，同一共享组内的实例共用
+    QSharedPointer<QOpenGLShaderProgram> shaderProgram;
+    //顶点数组对象
+    QOpenGLVertexArrayObject vao;
+    //顶点缓冲，同一共享组内的实例共用
+    QSharedPointer<QOpenGLBuffer> vbo;
+    //圆环网格，开启后才创建
+    bool meshGeometry{ false };
+    QOpenGLVertexArrayObject meshVao;
+    QSharedPointer<QOpenGLBuffer> meshVbo;
+    int meshSegmentCount{ 0 };
+    int vertexCount{ 0 };
+    //百分比文字
+    LabelRenderer label;
+    bool labelVisible{ true };
+    //GPU缓动的参数和当前时间
+    bool gpuEasing{ false };
+    //当前程序对应的特化
+    GaugeShaders::Variants programVariants{ GaugeShaders::NoVariant };
+    GaugeEasing easing;
+    double easingNow{ 0 };
+    //每个逻辑像素对应的目标像素数
+    float pixelScale{ 1 };
+    //GaugeMemory的登记
+    const QObject *memoryOwner{ nullptr };
+    int vaoMemory{ -1 };
+    int meshVaoMemory{ -1 };
+    //分阶段计时
+    bool timingEnabled{ false };
+    Timings timings;
+    //设置的档位和当前程序对应的档位
+    GaugeShaders::Quality quality{ GaugeShaders::QualityDefault };
+    GaugeShaders::Quality programQuality{ GaugeShaders::QualityDefault };
+    bool initialized{ false };
+};
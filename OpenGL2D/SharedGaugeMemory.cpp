@@ -0,0 +1,168 @@
+#include "SharedGaugeMemory.h"
+
+#include <cstring>
+#include <new>
+
+//放在共享内存里的原子量必须无锁，否则跨进程不成立；只有32位的序号是原子量，读取只是普通的load
+static_assert(ATOMIC_INT_LOCK_FREE==2,"shared gauge slots need lock-free atomics");
+static_assert(sizeof(std::atomic<quint32>)==sizeof(quint32),"shared gauge sequence must be a plain word");
+
+SharedGaugeMemory::SharedGaugeMemory(const QString &key)
+    : memory(key)
+{
+}
+
+SharedGaugeMemory::~SharedGaugeMemory()
+{
+    detach();
+}
+
+bool SharedGaugeMemory::create(int slotCount)
+{
+    detach();
+    if(slotCount<1){
+        error=QStringLiteral("slot count must be positive");
+        return false;
+    }
+    const int size=int(sizeof(SharedGaugeHeader)+sizeof(SharedGaugeSlot)*slotCount);
+    if(!memory.create(size,QSharedMemory::ReadWrite)){
+        //上次的写入进程异常退出时区域可能还在，沿用它
+        if(memory.error()!=QSharedMemory::AlreadyExists||!memory.attach(QSharedMemory::ReadWrite)){
+            error=memory.errorString();
+            return false;
+        }
+        if(!validate())
+            return false;
+        if(int(header->slotCount)<slotCount){
+            error=QStringLiteral("existing region has %1 slots").arg(header->slotCount);
+            detach();
+            return false;
+        }
+        //写入进程在写到一半时退出会留下奇数序号，补成偶数，否则之后的写入读取端永远读不到
+        for(int i=0;i<slotCount;i++){
+            SharedGaugeSlot *slot=slotAt(i);
+            const quint32 sequence=slot->sequence.load(std::memory_order_relaxed);
+            if(sequence&1)
+                slot->sequence.store(sequence+1,std::memory_order_release);
+        }
+        return true;
+    }
+
+    //新区域：先构造槽再写描述，读取端看到magic时槽已可用
+    char *data=static_cast<char*>(memory.data());
+    std::memset(data,0,size_t(size));
+    SharedGaugeSlot *slots=reinterpret_cast<SharedGaugeSlot*>(data+sizeof(SharedGaugeHeader));
+    for(int i=0;i<slotCount;i++){
+        SharedGaugeSlot *slot=new (slots+i) SharedGaugeSlot;
+        slot->sequence.store(0,std::memory_order_relaxed);
+        slot->valueBits=0;
+        slot->timestampMs=0;
+    }
+    header=reinterpret_cast<SharedGaugeHeader*>(data);
+    header->version=Version;
+    header->slotCount=quint32(slotCount);
+    std::atomic_thread_fence(std::memory_order_release);
+    header->magic=Magic;
+    return true;
+}
+
+bool SharedGaugeMemory::attach()
+{
+    detach();
+    if(!memory.attach(QSharedMemory::ReadOnly)){
+        error=memory.errorString();
+        return false;
+    }
+    return validate();
+}
+
+void SharedGaugeMemory::detach()
+{
+    header=nullptr;
+    if(memory.isAttached())
+        memory.detach();
+}
+
+bool SharedGaugeMemory::isAttached() const
+{
+    return header!=nullptr;
+}
+
+int SharedGaugeMemory::slotCount() const
+{
+    return header?int(header->slotCount):0;
+}
+
+QString SharedGaugeMemory::key() const
+{
+    return memory.key();
+}
+
+QString SharedGaugeMemory::errorString() const
+{
+    return error;
+}
+
+void SharedGaugeMemory::write(int slot, double value, qint64 timestampMs)
+{
+    SharedGaugeSlot *target=slotAt(slot);
+    if(!target)
+        return;
+    quint64 bits=0;
+    std::memcpy(&bits,&value,sizeof(bits));
+    const quint32 sequence=target->sequence.load(std::memory_order_relaxed);
+    target->sequence.store(sequence+1,std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    //每个槽只有一个写入线程，数据按volatile写，编译器不会合并或挪到序号之外
+    *static_cast<volatile quint64*>(&target->valueBits)=bits;
+    *static_cast<volatile qint64*>(&target->timestampMs)=timestampMs;
+    target->sequence.store(sequence+2,std::memory_order_release);
+}
+
+bool SharedGaugeMemory::read(int slot, double &value, qint64 &timestampMs, quint32 &sequence) const
+{
+    const SharedGaugeSlot *source=slotAt(slot);
+    if(!source)
+        return false;
+    //写入只有几条存储指令，冲突时重试几次即可，不自旋等待
+    for(int retry=0;retry<4;retry++)
+    {
+        const quint32 begin=source->sequence.load(std::memory_order_acquire);
+        if(begin&1)
+            continue;
+        //只读映射上不能用读改写指令，数据按volatile普通读取，撕裂时下面的序号检查会发现
+        const quint64 bits=*static_cast<const volatile quint64*>(&source->valueBits);
+        const qint64 stamp=*static_cast<const volatile qint64*>(&source->timestampMs);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if(source->sequence.load(std::memory_order_relaxed)!=begin)
+            continue;
+        std::memcpy(&value,&bits,sizeof(value));
+        timestampMs=stamp;
+        sequence=begin;
+        return true;
+    }
+    return false;
+}
+
+SharedGaugeSlot *SharedGaugeMemory::slotAt(int slot) const
+{
+    if(!header||slot<0||slot>=int(header->slotCount))
+        return nullptr;
+    char *data=reinterpret_cast<char*>(header);
+    return reinterpret_cast<SharedGaugeSlot*>(data+sizeof(SharedGaugeHeader))+slot;
+}
+
+bool SharedGaugeMemory::validate()
+{
+    const SharedGaugeHeader *candidate=static_cast<const SharedGaugeHeader*>(memory.constData());
+    const int size=memory.size();
+    if(size<int(sizeof(SharedGaugeHeader))||candidate->magic!=Magic||candidate->version!=Version
+            ||size<int(sizeof(SharedGaugeHeader)+sizeof(SharedGaugeSlot)*candidate->slotCount)){
+        error=QStringLiteral("shared memory %1 is not a gauge region").arg(memory.key());
+        memory.detach();
+        return false;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    header=const_cast<SharedGaugeHeader*>(candidate);
+    return true;
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <QSharedMemory>
+#include <QString>
+
+#include <atomic>
+
+//共享内存里的一个槽，按缓存行对齐，相邻槽的写入互不干扰
+//sequence为顺序锁：写入前加1变奇数，写完再加1变偶数，读取前后序号相同且为偶数时数据一致
+//数据不用原子量，读取端是只读映射，32位平台的64位原子读取是cmpxchg8b等读改写指令，在只读页上会出错
+//数据在两次读序号之间按volatile拷贝，读到撕裂的值时序号对不上，重试即可；alignas(8)让32位和64位进程布局一致
+struct alignas(64) SharedGaugeSlot
+{
+    std::atomic<quint32> sequence;
+    quint32 reserved;
+    alignas(8) quint64 valueBits;   //double的位模式
+    alignas(8) qint64 timestampMs;  //写入端的时间戳，由写入端决定含义
+};
+
+//区域开头的描述，读取端据此校验
+struct alignas(64) SharedGaugeHeader
+{
+    quint32 magic;
+    quint32 version;
+    quint32 slotCount;
+    quint32 reserved;
+};
+
+//跨进程的进度值共享区域，一个采集进程写，多个界面进程读
+//基于QSharedMemory，布局为SharedGaugeHeader后接slotCount个SharedGaugeSlot
+//映射建立后读写都只是内存访问，不拷贝、不加锁、不做系统调用
+//每个槽只允许一个写入线程，读取端不会写共享内存
+class SharedGaugeMemory
+{
+public:
+    static constexpr quint32 Magic = 0x47415547; //"GAUG"
+    static constexpr quint32 Version = 1;
+
+    explicit SharedGaugeMemory(const QString &key);
+    ~SharedGaugeMemory();
+
+    //写入端创建区域并清零，区域已存在且槽数足够时直接附加
+    bool create(int slotCount);
+    //读取端只读附加，并校验区域描述
+    bool attach();
+    void detach();
+    bool isAttached() const;
+    int slotCount() const;
+    QString key() const;
+    QString errorString() const;
+
+    //写入端写一个值
+    void write(int slot,double value,qint64 timestampMs);
+    //读取端读一致的快照，写入恰好在进行时重试几次，仍不一致返回false
+    //sequence为快照的序号，与上次不同说明有新值
+    bool read(int slot,double &value,qint64 &timestampMs,quint32 &sequence) const;
+
+private:
+    SharedGaugeSlot *slotAt(int slot) const;
+    //附加后校验描述，失败时分离
+    bool validate();
+
+private:
+    QSharedMemory memory;
+    SharedGaugeHeader *header{ nullptr };
+    QString error;
+};
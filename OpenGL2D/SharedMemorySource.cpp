@@ -0,0 +1,48 @@
+#include "SharedMemorySource.h"
+
+SharedMemorySource::SharedMemorySource(const QString &key, int slot)
+    : memory(key),slotIndex(slot)
+{
+    memory.attach();
+    retryTimer.start();
+}
+
+bool SharedMemorySource::sample(double &value)
+{
+    if(!memory.isAttached()){
+        if(retryTimer.elapsed()<1000)
+            return false;
+        retryTimer.restart();
+        if(!memory.attach())
+            return false;
+        hasValue=false;
+    }
+    double current=0;
+    qint64 stamp=0;
+    quint32 sequence=0;
+    //序号0表示槽还没被写过
+    if(!memory.read(slotIndex,current,stamp,sequence)||sequence==0)
+        return false;
+    if(hasValue&&sequence==lastSequence)
+        return false;
+    hasValue=true;
+    lastSequence=sequence;
+    timestampMs=stamp;
+    value=current;
+    return true;
+}
+
+bool SharedMemorySource::isAttached() const
+{
+    return memory.isAttached();
+}
+
+int SharedMemorySource::slot() const
+{
+    return slotIndex;
+}
+
+qint64 SharedMemorySource::lastTimestampMs() const
+{
+    return timestampMs;
+}
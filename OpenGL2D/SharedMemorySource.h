@@ -0,0 +1,28 @@
+#pragma once
+#include "GaugeDataSource.h"
+#include "SharedGaugeMemory.h"
+
+#include <QElapsedTimer>
+
+//从共享内存的一个槽取进度值
+//每帧只读一次槽的序号和值，序号不变时不算新值；写入进程还没启动时每秒重试附加一次
+class SharedMemorySource : public GaugeDataSource
+{
+public:
+    SharedMemorySource(const QString &key,int slot);
+
+    bool sample(double &value) override;
+
+    bool isAttached() const;
+    int slot() const;
+    //最近一次取到的值的写入端时间戳
+    qint64 lastTimestampMs() const;
+
+private:
+    SharedGaugeMemory memory;
+    int slotIndex{ 0 };
+    quint32 lastSequence{ 0 };
+    bool hasValue{ false };
+    qint64 timestampMs{ 0 };
+    QElapsedTimer retryTimer;
+};
@@ -0,0 +1,180 @@
+#include "SoftwareProgressBar.h"
+#include "SoftwareRasterizer.h"
+
+#include <QPainter>
+#include <QFontMetrics>
+
+#include <cmath>
+
+//波浪一个周期的时长，与WaveProgressBar一致
+static const double wave_period_s=5.4;
+
+SoftwareProgressBar::SoftwareProgressBar(GaugeType type, QWidget *parent)
+    : QWidget(parent)
+    , type(type)
+    , labelFont("Microsoft YaHei",16)
+{
+    //图像铺满整个控件，不需要先擦除背景
+    setAttribute(Qt::WA_OpaquePaintEvent);
+
+    animation=new QPropertyAnimation(this,"drawValue");
+    animation->setDuration(2000); //动画持续时间
+    animation->setEasingCurve(QEasingCurve::OutQuart); //先快后慢
+
+    waveTimer=new QTimer(this);
+    waveTimer->setTimerType(Qt::PreciseTimer);
+    connect(waveTimer,&QTimer::timeout,this,[this]{
+        update();
+    });
+    clock.start();
+}
+
+SoftwareProgressBar::~SoftwareProgressBar()
+{
+}
+
+SoftwareProgressBar::GaugeType SoftwareProgressBar::gaugeType() const
+{
+    return type;
+}
+
+void SoftwareProgressBar::setRange(double min, double max)
+{
+    if(max<=min)
+        return;
+    progressMin=min;
+    progressMax=max;
+}
+
+void SoftwareProgressBar::setValue(double value)
+{
+    if(value<progressMin||value>progressMax)
+        return;
+    progressValue=value;
+    //从当前绘制的值继续，动画进行中时只改终点不重新计时
+    GaugeValueFeed::retarget(animation,progressDraw,progressValue);
+}
+
+void SoftwareProgressBar::postValue(double value)
+{
+    //只有上一个值已被取走时才排队刷新，之后的写入直接覆盖
+    if(valueFeed.store(value))
+        QMetaObject::invokeMethod(this,[this]{ update(); },Qt::QueuedConnection);
+}
+
+double SoftwareProgressBar::getDrawValue() const
+{
+    return progressDraw;
+}
+
+void SoftwareProgressBar::setDrawValue(double value)
+{
+    progressDraw=value;
+    update();
+}
+
+void SoftwareProgressBar::setQuality(GaugeShaders::Quality quality)
+{
+    this->quality=quality;
+    update();
+}
+
+GaugeShaders::Quality SoftwareProgressBar::getQuality() const
+{
+    return quality;
+}
+
+void SoftwareProgressBar::setLabelFont(const QFont &font)
+{
+    labelFont=font;
+    update();
+}
+
+QFont SoftwareProgressBar::getLabelFont() const
+{
+    return labelFont;
+}
+
+void SoftwareProgressBar::setTargetFps(int fps)
+{
+    targetFps=qMax(0,fps);
+    updateTimer();
+}
+
+int SoftwareProgressBar::getTargetFps() const
+{
+    return targetFps;
+}
+
+void SoftwareProgressBar::setPowerSave(bool enable)
+{
+    powerSave=enable;
+    updateTimer();
+}
+
+bool SoftwareProgressBar::isPowerSave() const
+{
+    return powerSave;
+}
+
+void SoftwareProgressBar::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event)
+    //取跨线程写入的最新值，一帧只取一次
+    double fed_value=0;
+    if(valueFeed.take(fed_value))
+        setValue(fed_value);
+    //按物理像素绘制，高分屏下不放大
+    const qreal ratio=devicePixelRatioF();
+    const QSize image_size(qRound(width()*ratio),qRound(height()*ratio));
+    if(image.size()!=image_size)
+        image=QImage(image_size,QImage::Format_RGB32);
+    image.setDevicePixelRatio(ratio);
+
+    //把进度[min,max]归一化[0,1]
+    const float progress=(progressDraw-progressMin)/(progressMax-progressMin);
+    if(type==WaveGauge){
+        //时间偏移归一化到一个周期[0,1)
+        const double elapsed_s=clock.nsecsElapsed()/1e9;
+        const float time=float(std::fmod(elapsed_s,wave_period_s)/wave_period_s);
+        const int layers=(GaugeShaders::resolve(quality)==GaugeShaders::QualityLow)?1:2;
+        SoftwareRasterizer::renderWave(image,progress,time,layers,float(ratio));
+    }else{
+        SoftwareRasterizer::renderCircle(image,progress,float(ratio));
+    }
+
+    QPainter painter(this);
+    painter.drawImage(0,0,image);
+    //文字位置与原QPainter版本一致
+    painter.setPen(Qt::white);
+    painter.setFont(labelFont);
+    const QString text_val=QString::number(progress*100,'f',2)+" %";
+    const QFontMetrics metrics=painter.fontMetrics();
+    const int text_x=width()/2-metrics.boundingRect(text_val).width()/2;
+    const int text_y=height()/2+metrics.height()/2;
+    painter.drawText(text_x,text_y,text_val);
+}
+
+void SoftwareProgressBar::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent(event);
+    updateTimer();
+}
+
+void SoftwareProgressBar::hideEvent(QHideEvent *event)
+{
+    QWidget::hideEvent(event);
+    updateTimer();
+}
+
+void SoftwareProgressBar::updateTimer()
+{
+    if(type!=WaveGauge||!isVisible()){
+        waveTimer->stop();
+        return;
+    }
+    int fps=targetFps>0?targetFps:int(DefaultFps);
+    if(powerSave)
+        fps=qMin(fps,int(PowerSaveFps));
+    waveTimer->start(qMax(1,1000/fps));
+}
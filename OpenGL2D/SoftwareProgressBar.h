@@ -0,0 +1,84 @@
+#pragma once
+#include <QWidget>
+#include <QImage>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QPropertyAnimation>
+#include "GaugeShaders.h"
+#include "GaugeValueFeed.h"
+
+//龚建波：不依赖OpenGL的进度条，OpenGL不到3.3时代替CircleProgressBar/WaveProgressBar
+//SoftwareRasterizer在CPU上多线程算出图像，再用QPainter贴到普通QWidget上，接口与GL版本一致
+class SoftwareProgressBar : public QWidget
+{
+    Q_OBJECT
+    Q_PROPERTY(double drawValue READ getDrawValue WRITE setDrawValue)
+public:
+    //绘制的样式，对应两个GL控件
+    enum GaugeType {
+        CircleGauge, //环形进度条
+        WaveGauge    //进度球
+    };
+
+    explicit SoftwareProgressBar(GaugeType type = CircleGauge, QWidget *parent = nullptr);
+    ~SoftwareProgressBar();
+
+    GaugeType gaugeType() const;
+
+    void setRange(double min,double max);
+    void setValue(double value);
+    //可在任意线程调用的setValue，高频写入时每帧只取最新值，不会每次重启动画
+    //调用线程需在控件析构前停止写入
+    void postValue(double value);
+
+    double getDrawValue() const;
+    void setDrawValue(double value);
+
+    //画质档位，只影响波浪层数，Low时一层
+    void setQuality(GaugeShaders::Quality quality);
+    GaugeShaders::Quality getQuality() const;
+
+    //百分比文字的字体，默认QFont("Microsoft YaHei",16)
+    void setLabelFont(const QFont &font);
+    QFont getLabelFont() const;
+
+    //波浪动画的目标帧率，0表示DefaultFps
+    void setTargetFps(int fps);
+    int getTargetFps() const;
+    //省电模式，帧率不超过PowerSaveFps
+    void setPowerSave(bool enable);
+    bool isPowerSave() const;
+    static constexpr int DefaultFps = 60;
+    static constexpr int PowerSaveFps = 15;
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    //隐藏和最小化时停止波浪动画
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+
+private:
+    //按帧率和可见性启停波浪定时器
+    void updateTimer();
+
+private:
+    GaugeType type;
+    //CPU绘制的图像，尺寸为控件的物理像素
+    QImage image;
+    //属性动画
+    QPropertyAnimation *animation{ nullptr };
+    //跨线程写入的最新值
+    GaugeValueFeed valueFeed;
+    //波浪动画，定时刷新，时间取单调时钟
+    QTimer *waveTimer{ nullptr };
+    QElapsedTimer clock;
+    int targetFps{ 0 };
+    bool powerSave{ false };
+    GaugeShaders::Quality quality{ GaugeShaders::QualityDefault };
+    QFont labelFont;
+    //进度值
+    double progressMin{ 0 };
+    double progressMax{ 100 };
+    double progressValue{ 0 }; //设置的值
+    double progressDraw{ 0 }; //绘制临时值
+};
@@ -0,0 +1,227 @@
+#include "SoftwareRasterizer.h"
+
+#include <QThreadPool>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QVector>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+
+#include "GaugeSimd.h"
+
+namespace {
+
+using namespace GaugeSimd;
+
+const float PI=3.14159265f;
+
+//GLSL的smoothstep，edge可以反向，scale为1/(edge1-edge0)
+inline FloatN smoothstep(FloatN edge0,float scale,FloatN x)
+{
+    const FloatN t=vmin(vmax((x-edge0)*FloatN(scale),FloatN(0.0f)),FloatN(1.0f));
+    return t*t*(FloatN(3.0f)-FloatN(2.0f)*t);
+}
+
+//与shaders/gauge.glsl中FAST_MATH的myatan2相同，0-360度归一化到[0,1]
+inline FloatN atan2n(FloatN y,FloatN x)
+{
+    const FloatN ax=vabs(x);
+    const FloatN ay=vabs(y);
+    const FloatN a=vmin(ax,ay)/vmax(vmax(ax,ay),FloatN(1e-8f));
+    const FloatN s=a*a;
+    FloatN r=((FloatN(-0.0464964749f)*s+FloatN(0.15931422f))*s-FloatN(0.327622764f))*s*a+a;
+    r=select(ay>=ax,FloatN(PI*0.5f)-r,r);
+    r=select(x<FloatN(0.0f),FloatN(PI)-r,r);
+    r=select(y<FloatN(0.0f),FloatN(2.0f*PI)-r,r);
+    return r*FloatN(0.5f/PI);
+}
+
+//线程池中处理一段行
+class RowTask : public QRunnable
+{
+public:
+    RowTask(const std::function<void(int,int)> &func,int begin,int end,QSemaphore *done)
+        : func(func),begin(begin),end(end),done(done) {}
+    void run() override {
+        func(begin,end);
+        done->release();
+    }
+private:
+    const std::function<void(int,int)> &func;
+    int begin;
+    int end;
+    QSemaphore *done;
+};
+
+//把[0,rows)分块并行，当前线程也处理一块，返回时全部完成
+//不要在全局线程池的任务里调用，否则可能等不到空闲线程
+void parallelRows(int rows,const std::function<void(int,int)> &func)
+{
+    QThreadPool *pool=QThreadPool::globalInstance();
+    //每块至少32行，太小的图不值得分线程
+    const int chunks=qBound(1,rows/32,qMax(1,pool->maxThreadCount()));
+    QSemaphore done;
+    for(int i=1;i<chunks;i++)
+        pool->start(new RowTask(func,rows*i/chunks,rows*(i+1)/chunks,&done));
+    func(0,rows/chunks);
+    done.acquire(chunks-1);
+}
+
+//逐行光栅化，与glViewport一样以短边为边长居中
+//shadeRow(y,dst,count)算出正方形内一行的count个像素，y为该行在[-1,1]中的坐标
+//返回false表示整行都是底色
+template<typename ShadeRow>
+void rasterize(QImage &image,quint32 background,const ShadeRow &shadeRow)
+{
+    if(image.format()!=QImage::Format_RGB32){
+        const qreal ratio=image.devicePixelRatio();
+        image=QImage(image.size(),QImage::Format_RGB32);
+        image.setDevicePixelRatio(ratio);
+    }
+    const int width=image.width();
+    const int height=image.height();
+    const int side=qMin(width,height);
+    if(side<=0)
+        return;
+    const int left=(width-side)/2;
+    //GL视口的y从下往上，图像的行从上往下
+    const int top=height-side-(height-side)/2;
+    //先取bits让图像在当前线程detach，工作线程只写像素
+    uchar *bits=image.bits();
+    const int stride=image.bytesPerLine();
+    parallelRows(height,[&](int begin,int end){
+        //按SIMD宽度补齐的行缓冲，不用单独处理行尾
+        QVector<quint32> buffer(side+FloatN::Size);
+        for(int row=begin;row<end;row++){
+            quint32 *line=reinterpret_cast<quint32*>(bits+row*stride);
+            const int py=row-top;
+            if(py<0||py>=side){
+                std::fill(line,line+width,background);
+                continue;
+            }
+            std::fill(line,line+left,background);
+            std::fill(line+left+side,line+width,background);
+            const float y=1.0f-(py+0.5f)*2.0f/side;
+            if(shadeRow(y,buffer.data(),side))
+                std::memcpy(line+left,buffer.constData(),size_t(side)*sizeof(quint32));
+            else
+                std::fill(line+left,line+left+side,background);
+        }
+    });
+}
+
+}
+
+QString SoftwareRasterizer::instructionSet()
+{
+#if defined(GAUGE_SIMD_AVX2)
+    return QStringLiteral("AVX2");
+#elif defined(GAUGE_SIMD_SSE2)
+    return QStringLiteral("SSE2");
+#else
+    return QStringLiteral("Scalar");
+#endif
+}
+
+int SoftwareRasterizer::laneCount()
+{
+    return FloatN::Size;
+}
+
+void SoftwareRasterizer::renderCircle(QImage &image, float progress, float pixelScale)
+{
+    const int side=qMin(image.width(),image.height());
+    if(side<=0)
+        return;
+    //与着色器一致：3个逻辑像素的平滑宽度，不少于1.5个image像素，背景为清屏色(0.1,0.2,0.3)
+    const float smooth_width=qMax(3.0f*pixelScale,1.5f)/side;
+    const float dx=2.0f/side;
+    const bool has_value=progress>0.0f;
+    const quint32 background=qRgb(26,51,76);
+    rasterize(image,background,[&](float y,quint32 *dst,int count){
+        //圆环外径0.9，整行都在外面时只有底色
+        if(std::abs(y)>0.9f+smooth_width)
+            return false;
+        const FloatN vy(y);
+        const FloatN step_x(dx*FloatN::Size);
+        FloatN vx=FloatN(-1.0f+dx*0.5f)+FloatN::ramp()*FloatN(dx);
+        for(int i=0;i<count;i+=FloatN::Size){
+            const FloatN len=vsqrt(vx*vx+vy*vy);
+            const FloatN alpha=smoothstep(FloatN(0.15f+smooth_width),-1.0f/smooth_width,vabs(len-FloatN(0.75f)));
+            const FloatN angle=atan2n(vy,vx);
+            //进度色的权重，即BRANCHLESS版本的k
+            FloatN k(0.0f);
+            if(has_value)
+                k=smoothstep(FloatN(progress+smooth_width/3.0f),-3.0f/smooth_width,angle);
+            //mix((0.4,0.1,0.6),(1.0,0.1,1.0-angle),k)，再按GL_SRC_ALPHA,GL_ONE叠加到清屏色上
+            const FloatN r=FloatN(0.1f)+(FloatN(0.4f)+FloatN(0.6f)*k)*alpha;
+            const FloatN g=FloatN(0.2f)+FloatN(0.1f)*alpha;
+            const FloatN b=FloatN(0.3f)+(FloatN(0.6f)+(FloatN(0.4f)-angle)*k)*alpha;
+            storePixels(dst+i,r,g,b);
+            vx=vx+step_x;
+        }
+        return true;
+    });
+}
+
+void SoftwareRasterizer::renderWave(QImage &image, float progress, float time, int waveLayers, float pixelScale)
+{
+    const int side=qMin(image.width(),image.height());
+    if(side<=0)
+        return;
+    const float smooth_width=qMax(3.0f*pixelScale,1.5f)/side;
+    const float dx=2.0f/side;
+    //波浪的sin只和列有关，每帧按列算好，行内直接读取
+    //[wave2]前面一层yTop2的偏移，[wave1]后面一层yTop1的偏移
+    QVector<float> wave2(side+FloatN::Size,0.0f);
+    QVector<float> wave1(side+FloatN::Size,0.0f);
+    for(int i=0;i<side;i++){
+        const float x=-1.0f+(i+0.5f)*dx;
+        wave2[i]=0.03f*std::sin(time*10*PI+x*10);
+        wave1[i]=0.03f*std::sin(-time*10*PI+x*10)-0.02f;
+    }
+    const float *wave2_data=wave2.constData();
+    const float *wave1_data=wave1.constData();
+    const bool two_layers=waveLayers>1;
+    rasterize(image,qRgb(0,0,0),[&](float y,quint32 *dst,int count){
+        //外环外径0.8，整行都在外面时只有底色
+        if(std::abs(y)>0.8f+smooth_width)
+            return false;
+        const FloatN vy(y);
+        const FloatN value(progress);
+        const FloatN pos_y((y+0.6f)/1.2f);
+        const FloatN step_x(dx*FloatN::Size);
+        FloatN vx=FloatN(-1.0f+dx*0.5f)+FloatN::ramp()*FloatN(dx);
+        for(int i=0;i<count;i+=FloatN::Size){
+            const FloatN len=vsqrt(vx*vx+vy*vy);
+            //内圆和波浪
+            const FloatN alpha=smoothstep(FloatN(0.6f+smooth_width),-1.0f/smooth_width,len);
+            const FloatN y_smooth2=smoothstep(pos_y+FloatN::load(wave2_data+i),1.0f/smooth_width,value);
+            FloatN g_inner;
+            if(two_layers){
+                const FloatN y_smooth1=smoothstep(pos_y+FloatN::load(wave1_data+i),1.0f/smooth_width,value);
+                const FloatN front=(y_smooth1>FloatN(0.0f))&(y_smooth2<FloatN(0.8f));
+                g_inner=FloatN(0.2f)+select(front,FloatN(0.4f)*y_smooth1+FloatN(0.2f)*y_smooth2,FloatN(0.6f)*y_smooth2);
+            }else{
+                g_inner=FloatN(0.2f)+FloatN(0.6f)*y_smooth2;
+            }
+            //外环和旋转的高亮段
+            const FloatN ring=smoothstep(FloatN(0.05f+smooth_width),-1.0f/smooth_width,vabs(len-FloatN(0.75f)));
+            FloatN angle_diff=vabs(atan2n(vy,vx)-FloatN(time));
+            angle_diff=select(angle_diff>FloatN(0.5f),FloatN(1.0f)-angle_diff,angle_diff);
+            const FloatN g_smooth=smoothstep(FloatN(0.0f),2.0f/smooth_width,vabs(angle_diff-FloatN(0.25f)));
+            const FloatN g_outer=select(angle_diff<=FloatN(0.25f),FloatN(0.2f)+FloatN(0.4f)*g_smooth,FloatN(0.2f));
+
+            const FloatN outer=alpha<=FloatN(0.0f);
+            const FloatN a=select(outer,ring,alpha);
+            const FloatN g=select(outer,g_outer,g_inner);
+            //按GL_SRC_ALPHA,GL_ONE叠加到黑色上
+            storePixels(dst+i,value*a,g*a,a);
+            vx=vx+step_x;
+        }
+        return true;
+    });
+}
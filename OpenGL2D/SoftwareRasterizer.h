@@ -0,0 +1,26 @@
+#pragma once
+#include <QImage>
+#include <QString>
+
+//CPU光栅化，OpenGL不到3.3时代替着色器
+//与GaugeShaders相同的圆环、渐变、波浪公式，按SIMD宽度一次算多个像素
+//  AVX2   编译时开启(-mavx2或/arch:AVX2)，一次8个
+//  SSE2   x86/x64默认，一次4个
+//  Scalar 其他平台，一次1个
+//行按全局线程池分块并行，结果写入Format_RGB32的QImage
+class SoftwareRasterizer
+{
+public:
+    //编译启用的指令集名称
+    static QString instructionSet();
+    //一次同时计算的像素数
+    static int laneCount();
+
+    //绘制到image，以短边为边长居中，其余部分填充底色
+    //image格式不是RGB32时按原尺寸重新分配
+    //progress为归一化的进度[0,1]
+    //pixelScale为每个逻辑像素对应的image像素数，平滑宽度与GL控件一致，见ProgressRenderer::setPixelScale
+    static void renderCircle(QImage &image,float progress,float pixelScale=1);
+    //time为归一化的动画时间[0,1)，waveLayers为波浪层数，对应着色器的WAVE_LAYERS
+    static void renderWave(QImage &image,float progress,float time,int waveLayers=2,float pixelScale=1);
+};
@@ -0,0 +1,337 @@
+#include "WaveAtlas.h"
+#include "WaveProgressRenderer.h"
+#include "GLResourceCache.h"
+#include "GaugeMemory.h"
+
+#include <QThread>
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
+#include <QOffscreenSurface>
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+#include <QOpenGLVersionFunctionsFactory>
+#endif
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QDebug>
+
+#include <cmath>
+
+WaveAtlas::WaveAtlas(QObject *parent)
+    : QObject(parent)
+{
+}
+
+WaveAtlas::~WaveAtlas()
+{
+    abortBake.storeRelease(1);
+    if(thread){
+        thread->wait();
+        delete thread;
+    }
+    deleteBaked(GLuint(bakedTexture.fetchAndStoreOrdered(0)));
+    delete context;
+    if(surface){
+        surface->destroy();
+        delete surface;
+    }
+    if(initialized||texture||!retired.isEmpty())
+        qWarning()<<"WaveAtlas destroyed without release()";
+}
+
+void WaveAtlas::setBudget(qint64 bytes)
+{
+    budget=qMax<qint64>(0,bytes);
+}
+
+qint64 WaveAtlas::getBudget() const
+{
+    return budget;
+}
+
+qint64 WaveAtlas::memoryBytes() const
+{
+    return texture?qint64(readyKey.size)*readyKey.size*4*frames:0;
+}
+
+int WaveAtlas::frameCount() const
+{
+    return texture?frames:0;
+}
+
+void WaveAtlas::initialize()
+{
+    if(initialized)
+        return;
+    initializeOpenGLFunctions();
+    const GaugeShaders::ProgramSource source=
+            GaugeShaders::programSource(GaugeShaders::AtlasProgram,GaugeShaders::QualityDefault);
+    shaderProgram=GLResourceCache::instance()->program(
+                source.key,source.vertex.constData(),source.fragment.constData());
+    vbo=GLResourceCache::instance()->quadBuffer();
+    vao.create();
+    vao.bind();
+    vbo->bind();
+    const int attr=shaderProgram->attributeLocation("aPos");
+    shaderProgram->setAttributeBuffer(attr, GL_FLOAT, 0, 2, sizeof(GLfloat) * 2);
+    shaderProgram->enableAttributeArray(attr);
+    vao.release();
+    GaugeMemory::instance()->track(vaoMemory,parent(),GaugeMemory::VertexArray,"wave atlas vao",0);
+    initialized=true;
+}
+
+void WaveAtlas::release()
+{
+    //烘焙中的结果回来时控件已经不在，直接丢弃
+    abortBake.storeRelease(1);
+    hasPending=false;
+    if(texture)
+        retired.append(texture);
+    texture=0;
+    frames=0;
+    readyKey=BakeKey();
+    GaugeMemory::instance()->untrack(textureMemory);
+    GaugeMemory::instance()->untrack(vaoMemory);
+    if(!initialized)
+        return;
+    deleteRetired();
+    vao.destroy();
+    vbo.reset();
+    shaderProgram.reset();
+    initialized=false;
+}
+
+void WaveAtlas::request(int size, float progress, GaugeShaders::Quality quality, float pixelScale)
+{
+    BakeKey key;
+    key.size=size;
+    key.progress=progress;
+    key.quality=GaugeShaders::resolve(quality);
+    key.pixelScale=pixelScale;
+    if(key==readyKey||framesFor(size)==0)
+        return;
+    if(thread){
+        //正在烘焙别的参数时中止它，完成后换成最新的
+        if(key!=bakingKey){
+            abortBake.storeRelease(1);
+            pendingKey=key;
+            hasPending=true;
+        }
+        return;
+    }
+    pendingKey=key;
+    hasPending=true;
+    startBake();
+}
+
+bool WaveAtlas::isReady(int size, float progress, GaugeShaders::Quality quality, float pixelScale) const
+{
+    BakeKey key;
+    key.size=size;
+    key.progress=progress;
+    key.quality=GaugeShaders::resolve(quality);
+    key.pixelScale=pixelScale;
+    return texture&&key==readyKey;
+}
+
+void WaveAtlas::draw(int width, int height, float time)
+{
+    const int item_w=width>height?height:width;
+    if(!initialized||!texture||item_w<=0)
+        return;
+    deleteRetired();
+    glViewport((width-item_w)/2,
+               (height-item_w)/2,
+               item_w,
+               item_w);
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    //烘焙时已经混合好，直接覆盖
+    glDisable(GL_BLEND);
+
+    const int layer=qBound(0,int(time*frames),frames-1);
+    shaderProgram->bind();
+    shaderProgram->setUniformValue("aFrames", 0);
+    shaderProgram->setUniformValue("aLayer", float(layer));
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+    vao.bind();
+    glDrawArrays(GL_TRIANGLES, 0, 6);
+    vao.release();
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    shaderProgram->release();
+}
+
+int WaveAtlas::framesFor(int size) const
+{
+    if(size<=0)
+        return 0;
+    const qint64 frame_bytes=qint64(size)*size*4;
+    const int count=int(qMin<qint64>(MaxFrames,budget/frame_bytes));
+    return count>=MinFrames?count:0;
+}
+
+void WaveAtlas::startBake()
+{
+    if(thread||!hasPending)
+        return;
+    QOpenGLContext *share_context=QOpenGLContext::globalShareContext();
+    if(!share_context){
+        qWarning()<<"WaveAtlas: Qt::AA_ShareOpenGLContexts is not set";
+        hasPending=false;
+        return;
+    }
+    //QOffscreenSurface需要在GUI线程创建，上下文和表面在多次烘焙间复用
+    if(!surface){
+        surface=new QOffscreenSurface;
+        surface->setFormat(share_context->format());
+        surface->create();
+    }
+    if(!context){
+        context=new QOpenGLContext;
+        context->setFormat(share_context->format());
+        context->setShareContext(share_context);
+        if(!context->create()){
+            qWarning()<<"WaveAtlas: failed to create shared context";
+            delete context;
+            context=nullptr;
+            hasPending=false;
+            return;
+        }
+    }
+
+    const BakeKey key=pendingKey;
+    const int count=framesFor(key.size);
+    hasPending=false;
+    bakingKey=key;
+    abortBake.storeRelease(0);
+    QThread *gui_thread=QThread::currentThread();
+    thread=QThread::create([this,key,count,gui_thread]{
+        QElapsedTimer timer;
+        timer.start();
+        bakedTexture.storeRelease(int(bake(key,count)));
+        context->moveToThread(gui_thread);
+        const qint64 ms=timer.elapsed();
+        QMetaObject::invokeMethod(this,[this,key,count,ms]{
+            onBaked(key,count,ms);
+        },Qt::QueuedConnection);
+    });
+    context->moveToThread(thread);
+    thread->start();
+}
+
+GLuint WaveAtlas::bake(const BakeKey &key, int count)
+{
+    if(!context->makeCurrent(surface)){
+        qWarning()<<"WaveAtlas: makeCurrent failed";
+        return 0;
+    }
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    QOpenGLFunctions_3_3_Core *gl=QOpenGLVersionFunctionsFactory::get<QOpenGLFunctions_3_3_Core>(context);
+#else
+    QOpenGLFunctions_3_3_Core *gl=context->versionFunctions<QOpenGLFunctions_3_3_Core>();
+#endif
+    if(!gl||!gl->initializeOpenGLFunctions()){
+        context->doneCurrent();
+        return 0;
+    }
+
+    GLuint baked_texture=0;
+    gl->glGenTextures(1,&baked_texture);
+    gl->glBindTexture(GL_TEXTURE_2D_ARRAY,baked_texture);
+    gl->glTexImage3D(GL_TEXTURE_2D_ARRAY,0,GL_RGBA8,key.size,key.size,count,0,GL_RGBA,GL_UNSIGNED_BYTE,nullptr);
+    gl->glTexParameteri(GL_TEXTURE_2D_ARRAY,GL_TEXTURE_MIN_FILTER,GL_LINEAR);
+    gl->glTexParameteri(GL_TEXTURE_2D_ARRAY,GL_TEXTURE_MAG_FILTER,GL_LINEAR);
+    gl->glTexParameteri(GL_TEXTURE_2D_ARRAY,GL_TEXTURE_WRAP_S,GL_CLAMP_TO_EDGE);
+    gl->glTexParameteri(GL_TEXTURE_2D_ARRAY,GL_TEXTURE_WRAP_T,GL_CLAMP_TO_EDGE);
+    gl->glBindTexture(GL_TEXTURE_2D_ARRAY,0);
+
+    GLuint fbo=0;
+    gl->glGenFramebuffers(1,&fbo);
+    gl->glBindFramebuffer(GL_FRAMEBUFFER,fbo);
+
+    //与实时绘制同一个渲染器和着色器，文字仍然实时绘制
+    //程序对象与GUI线程分开，烘焙时设置的uniform不影响同时在绘制的控件
+    GLResourceCache::setThreadPrivatePrograms(true);
+    WaveProgressRenderer renderer;
+    renderer.setQuality(GaugeShaders::Quality(key.quality));
+    renderer.setLabelVisible(false);
+    renderer.setPixelScale(key.pixelScale);
+    renderer.initialize();
+    bool complete=true;
+    for(int i=0;i<count;i++){
+        if(abortBake.loadAcquire()){
+            complete=false;
+            break;
+        }
+        gl->glFramebufferTextureLayer(GL_FRAMEBUFFER,GL_COLOR_ATTACHMENT0,baked_texture,0,i);
+        renderer.render(key.size,key.size,key.progress,float(i)/count);
+    }
+    renderer.release();
+    gl->glBindFramebuffer(GL_FRAMEBUFFER,0);
+    gl->glDeleteFramebuffers(1,&fbo);
+    if(!complete){
+        gl->glDeleteTextures(1,&baked_texture);
+        baked_texture=0;
+    }
+    //其他上下文使用前确保绘制已经完成
+    gl->glFinish();
+    //等待期间release()或析构要求中止时在这里删掉，不交出没人接收的纹理
+    if(baked_texture&&abortBake.loadAcquire()){
+        gl->glDeleteTextures(1,&baked_texture);
+        baked_texture=0;
+    }
+    context->doneCurrent();
+    return baked_texture;
+}
+
+void WaveAtlas::onBaked(const BakeKey &key, int count, qint64 ms)
+{
+    if(thread){
+        thread->wait();
+        delete thread;
+        thread=nullptr;
+    }
+    bakingKey=BakeKey();
+    const GLuint baked_texture=GLuint(bakedTexture.fetchAndStoreOrdered(0));
+    if(baked_texture){
+        if(!initialized){
+            //控件已经释放，没有控件的上下文可以删除retired，直接用烘焙的上下文删掉
+            deleteBaked(baked_texture);
+        }else if(hasPending&&pendingKey!=key){
+            //期间参数又变了
+            retired.append(baked_texture);
+        }else{
+            if(texture)
+                retired.append(texture);
+            texture=baked_texture;
+            readyKey=key;
+            frames=count;
+            GaugeMemory::instance()->track(textureMemory,parent(),GaugeMemory::Texture,
+                                           QString("wave atlas %1x%1 x%2").arg(key.size).arg(count),memoryBytes());
+            emit baked(key.size,count,memoryBytes(),ms);
+        }
+    }
+    if(hasPending&&initialized)
+        startBake();
+}
+
+void WaveAtlas::deleteBaked(GLuint baked_texture)
+{
+    if(!baked_texture||!context||!surface)
+        return;
+    //纹理在共享组内，用哪个上下文删除都可以
+    if(!context->makeCurrent(surface)){
+        qWarning()<<"WaveAtlas: makeCurrent failed, baked texture leaked";
+        return;
+    }
+    context->functions()->glDeleteTextures(1,&baked_texture);
+    context->doneCurrent();
+}
+
+void WaveAtlas::deleteRetired()
+{
+    if(retired.isEmpty())
+        return;
+    glDeleteTextures(retired.size(),retired.constData());
+    retired.clear();
+}
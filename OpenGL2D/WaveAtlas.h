@@ -0,0 +1,110 @@
+#pragma once
+#include <QObject>
+#include <QOpenGLFunctions_3_3_Core>
+#include <QOpenGLShaderProgram>
+#include <QOpenGLVertexArrayObject>
+#include <QOpenGLBuffer>
+#include <QSharedPointer>
+#include <QAtomicInt>
+#include <QVector>
+#include "GaugeShaders.h"
+
+class QThread;
+class QOpenGLContext;
+class QOffscreenSurface;
+
+//进度球的预烘焙帧
+//波浪的画面只取决于进度、时间和尺寸，进度不变时把一个周期预先画进纹理数组，
+//之后每帧只按时间取一层贴图，不再逐像素算三角函数
+//烘焙在工作线程的共享上下文里进行，完成前继续实时绘制；进度变化后等动画停下再重新烘焙
+//帧数受显存预算限制，最多180帧（与原来30ms一步、一周期180步一致），预算放不下MinFrames帧时不烘焙
+//需要Qt::AA_ShareOpenGLContexts
+class WaveAtlas : public QObject, protected QOpenGLFunctions_3_3_Core
+{
+    Q_OBJECT
+public:
+    static constexpr int MaxFrames = 180;
+    static constexpr int MinFrames = 24;
+
+    explicit WaveAtlas(QObject *parent = nullptr);
+    //等待烘焙线程结束，纹理需要之前在上下文为当前时release()
+    ~WaveAtlas();
+
+    //显存预算，字节，默认32MB
+    void setBudget(qint64 bytes);
+    qint64 getBudget() const;
+    //当前烘焙结果占用的显存和帧数，没有时为0
+    qint64 memoryBytes() const;
+    int frameCount() const;
+
+    //在控件的上下文初始化回放用的着色器和顶点
+    void initialize();
+    //释放纹理和回放资源，需要控件的上下文为当前
+    void release();
+
+    //size为仪表的像素边长，progress为归一化进度，pixelScale见ProgressRenderer::setPixelScale
+    //与已有或正在烘焙的参数不同时在后台重新烘焙，在GUI线程调用
+    void request(int size,float progress,GaugeShaders::Quality quality,float pixelScale=1);
+    //已有与参数一致的烘焙结果
+    bool isReady(int size,float progress,GaugeShaders::Quality quality,float pixelScale=1) const;
+    //按time取一帧绘制到当前帧缓冲，width/height为目标像素尺寸，视口与ProgressRenderer一致，不含文字
+    void draw(int width,int height,float time);
+
+signals:
+    //一次烘焙完成，在GUI线程发出
+    void baked(int size,int frames,qint64 bytes,qint64 ms);
+
+private:
+    //一组烘焙参数
+    struct BakeKey
+    {
+        int size{ 0 };
+        float progress{ -1 };
+        int quality{ -1 };
+        float pixelScale{ 1 };
+        bool operator==(const BakeKey &other) const {
+            return size==other.size&&progress==other.progress&&quality==other.quality
+                    &&pixelScale==other.pixelScale;
+        }
+        bool operator!=(const BakeKey &other) const { return !(*this==other); }
+    };
+    //预算内的帧数，放不下MinFrames帧时返回0
+    int framesFor(int size) const;
+    void startBake();
+    //工作线程：烘焙到新纹理，返回纹理名，中止或失败时返回0
+    GLuint bake(const BakeKey &key,int frames);
+    //GUI线程：收下烘焙结果
+    void onBaked(const BakeKey &key,int frames,qint64 ms);
+    //用烘焙的共享上下文删除没有收下的纹理，工作线程已结束时在GUI线程调用
+    void deleteBaked(GLuint texture);
+    //删除已替换的纹理，需要控件的上下文为当前
+    void deleteRetired();
+
+private:
+    qint64 budget{ 32*1024*1024 };
+    //回放
+    QSharedPointer<QOpenGLShaderProgram> shaderProgram;
+    QOpenGLVertexArrayObject vao;
+    QSharedPointer<QOpenGLBuffer> vbo;
+    bool initialized{ false };
+    //当前可用的烘焙结果
+    GLuint texture{ 0 };
+    BakeKey readyKey;
+    int frames{ 0 };
+    //替换下来等待删除的纹理
+    QVector<GLuint> retired;
+    //显存登记，所属对象为parent
+    int textureMemory{ -1 };
+    int vaoMemory{ -1 };
+    //正在烘焙和排队的参数
+    BakeKey bakingKey;
+    BakeKey pendingKey;
+    bool hasPending{ false };
+    QAtomicInt abortBake{ 0 };
+    //工作线程交出、GUI线程还没收下的纹理，析构时队列里的onBaked不会再执行，由析构删除
+    QAtomicInt bakedTexture{ 0 };
+    //工作线程和共享上下文
+    QThread *thread{ nullptr };
+    QOpenGLContext *context{ nullptr };
+    QOffscreenSurface *surface{ nullptr };
+};
@@ -1,36 +1,50 @@
 #include "WaveProgressBar.h"
+#include "GaugeAnimator.h"
 
-#include <QPainter>
+#include <QOpenGLFramebufferObject>
 #include <QDebug>
 
+#include <cmath>
+
+//波浪一个周期的时长，与原来30ms步进2/360一致
+static const double wave_period_s=5.4;
+
 WaveProgressBar::WaveProgressBar(QWidget *parent)
     : QOpenGLWidget(parent)
 {
     animation=new QPropertyAnimation(this,"drawValue");
     animation->setDuration(2000); //动画持续时间
     animation->setEasingCurve(QEasingCurve::OutQuart); //先快后慢
+    easingClock.start();
+    frameProfiler=new GaugeProfiler(this);
+    frameRecorder=new GaugeRecorder(this);
+    renderer.setMemoryOwner(this);
+    resolution.setMemoryOwner(this);
 
-    timer=new QTimer(this);
-    connect(timer,&QTimer::timeout,this,[this]{
-        if(isHidden())
-            return;
-        //暂时没有考虑周期
-        timeValue+=2;
-        if(timeValue>=360)
-            timeValue=0;
-        update();
-    });
-    timer->start(30);
+    //帧驱动按vsync请求刷新，时间取单调时钟，波浪速度与帧率无关
+    driver=new GaugeFrameDriver(this);
+    driver->start();
 }
 
 WaveProgressBar::~WaveProgressBar()
 {
+    if(animatorHandle>=0)
+        GaugeAnimator::instance()->remove(animatorHandle);
+    //工作线程有自己的上下文，先停下
+    if(renderThread)
+        renderThread->stop();
+    GaugeMemory::instance()->untrack(backingMemory);
     //显示后才会执行初始化
     if(!isValid())
         return;
     makeCurrent();
-    vbo.destroy();
-    vao.destroy();
+    if(waveAtlas)
+        waveAtlas->release();
+    frameRecorder->release();
+    frameProfiler->release();
+    resolution.release();
+    blitter.destroy();
+    renderer.release();
     doneCurrent();
 }
 
@@ -46,12 +60,57 @@ void WaveProgressBar::setValue(double value)
 {
     if(value<progressMin||value>progressMax)
         return;
-    progressDraw=progressValue;
     progressValue=value;
+    if(animatorHandle>=0){
+        //由GaugeAnimator统一推进，值变化时它会调用update()
+        GaugeAnimator::instance()->animateTo(animatorHandle,normalizedProgress(progressValue));
+        return;
+    }
+    if(gpuEasing){
+        //只改缓动参数，由着色器计算过程，帧驱动本来就在出帧
+        easing.retarget(easingNow(),normalizedProgress(progressValue));
+        return;
+    }
+    //从当前绘制的值继续，动画进行中时只改终点不重新计时
+    GaugeValueFeed::retarget(animation,progressDraw,progressValue);
+}
+
+void WaveProgressBar::postValue(double value)
+{
+    //只有上一个值已被取走时才排队刷新，之后的写入直接覆盖
+    if(valueFeed.store(value))
+        QMetaObject::invokeMethod(this,[this]{ update(); },Qt::QueuedConnection);
+}
+
+void WaveProgressBar::setDataSource(GaugeDataSource *source)
+{
+    //波浪动画本来就每帧绘制，直接在paintGL里取值
+    dataSource=source;
+}
+
+GaugeDataSource *WaveProgressBar::getDataSource() const
+{
+    return dataSource;
+}
 
-    animation->setStartValue(progressDraw);
-    animation->setEndValue(progressValue);
-    animation->start();
+bool WaveProgressBar::isValueSettled() const
+{
+    if(gpuEasing)
+        return !easing.isRunning(easingNow());
+    if(animatorHandle>=0)
+        return !GaugeAnimator::instance()->isRunning(animatorHandle);
+    return animation->state()!=QAbstractAnimation::Running;
+}
+
+double WaveProgressBar::easingNow() const
+{
+    return easingClock.nsecsElapsed()/1e9;
+}
+
+float WaveProgressBar::normalizedProgress(double value) const
+{
+    //把进度[min,max]归一化[0,1]
+    return float((value-progressMin)/(progressMax-progressMin));
 }
 
 double WaveProgressBar::getDrawValue() const
@@ -65,167 +124,388 @@ void WaveProgressBar::setDrawValue(double value)
     update();
 }
 
-void WaveProgressBar::initializeGL()
+void WaveProgressBar::setTargetFps(int fps)
 {
-    //为当前上下文初始化OpenGL函数解析
-    initializeOpenGLFunctions();
+    driver->setTargetFps(fps);
+}
 
-    //着色器代码
-    //in输入，out输出,uniform从cpu向gpu发送
-    //[aPos]两个三角的顶点数据
-    //[thePos]表示当前像素点
-    const char *vertex_str=R"(#version 330 core
-                           layout (location = 0) in vec2 aPos;
-                           out vec2 thePos;
-                           void main()
-                           {
-                             gl_Position = vec4(aPos, 0.0, 1.0);
-                             thePos = aPos;
-                           })";
-    //GLSL的atan2也叫atan，不过参数不同，我们封装一个0-360度的归一化值[0,1]的版本
-    //[FragColor]该点输出颜色，gl_FragColor在3移除了，自己声明一个
-    //[aValue]进度值
-    //[aTime]时间偏移
-    //[aSmoothWidth]平滑过渡宽度
-    const char *fragment_str=R"(#version 330 core
-                             #define PI 3.14159265
-                             uniform float aValue;
-                             uniform float aTime;
-                             uniform float aSmoothWidth;
-                             in vec2 thePos;
-                             out vec4 FragColor;
-
-                             float myatan2(float y,float x)
-                             {
-                               float ret_val = 0.0;
-                               if(x != 0.0){
-                                 ret_val = atan(y,x);
-                                 if(ret_val < 0.0){
-                                   ret_val += 2.0*PI;
-                                 }
-                               }else{
-                                 ret_val = y>0 ? PI*0.5 : PI*1.5;
-                               }
-                               return ret_val/(2.0*PI);
-                             }
-
-                             void main()
-                             {
-                             float len = abs(sqrt(pow(thePos.x,2.0)+pow(thePos.y,2.0)));
-                             float alpha = smoothstep(0.6+aSmoothWidth,0.6,len);
-
-                             FragColor = vec4(aValue,0.2,1.0,alpha);
-                             if(alpha<=0){
-                               FragColor.a = smoothstep(0.05+aSmoothWidth,0.05,abs(len-0.75));
-                               float angle = myatan2(thePos.y,thePos.x);
-                               float angle_diff=abs(angle-aTime);
-                               if(angle_diff>0.5) angle_diff=1.0-angle_diff;
-                               float g_smooth = smoothstep(0,aSmoothWidth/2.0,abs(angle_diff-0.25));
-                               if(angle_diff<=0.25){
-                                 FragColor.g = 0.2+0.4*g_smooth;
-                               }
-                             }else{
-                               float posY = (thePos.y+0.6)/1.2;
-                               float yTop1 = posY+0.03*sin(-aTime*10*PI+thePos.x*10)-0.02;
-                               float ySmooth1 = smoothstep(yTop1,yTop1+aSmoothWidth,aValue);
-                               float yTop2 = posY+0.03*sin(aTime*10*PI+thePos.x*10);
-                               float ySmooth2 = smoothstep(yTop2,yTop2+aSmoothWidth,aValue);
-
-                               if(ySmooth1>0&&ySmooth2<0.8){
-                                 FragColor.g += 0.4*ySmooth1;
-                                 if(ySmooth2>0) FragColor.g += 0.2*ySmooth2;
-                               }else if(ySmooth2>0){
-                                 FragColor.g += 0.6*ySmooth2;
-                               }
-                             }
-                             })";
-
-
-    //将source编译为指定类型的着色器，并添加到此着色器程序
-    if(!shaderProgram.addCacheableShaderFromSourceCode(
-                QOpenGLShader::Vertex,vertex_str)){
-        qDebug()<<"compiler vertex error"<<shaderProgram.log();
+int WaveProgressBar::getTargetFps() const
+{
+    return driver->getTargetFps();
+}
+
+void WaveProgressBar::setPowerSave(bool enable)
+{
+    driver->setPowerSave(enable);
+}
+
+bool WaveProgressBar::isPowerSave() const
+{
+    return driver->isPowerSave();
+}
+
+GaugeFrameDriver *WaveProgressBar::frameDriver() const
+{
+    return driver;
+}
+
+void WaveProgressBar::setQuality(GaugeShaders::Quality quality)
+{
+    renderer.setQuality(quality);
+    if(renderThread)
+        renderThread->setQuality(quality);
+    update();
+}
+
+GaugeShaders::Quality WaveProgressBar::getQuality() const
+{
+    return renderer.getQuality();
+}
+
+void WaveProgressBar::setLabelFont(const QFont &font)
+{
+    renderer.setLabelFont(font);
+    if(renderThread)
+        renderThread->setLabelFont(font);
+    update();
+}
+
+QFont WaveProgressBar::getLabelFont() const
+{
+    return renderer.getLabelFont();
+}
+
+void WaveProgressBar::setMeshGeometryEnabled(bool enable)
+{
+    renderer.setMeshGeometryEnabled(enable);
+    if(renderThread)
+        renderThread->setMeshGeometryEnabled(enable);
+    update();
+}
+
+bool WaveProgressBar::isMeshGeometryEnabled() const
+{
+    return renderer.isMeshGeometryEnabled();
+}
+
+void WaveProgressBar::setAtlasEnabled(bool enable)
+{
+    if(enable==atlasEnabled)
+        return;
+    atlasEnabled=enable;
+    if(enable&&!waveAtlas){
+        waveAtlas=new WaveAtlas(this);
+        if(isValid()){
+            makeCurrent();
+            waveAtlas->initialize();
+            doneCurrent();
+        }
+    }else if(!enable&&waveAtlas&&isValid()){
+        //关闭时归还显存，再开启时重新烘焙
+        makeCurrent();
+        waveAtlas->release();
+        waveAtlas->initialize();
+        doneCurrent();
     }
-    if(!shaderProgram.addCacheableShaderFromSourceCode(
-                QOpenGLShader::Fragment,fragment_str)){
-        qDebug()<<"compiler fragment error"<<shaderProgram.log();
+    update();
+}
+
+bool WaveProgressBar::isAtlasEnabled() const
+{
+    return atlasEnabled;
+}
+
+WaveAtlas *WaveProgressBar::atlas() const
+{
+    return waveAtlas;
+}
+
+bool WaveProgressBar::setThreadedRenderingEnabled(bool enable)
+{
+    if(enable==(renderThread!=nullptr))
+        return true;
+    if(enable){
+        //工作线程的渲染器与当前样式一致
+        WaveProgressRenderer *thread_renderer=new WaveProgressRenderer;
+        thread_renderer->setQuality(renderer.getQuality());
+        thread_renderer->setLabelFont(renderer.getLabelFont());
+        thread_renderer->setMeshGeometryEnabled(renderer.isMeshGeometryEnabled());
+        renderThread=new GaugeRenderThread(thread_renderer,this);
+        if(!renderThread->start()){
+            delete renderThread;
+            renderThread=nullptr;
+            return false;
+        }
+        //波浪由帧驱动持续刷新，每次刷新贴上最新完成的一帧
+    }else{
+        //等GUI线程贴图的命令执行完再释放工作线程的纹理
+        if(isValid()){
+            makeCurrent();
+            glFinish();
+            doneCurrent();
+        }
+        delete renderThread;
+        renderThread=nullptr;
+    }
+    update();
+    return true;
+}
+
+bool WaveProgressBar::isThreadedRenderingEnabled() const
+{
+    return renderThread!=nullptr;
+}
+
+void WaveProgressBar::setAdaptiveResolutionEnabled(bool enable)
+{
+    if(enable==adaptiveResolution)
+        return;
+    adaptiveResolution=enable;
+    //关闭时归还内部FBO
+    if(!enable&&isValid()){
+        makeCurrent();
+        resolution.release();
+        doneCurrent();
     }
-    //使用addShader()将添加到该程序的着色器链接在一起。
-    if(!shaderProgram.link()){
-        qDebug()<<"link shaderprogram error"<<shaderProgram.log();
+    update();
+}
+
+bool WaveProgressBar::isAdaptiveResolutionEnabled() const
+{
+    return adaptiveResolution;
+}
+
+GaugeResolutionScaler *WaveProgressBar::resolutionScaler()
+{
+    return &resolution;
+}
+
+void WaveProgressBar::setSurfaceMode(GaugeSurface::Mode mode)
+{
+    if(GaugeSurface::apply(this,mode))
+        surfaceMode=mode;
+}
+
+GaugeSurface::Mode WaveProgressBar::getSurfaceMode() const
+{
+    return surfaceMode;
+}
+
+qint64 WaveProgressBar::gpuMemoryBytes() const
+{
+    return GaugeMemory::instance()->bytesFor(this);
+}
+
+void WaveProgressBar::setProfilingEnabled(bool enable)
+{
+    frameProfiler->setEnabled(enable);
+    renderer.setTimingEnabled(enable);
+}
+
+bool WaveProgressBar::isProfilingEnabled() const
+{
+    return frameProfiler->isEnabled();
+}
+
+GaugeProfiler *WaveProgressBar::profiler() const
+{
+    return frameProfiler;
+}
+
+GaugeRecorder *WaveProgressBar::recorder() const
+{
+    return frameRecorder;
+}
+
+bool WaveProgressBar::setGpuEasingEnabled(bool enable)
+{
+    if(enable==gpuEasing)
+        return true;
+    const double now=easingNow();
+    if(enable){
+        setSharedAnimationEnabled(false);
+        GaugeEasing::Curve curve;
+        if(!GaugeEasing::curveFor(animation->easingCurve().type(),curve)){
+            qWarning()<<"GPU easing does not support this easing curve";
+            return false;
+        }
+        //接着进行中的属性动画继续
+        easing.curve=curve;
+        easing.duration=animation->duration()/1000.0f;
+        if(animation->state()==QAbstractAnimation::Running){
+            easing.start=normalizedProgress(animation->startValue().toDouble());
+            easing.end=normalizedProgress(animation->endValue().toDouble());
+            easing.startTime=now-animation->currentTime()/1000.0;
+        }else{
+            easing.jump(normalizedProgress(progressDraw));
+        }
+        animation->stop();
+    }else{
+        //从当前值改回属性动画
+        progressDraw=progressMin+easing.valueAt(now)*(progressMax-progressMin);
+        if(easing.isRunning(now))
+            GaugeValueFeed::retarget(animation,progressDraw,progressValue);
     }
+    gpuEasing=enable;
+    renderer.setGpuEasingEnabled(enable);
+    update();
+    return true;
+}
 
-    //两个三角拼接的一个矩形
-    const float vertices[] = {
-        -1.0f, -1.0f, //左下角
-        +1.0f, -1.0f, //右下角
-        +1.0f, +1.0f, //右上角
-
-        +1.0f, +1.0f, //右上角
-        -1.0f, +1.0f, //左上角
-        -1.0f, -1.0f, //左下角
-    };
-    vao.create();
-    vao.bind();
-    vbo=QOpenGLBuffer(QOpenGLBuffer::VertexBuffer);
-    vbo.create();
-    vbo.bind();
-    vbo.allocate(vertices,sizeof(vertices));
-
-    // position attribute
-    int attr = -1;
-    attr = shaderProgram.attributeLocation("aPos");
-    //setAttributeBuffer(int location, GLenum type, int offset, int tupleSize, int stride = 0)
-    shaderProgram.setAttributeBuffer(attr, GL_FLOAT, 0, 2, sizeof(GLfloat) * 2);
-    shaderProgram.enableAttributeArray(attr);
+bool WaveProgressBar::isGpuEasingEnabled() const
+{
+    return gpuEasing;
 }
 
-void WaveProgressBar::paintGL()
+void WaveProgressBar::setSharedAnimationEnabled(bool enable)
 {
-    //以短边为边长，保持比例，Qt这里有个问题，在resize里设置的没用
-    const int item_w=width()>height()?height():width();
-    glViewport((width()-item_w)/2,
-               (height()-item_w)/2,
-               item_w,
-               item_w);
+    if(enable==(animatorHandle>=0))
+        return;
+    GaugeAnimator *animator=GaugeAnimator::instance();
+    if(enable){
+        setGpuEasingEnabled(false);
+        //从当前值接着走向设置的值
+        const bool running=animation->state()==QAbstractAnimation::Running;
+        animation->stop();
+        animatorHandle=animator->add(this);
+        animator->jumpTo(animatorHandle,normalizedProgress(progressDraw));
+        if(running)
+            animator->animateTo(animatorHandle,normalizedProgress(progressValue));
+    }else{
+        progressDraw=progressMin+animator->value(animatorHandle)*(progressMax-progressMin);
+        if(animator->isRunning(animatorHandle))
+            GaugeValueFeed::retarget(animation,progressDraw,progressValue);
+        animator->remove(animatorHandle);
+        animatorHandle=-1;
+    }
+    update();
+}
 
-    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-    glClear(GL_COLOR_BUFFER_BIT);
+bool WaveProgressBar::isSharedAnimationEnabled() const
+{
+    return animatorHandle>=0;
+}
 
-    glEnable(GL_BLEND);
-    //基于源像素Alpha通道值的半透明混合函数
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE);
-    //开启多重采样抗锯齿，貌似没啥效果
-    //glEnable(GL_MULTISAMPLE);
+void WaveProgressBar::initializeGL()
+{
+    //为当前上下文初始化OpenGL函数解析
+    initializeOpenGLFunctions();
+    //着色器代码见GaugeShaders
+    renderer.initialize();
+    blitter.create();
+    if(waveAtlas)
+        waveAtlas->initialize();
+}
 
-    shaderProgram.bind();
-    //把进度[min,max]归一化[0,1]
-    const float progress=(progressDraw-progressMin)/(progressMax-progressMin);
+void WaveProgressBar::paintGL()
+{
+    //取数据源和跨线程写入的最新值，一帧只取一次
+    double fed_value=0;
+    if(dataSource&&dataSource->sample(fed_value))
+        setValue(fed_value);
+    if(valueFeed.take(fed_value))
+        setValue(fed_value);
+    if(gpuEasing){
+        //进度由着色器计算，这里只同步参数、维护drawValue
+        const double now=easingNow();
+        renderer.setEasing(easing,now);
+        progressDraw=progressMin+easing.valueAt(now)*(progressMax-progressMin);
+    }else if(animatorHandle>=0){
+        progressDraw=progressMin+GaugeAnimator::instance()->value(animatorHandle)*(progressMax-progressMin);
+    }
+    const float progress=normalizedProgress(progressDraw);
     //qDebug()<<"draw progress"<<progress;
-    shaderProgram.setUniformValue("aValue", progress);
-    //时间偏移移动
-    shaderProgram.setUniformValue("aTime", float(timeValue/360.0));
-    //aSmoothWidth用来计算平滑所需宽度，根据不同的大小来计算，这里用N px的宽度
-    shaderProgram.setUniformValue("aSmoothWidth", float(3.0/item_w));
-    vao.bind();
+    //时间偏移归一化到一个周期[0,1)
+    const float time=float(std::fmod(driver->elapsed(),wave_period_s)/wave_period_s);
+    const bool profiling=frameProfiler->isEnabled();
+    if(profiling)
+        frameProfiler->beginFrame(driver->isRunning()&&!driver->isSuspended(),driver->effectiveFps());
+    if(renderThread){
+        //GUI线程只贴图，各阶段记0
+        drawThreaded(progress,time);
+        if(profiling)
+            frameProfiler->endFrame(ProgressRenderer::Timings());
+        frameRecorder->captureFrame();
+        return;
+    }
+    if(atlasEnabled&&isValueSettled()){
+        //进度停下后才烘焙，动画过程中的每个值都实时绘制
+        const qreal ratio=devicePixelRatioF();
+        const QSize pixel_size(qRound(width()*ratio),qRound(height()*ratio));
+        const int side=qMin(pixel_size.width(),pixel_size.height());
+        const GaugeShaders::Quality quality=renderer.getQuality();
+        waveAtlas->request(side,progress,quality,float(ratio));
+        if(waveAtlas->isReady(side,progress,quality,float(ratio))){
+            waveAtlas->draw(pixel_size.width(),pixel_size.height(),time);
+            renderer.setPixelScale(float(ratio));
+            renderer.renderLabel(pixel_size.width(),pixel_size.height(),progress);
+            if(profiling)
+                frameProfiler->endFrame(ProgressRenderer::Timings());
+            frameRecorder->captureFrame();
+            return;
+        }
+    }
+    drawLive(progress,time);
+    if(profiling)
+        frameProfiler->endFrame(renderer.lastTimings());
+    frameRecorder->captureFrame();
+}
 
-    glDrawArrays(GL_TRIANGLES, 0, 6);
+void WaveProgressBar::drawThreaded(float progress, float time)
+{
+    const qreal ratio=devicePixelRatioF();
+    GaugeRenderThread::FrameRequest request;
+    request.fboSize=QSize(qRound(width()*ratio),qRound(height()*ratio));
+    request.pixelScale=float(ratio);
+    request.progress=progress;
+    request.time=time;
+    renderThread->requestFrame(request);
 
-    vao.release();
-    shaderProgram.release();
+    //贴上最新完成的一帧，还没有时只清屏
+    const GaugeRenderThread::Frame &frame=renderThread->latestFrame(this);
+    glViewport(0, 0, request.fboSize.width(), request.fboSize.height());
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    if(!frame.texture)
+        return;
+    glDisable(GL_BLEND);
+    blitter.bind();
+    blitter.blit(frame.texture, QMatrix4x4(), QOpenGLTextureBlitter::OriginBottomLeft);
+    blitter.release();
+}
 
-    //目前文字用QPainter绘制
-    QPainter painter(this);
-    painter.setPen(Qt::white);
-    painter.setFont(QFont("Microsoft YaHei",16));
-    const QString text_val=QString::number(progress*100,'f',2)+" %";
-    const int text_x=width()/2-painter.fontMetrics().width(text_val)/2;
-    const int text_y=height()/2+painter.fontMetrics().height()/2;
-    painter.drawText(text_x,text_y,text_val);
+void WaveProgressBar::drawLive(float progress, float time)
+{
+    //QOpenGLWidget的帧缓冲按设备像素分配
+    const qreal ratio=devicePixelRatioF();
+    const QSize pixel_size(qRound(width()*ratio),qRound(height()*ratio));
+    renderer.setPixelScale(float(ratio));
+    if(!adaptiveResolution){
+        renderer.render(pixel_size.width(),pixel_size.height(),progress,time);
+        return;
+    }
+    //仪表本体画到缩小的FBO再放大，文字按原分辨率绘制
+    QOpenGLFramebufferObject *fbo=resolution.begin(pixel_size);
+    renderer.setPixelScale(float(ratio*resolution.scale()));
+    renderer.renderGauge(fbo->width(),fbo->height(),progress,time);
+    resolution.end(defaultFramebufferObject());
+    renderer.setPixelScale(float(ratio));
+    renderer.renderLabel(pixel_size.width(),pixel_size.height(),progress);
+}
+
+void WaveProgressBar::trackBackingMemory(int width, int height)
+{
+    //QOpenGLWidget的帧缓冲按设备像素分配，带深度模板，多重采样时另有一个解析用的颜色缓冲
+    const qreal ratio=devicePixelRatioF();
+    const QSize pixel_size(qRound(width*ratio),qRound(height*ratio));
+    GaugeMemory::instance()->track(backingMemory,this,GaugeMemory::Framebuffer,
+                                   QString("widget framebuffer %1x%2").arg(pixel_size.width()).arg(pixel_size.height()),
+                                   GaugeMemory::framebufferBytes(pixel_size,true,format().samples(),GaugeSurface::bytesPerPixel(surfaceMode)));
 }
 
 void WaveProgressBar::resizeGL(int width, int height)
 {
+    trackBackingMemory(width,height);
     //以短边为边长，保持比例，Qt这里有个问题，在resize里设置的没用
     const int item_w=width>height?height:width;
     glViewport((width-item_w)/2,
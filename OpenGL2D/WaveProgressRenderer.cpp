@@ -0,0 +1,25 @@
+#include "WaveProgressRenderer.h"
+
+GaugeShaders::Program WaveProgressRenderer::programType() const
+{
+    //着色器代码见GaugeShaders
+    return GaugeShaders::WaveProgram;
+}
+
+QColor WaveProgressRenderer::clearColor() const
+{
+    return QColor::fromRgbF(0.0,0.0,0.0);
+}
+
+void WaveProgressRenderer::coverage(float smoothWidth, float &inner, float &outer) const
+{
+    //与waveColor一致：外环|len-0.75|<0.05+smoothWidth，内圆到圆心，中间的空隙很窄，整体画成圆盘
+    inner=0;
+    outer=0.8f+smoothWidth;
+}
+
+void WaveProgressRenderer::updateUniforms(QOpenGLShaderProgram *program, float time)
+{
+    //时间偏移移动
+    program->setUniformValue("aTime", time);
+}
@@ -0,0 +1,14 @@
+#pragma once
+#include "ProgressRenderer.h"
+
+//进度球的绘制
+class WaveProgressRenderer : public ProgressRenderer
+{
+protected:
+    GaugeShaders::Program programType() const override;
+    QColor clearColor() const override;
+    //内圆和外环合起来的圆盘，半径0.8
+    void coverage(float smoothWidth,float &inner,float &outer) const override;
+    //[aTime]时间偏移
+    void updateUniforms(QOpenGLShaderProgram *program,float time) override;
+};
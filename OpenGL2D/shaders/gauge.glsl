@@ -0,0 +1,144 @@
+//环形进度条和进度球的像素计算，GL后端（GaugeShaders从qrc读取）和QRhi后端（circle.frag、wave.frag由qsb编译）共用这一份
+//#version和GAUGE_QUALITY由包含方给出，GAUGE_QUALITY与GaugeShaders::Quality一致：0高 1中 2低
+//各档位打开哪些开关只在这里定义：
+//  FAST_MATH   用length和多项式atan近似代替sqrt(pow)和分支atan
+//  BRANCHLESS  用mix/step选择颜色，去掉像素级分支
+//  WAVE_LAYERS 进度球的波浪层数，低档只算一层sin
+#ifndef GAUGE_QUALITY
+#define GAUGE_QUALITY 0
+#endif
+#if GAUGE_QUALITY >= 1
+#define FAST_MATH
+#define BRANCHLESS
+#endif
+#if GAUGE_QUALITY >= 2
+#define WAVE_LAYERS 1
+#else
+#define WAVE_LAYERS 2
+#endif
+
+#define PI 3.14159265
+
+//GLSL的atan2也叫atan，不过参数不同，我们封装一个0-360度的归一化值[0,1]的版本
+//FAST_MATH时用多项式近似atan，误差约1e-5弧度，象限用mix/step处理
+float myatan2(float y,float x)
+{
+#ifdef FAST_MATH
+    float ax = abs(x);
+    float ay = abs(y);
+    float a = min(ax,ay)/max(max(ax,ay),1e-8);
+    float s = a*a;
+    float r = ((-0.0464964749*s+0.15931422)*s-0.327622764)*s*a+a;
+    r = mix(r,PI*0.5-r,step(ax,ay));
+    r = mix(r,PI-r,1.0-step(0.0,x));
+    r = mix(r,2.0*PI-r,1.0-step(0.0,y));
+    return r/(2.0*PI);
+#else
+    float ret_val = 0.0;
+    if(x != 0.0){
+        ret_val = atan(y,x);
+        if(ret_val < 0.0){
+            ret_val += 2.0*PI;
+        }
+    }else{
+        ret_val = y>0.0 ? PI*0.5 : PI*1.5;
+    }
+    return ret_val/(2.0*PI);
+#endif
+}
+
+//mylength为坐标点距离圆心的距离，勾股定理
+float mylength(vec2 pos)
+{
+#ifdef FAST_MATH
+    return length(pos);
+#else
+    return abs(sqrt(pow(pos.x,2.0)+pow(pos.y,2.0)));
+#endif
+}
+
+//环形进度条
+//[value]进度值
+//[smoothWidth]用来计算平滑所需宽度，根据绘制区域大小来计算
+//[len]坐标点距离圆心的距离,[0,1]
+//[alpha]使用smoothstep平滑函数取0.75±0.15的圆圈透明度为1
+//[angle]pos像素点对应的角度值，用于调节渐变，归一化到[0，1]
+//[angle_smooth]进度值那条斜线取平滑
+//[ret smoothstep(a,b,x)]可以用来生成0-1的平滑过渡，达到抗锯齿效果
+//返回0: x<a<b 或者 x>a>b
+//返回1: x<b<a 或者 x>b>a
+//返回n: 根据x在ab间位置，返回[0,1]过度值
+//BRANCHLESS时把两层if合成一次mix，进度为0时整圈都是底色
+vec4 circleColor(vec2 pos,float value,float smoothWidth)
+{
+    float len = mylength(pos);
+    float alpha = smoothstep(0.15+smoothWidth,0.15,abs(len-0.75));
+    float angle = myatan2(pos.y,pos.x);
+    float angle_smooth = smoothstep(value+smoothWidth/3.0,value,angle);
+
+#ifdef BRANCHLESS
+    float k = angle_smooth*step(0.000001,value);
+    return vec4(mix(vec3(0.4,0.1,0.6),vec3(1.0,0.1,(1.0-angle)),k),alpha);
+#else
+    if(angle_smooth>0.0 && value>0.0){
+        if(angle_smooth>=1.0){
+            return vec4(1.0,0.1,(1.0-angle),alpha);
+        }else{
+            return vec4(mix(vec3(1.0,0.1,(1.0-angle)),vec3(0.4,0.1,0.6),1.0-angle_smooth),alpha);
+        }
+    }
+    return vec4(0.4,0.1,0.6,alpha);
+#endif
+}
+
+//进度球
+//[value]进度值
+//[time]时间偏移
+//[smoothWidth]平滑过渡宽度
+//内圆和外环的分支在空间上是连续的，保留；像素级的颜色选择在BRANCHLESS时去掉分支
+//WAVE_LAYERS为1时只保留前面一层波浪
+vec4 waveColor(vec2 pos,float value,float time,float smoothWidth)
+{
+    float len = mylength(pos);
+    float alpha = smoothstep(0.6+smoothWidth,0.6,len);
+
+    vec4 color = vec4(value,0.2,1.0,alpha);
+    if(alpha<=0.0){
+        color.a = smoothstep(0.05+smoothWidth,0.05,abs(len-0.75));
+        float angle = myatan2(pos.y,pos.x);
+        float angle_diff = abs(angle-time);
+#ifdef BRANCHLESS
+        angle_diff = mix(angle_diff,1.0-angle_diff,step(0.5,angle_diff));
+        float g_smooth = smoothstep(0.0,smoothWidth/2.0,abs(angle_diff-0.25));
+        color.g = mix(color.g,0.2+0.4*g_smooth,step(angle_diff,0.25));
+#else
+        if(angle_diff>0.5) angle_diff = 1.0-angle_diff;
+        float g_smooth = smoothstep(0.0,smoothWidth/2.0,abs(angle_diff-0.25));
+        if(angle_diff<=0.25){
+            color.g = 0.2+0.4*g_smooth;
+        }
+#endif
+    }else{
+        float posY = (pos.y+0.6)/1.2;
+        float yTop2 = posY+0.03*sin(time*10.0*PI+pos.x*10.0);
+        float ySmooth2 = smoothstep(yTop2,yTop2+smoothWidth,value);
+#if WAVE_LAYERS > 1
+        float yTop1 = posY+0.03*sin(-time*10.0*PI+pos.x*10.0)-0.02;
+        float ySmooth1 = smoothstep(yTop1,yTop1+smoothWidth,value);
+#ifdef BRANCHLESS
+        float front = step(0.000001,ySmooth1)*(1.0-step(0.8,ySmooth2));
+        color.g += mix(0.6*ySmooth2,0.4*ySmooth1+0.2*ySmooth2,front);
+#else
+        if(ySmooth1>0.0 && ySmooth2<0.8){
+            color.g += 0.4*ySmooth1;
+            if(ySmooth2>0.0) color.g += 0.2*ySmooth2;
+        }else if(ySmooth2>0.0){
+            color.g += 0.6*ySmooth2;
+        }
+#endif
+#else
+        color.g += 0.6*ySmooth2;
+#endif
+    }
+    return color;
+}
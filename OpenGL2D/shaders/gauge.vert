@@ -0,0 +1,17 @@
+#version 440
+//QRhi后端的顶点着色器，构建时由qsb编译，见OpenGL2D.pri
+//[aPos]仪表内的坐标[-1,1]，y轴向上，整个视口一个四边形
+//[clipCorr]QRhi::clipSpaceCorrMatrix()，抹平各图形API裁剪空间的差异
+layout(location = 0) in vec2 aPos;
+layout(location = 0) out vec2 thePos;
+
+layout(std140, binding = 0) uniform buf {
+    mat4 clipCorr;
+    vec4 params;
+};
+
+void main()
+{
+    thePos = aPos;
+    gl_Position = clipCorr*vec4(aPos,0.0,1.0);
+}
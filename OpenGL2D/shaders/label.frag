@@ -0,0 +1,19 @@
+#version 440
+//距离场0.5处为字形边缘，用fwidth得到一个像素对应的距离变化做抗锯齿，与label_fragment_str相同
+layout(location = 0) in vec2 theUV;
+layout(location = 0) out vec4 fragColor;
+
+layout(std140, binding = 0) uniform buf {
+    mat4 clipCorr;
+    vec4 viewSize;
+    vec4 color;
+};
+layout(binding = 1) uniform sampler2D atlas;
+
+void main()
+{
+    float dist = texture(atlas,theUV).r;
+    float w = max(fwidth(dist)*0.7,0.0001);
+    float alpha = smoothstep(0.5-w,0.5+w,dist);
+    fragColor = vec4(color.rgb,color.a*alpha);
+}
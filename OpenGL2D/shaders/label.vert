@@ -0,0 +1,21 @@
+#version 440
+//QRhi后端的百分比文字，与GaugeShaders.cpp的label_vertex_str相同
+//[aPos]字符矩形顶点，单位为逻辑像素，y轴向下
+//[aUV]图集纹理坐标
+layout(location = 0) in vec2 aPos;
+layout(location = 1) in vec2 aUV;
+layout(location = 0) out vec2 theUV;
+
+layout(std140, binding = 0) uniform buf {
+    mat4 clipCorr;
+    vec4 viewSize;
+    vec4 color;
+};
+
+void main()
+{
+    theUV = aUV;
+    gl_Position = clipCorr*vec4(aPos.x/viewSize.x*2.0-1.0,
+                                1.0-aPos.y/viewSize.y*2.0,
+                                0.0, 1.0);
+}
@@ -0,0 +1,19 @@
+#version 440
+#extension GL_GOOGLE_include_directive : enable
+//QRhi后端的进度球，计算在gauge.glsl，与GL后端共用
+//GAUGE_QUALITY由qsb按画质档位用-D传入，每档一个.qsb，见OpenGL2D.pri
+//[params]进度、时间、平滑宽度
+layout(location = 0) in vec2 thePos;
+layout(location = 0) out vec4 fragColor;
+
+layout(std140, binding = 0) uniform buf {
+    mat4 clipCorr;
+    vec4 params;
+};
+
+#include "gauge.glsl"
+
+void main()
+{
+    fragColor = waveColor(thePos,params.x,params.y,params.z);
+}
@@ -0,0 +1,655 @@
+//进度条离屏渲染基准测试
+//用QOffscreenSurface+FBO渲染，扫描尺寸、实例数、动画状态、着色器档位，结果输出为JSON
+//指定--baseline时与之前的结果比较，帧率下降超过--tolerance则返回非0，可作为CI门禁
+//例：QT_QPA_PLATFORM=offscreen LIBGL_ALWAYS_SOFTWARE=1 ./GaugeBenchmark --output result.json
+//Qt5的offscreen平台通过GLX创建上下文，无显示器的机器可配合xvfb-run使用
+#include "CircleProgressRenderer.h"
+#include "WaveProgressRenderer.h"
+#include "GLResourceCache.h"
+#include "SoftwareRasterizer.h"
+#include "SharedMemorySource.h"
+#include "GaugeAnimator.h"
+#include "GaugeSurface.h"
+#include "GaugeMemory.h"
+
+#include <QGuiApplication>
+#include <QCommandLineParser>
+#include <QSurfaceFormat>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
+#include <QOpenGLExtraFunctions>
+#include <QOpenGLFramebufferObject>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QFile>
+#include <QTextStream>
+#include <QVector>
+#include <QHash>
+#include <QScopedPointer>
+#include <QImage>
+#include <QPainter>
+#include <QVariantAnimation>
+#include <QDebug>
+
+#include <algorithm>
+#include <cmath>
+
+//GLES的头文件里没有，桌面GL 1.5起可用
+#ifndef GL_SAMPLES_PASSED
+#define GL_SAMPLES_PASSED 0x8914
+#endif
+//Qt5.14起分割选项移到Qt命名空间，Qt6去掉了QString里的
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+static const Qt::SplitBehavior skip_empty_parts=Qt::SkipEmptyParts;
+#else
+static const QString::SplitBehavior skip_empty_parts=QString::SkipEmptyParts;
+#endif
+#ifdef Q_OS_UNIX
+#include <time.h>
+#include <unistd.h>
+#endif
+
+//测试参数
+struct BenchOptions
+{
+    int frames{ 60 };
+    int warmup{ 5 };
+    bool label{ true };
+    bool gpuEasing{ false }; //动画进度由着色器按缓动参数计算
+    QString feedKey; //非空时动画进度从该共享内存区域读取，实例i读槽i
+    bool composite{ false }; //每帧把每个实例的帧缓冲合成到RGBA8目标，相当于后备存储合成控件
+};
+
+//一组测试条件
+struct BenchCase
+{
+    QString kind;      //circle/wave，soft-circle/soft-wave为CPU光栅化
+    int size{ 256 };   //FBO边长
+    int instances{ 1 };//每帧绘制的实例数，模拟同屏多个控件
+    bool animated{ false };
+    QString quality{ "high" };//high/medium/low
+    bool mesh{ false };//圆环网格代替全窗口矩形
+    GaugeSurface::Mode surface{ GaugeSurface::Default };//帧缓冲格式
+
+    //矩形的名字不带后缀，与之前的基准结果保持一致
+    QString name() const {
+        return QString("%1/%2/x%3/%4/%5").arg(kind).arg(size).arg(instances)
+                .arg(animated?"animated":"static").arg(quality)+(mesh?"/mesh":"")
+                +(surface!=GaugeSurface::Default?"/"+GaugeSurface::modeName(surface):QString());
+    }
+};
+
+//当前线程CPU时间，不支持时退化为墙上时间
+static qint64 threadCpuNs()
+{
+#if defined(Q_OS_UNIX) && defined(CLOCK_THREAD_CPUTIME_ID)
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID,&ts);
+    return qint64(ts.tv_sec)*1000000000LL+ts.tv_nsec;
+#else
+    static QElapsedTimer timer;
+    if(!timer.isValid())
+        timer.start();
+    return timer.nsecsElapsed();
+#endif
+}
+
+//进程常驻内存，只在Linux上可读，其他平台返回-1
+static qint64 residentBytes()
+{
+#if defined(Q_OS_LINUX)
+    QFile file("/proc/self/statm");
+    if(!file.open(QIODevice::ReadOnly))
+        return -1;
+    const QList<QByteArray> fields=file.readAll().split(' ');
+    if(fields.size()<2)
+        return -1;
+    return fields.at(1).toLongLong()*sysconf(_SC_PAGESIZE);
+#else
+    return -1;
+#endif
+}
+
+//已排序数组的百分位
+static double percentile(const QVector<double> &sorted,double p)
+{
+    if(sorted.isEmpty())
+        return 0;
+    const int index=qBound(0,int(std::ceil(p*sorted.size()))-1,sorted.size()-1);
+    return sorted.at(index);
+}
+
+static QVector<int> parseIntList(const QString &text)
+{
+    QVector<int> list;
+    for(const QString &item:text.split(',',skip_empty_parts)){
+        bool ok=false;
+        const int value=item.trimmed().toInt(&ok);
+        if(ok&&value>0)
+            list.append(value);
+    }
+    return list;
+}
+
+static GaugeShaders::Quality parseQuality(const QString &text)
+{
+    if(text=="low")
+        return GaugeShaders::QualityLow;
+    if(text=="medium")
+        return GaugeShaders::QualityMedium;
+    return GaugeShaders::QualityHigh;
+}
+
+//CPU光栅化：每个实例一张图，文字用QPainter，与SoftwareProgressBar一致
+//线程池的工作线程不计入当前线程CPU时间，paint_cpu_ms只反映调用线程
+static QJsonObject runSoftwareCase(const BenchCase &bench,const BenchOptions &options)
+{
+    QVector<QImage> images(bench.instances,QImage(bench.size,bench.size,QImage::Format_RGB32));
+    const int layers=(parseQuality(bench.quality)==GaugeShaders::QualityLow)?1:2;
+
+    QVector<double> frame_ms;
+    frame_ms.reserve(options.frames);
+    qint64 cpu_ns_total=0;
+    QElapsedTimer total_timer;
+    for(int frame=-options.warmup;frame<options.frames;frame++)
+    {
+        if(frame==0)
+            total_timer.start();
+        float progress=0.45f;
+        float time=0;
+        if(bench.animated){
+            progress=float(0.5+0.5*std::sin(frame*0.05));
+            time=float(std::fmod(frame/180.0,1.0));
+        }
+
+        QElapsedTimer frame_timer;
+        frame_timer.start();
+        const qint64 cpu_begin=threadCpuNs();
+        for(QImage &image:images){
+            if(bench.kind=="soft-wave")
+                SoftwareRasterizer::renderWave(image,progress,time,layers);
+            else
+                SoftwareRasterizer::renderCircle(image,progress);
+            if(options.label){
+                QPainter painter(&image);
+                painter.setPen(Qt::white);
+                painter.setFont(QFont("Microsoft YaHei",16));
+                painter.drawText(image.rect(),Qt::AlignCenter,QString::number(progress*100,'f',2)+" %");
+            }
+        }
+        const qint64 cpu_ns=threadCpuNs()-cpu_begin;
+        if(frame>=0){
+            cpu_ns_total+=cpu_ns;
+            frame_ms.append(frame_timer.nsecsElapsed()/1e6);
+        }
+    }
+    const double total_ms=total_timer.nsecsElapsed()/1e6;
+
+    std::sort(frame_ms.begin(),frame_ms.end());
+    const double frames=qMax(1,options.frames);
+    QJsonObject result;
+    result["name"]=bench.name();
+    result["kind"]=bench.kind;
+    result["size"]=bench.size;
+    result["instances"]=bench.instances;
+    result["animated"]=bench.animated;
+    result["quality"]=bench.quality;
+    result["label"]=options.label;
+    result["fps"]=total_ms>0?frames*1000.0/total_ms:0;
+    result["paint_cpu_ms"]=cpu_ns_total/1e6/frames;
+    result["paint_cpu_ms_per_instance"]=cpu_ns_total/1e6/frames/bench.instances;
+    result["frame_ms_p50"]=percentile(frame_ms,0.50);
+    result["frame_ms_p99"]=percentile(frame_ms,0.99);
+    return result;
+}
+
+static QJsonObject runCase(const BenchCase &bench,const BenchOptions &options)
+{
+    if(bench.kind.startsWith("soft-"))
+        return runSoftwareCase(bench,options);
+
+    QOpenGLContext *context=QOpenGLContext::currentContext();
+    QOpenGLFunctions *gl=context->functions();
+    //帧缓冲按控件的格式分配：默认与QOpenGLWidget一样是RGBA8加深度模板，低带宽模式去掉深度模板、降低颜色位数
+    const bool depth_stencil=bench.surface==GaugeSurface::Default;
+    QOpenGLFramebufferObject fbo(bench.size,bench.size,
+                                 depth_stencil?QOpenGLFramebufferObject::CombinedDepthStencil:QOpenGLFramebufferObject::NoAttachment,
+                                 GL_TEXTURE_2D,GaugeSurface::textureFormat(bench.surface));
+    const int bytes_per_pixel=GaugeSurface::bytesPerPixel(bench.surface);
+    const qint64 framebuffer_bytes=GaugeMemory::framebufferBytes(fbo.size(),depth_stencil,0,bytes_per_pixel);
+    //合成目标相当于窗口的后备存储，每个实例读一次自己的颜色缓冲、写一次目标
+    QScopedPointer<QOpenGLFramebufferObject> composite_fbo;
+    if(options.composite)
+        composite_fbo.reset(new QOpenGLFramebufferObject(bench.size,bench.size));
+    const qint64 composite_bytes=qint64(bench.size)*bench.size*(bytes_per_pixel+4)*bench.instances;
+
+    //每个实例一个渲染器，相当于一个控件自己的VAO，着色器和顶点走共享缓存
+    QVector<ProgressRenderer*> renderers;
+    for(int i=0;i<bench.instances;i++){
+        ProgressRenderer *renderer=nullptr;
+        if(bench.kind=="wave")
+            renderer=new WaveProgressRenderer;
+        else
+            renderer=new CircleProgressRenderer;
+        renderer->initialize();
+        renderer->setLabelVisible(options.label);
+        renderer->setQuality(parseQuality(bench.quality));
+        renderer->setGpuEasingEnabled(options.gpuEasing);
+        renderer->setMeshGeometryEnabled(bench.mesh);
+        renderers.append(renderer);
+    }
+    //共享内存数据源，与控件绑定时一样每帧每实例取一次
+    QVector<SharedMemorySource*> sources;
+    QVector<float> fed_progress(bench.instances,0.45f);
+    if(bench.animated&&!options.feedKey.isEmpty()){
+        for(int i=0;i<bench.instances;i++)
+            sources.append(new SharedMemorySource(options.feedKey,i));
+    }
+    //第一帧测量帧用遮挡查询统计写入的采样数，即片元着色器的执行次数（含文字）
+    QOpenGLExtraFunctions *extra=context->extraFunctions();
+    GLuint samples_query=0;
+    extra->glGenQueries(1,&samples_query);
+    GLuint samples_passed=0;
+    qint64 sample_ns_total=0;
+    qint64 samples_total=0;
+    qint64 fresh_total=0;
+
+    QVector<double> frame_ms;
+    frame_ms.reserve(options.frames);
+    qint64 cpu_ns_total=0;
+    QElapsedTimer total_timer;
+    for(int frame=-options.warmup;frame<options.frames;frame++)
+    {
+        if(frame==0)
+            total_timer.start();
+        //静态时进度和时间不变，动画时每帧变化
+        float progress=0.45f;
+        float time=0;
+        if(bench.animated){
+            progress=float(0.5+0.5*std::sin(frame*0.05));
+            time=float(std::fmod(frame/180.0,1.0));
+        }
+
+        QElapsedTimer frame_timer;
+        frame_timer.start();
+        const qint64 cpu_begin=threadCpuNs();
+        if(!sources.isEmpty()){
+            QElapsedTimer sample_timer;
+            sample_timer.start();
+            int fresh=0;
+            for(int i=0;i<sources.size();i++){
+                double value=0;
+                if(sources[i]->sample(value)){
+                    fed_progress[i]=float(qBound(0.0,value/100.0,1.0));
+                    fresh++;
+                }
+            }
+            if(frame>=0){
+                sample_ns_total+=sample_timer.nsecsElapsed();
+                samples_total+=sources.size();
+                fresh_total+=fresh;
+            }
+        }
+        if(options.gpuEasing){
+            //每2秒（按60fps计）换一个目标，其余帧只更新时间
+            GaugeEasing easing;
+            const int cycle=frame+options.warmup;
+            easing.start=(cycle/120)%2?0.9f:0.1f;
+            easing.end=(cycle/120)%2?0.1f:0.9f;
+            easing.startTime=(cycle/120)*2.0f;
+            if(!bench.animated)
+                easing.jump(0.45f);
+            for(ProgressRenderer *renderer:renderers)
+                renderer->setEasing(easing,cycle/60.0f);
+        }
+        fbo.bind();
+        if(frame==0)
+            extra->glBeginQuery(GL_SAMPLES_PASSED,samples_query);
+        for(int i=0;i<renderers.size();i++){
+            //对应控件的paintGL：着色器绘制+文字
+            renderers[i]->render(bench.size,bench.size,sources.isEmpty()?progress:fed_progress[i],time);
+        }
+        if(frame==0)
+            extra->glEndQuery(GL_SAMPLES_PASSED);
+        if(composite_fbo){
+            for(int i=0;i<renderers.size();i++)
+                QOpenGLFramebufferObject::blitFramebuffer(composite_fbo.data(),&fbo);
+        }
+        const qint64 cpu_ns=threadCpuNs()-cpu_begin;
+        //等待GPU完成，得到完整的帧延迟
+        gl->glFinish();
+        if(frame>=0){
+            cpu_ns_total+=cpu_ns;
+            frame_ms.append(frame_timer.nsecsElapsed()/1e6);
+        }
+    }
+    const double total_ms=total_timer.nsecsElapsed()/1e6;
+    fbo.release();
+    extra->glGetQueryObjectuiv(samples_query,GL_QUERY_RESULT,&samples_passed);
+    extra->glDeleteQueries(1,&samples_query);
+    const int vertices=renderers.isEmpty()?0:renderers.first()->lastVertexCount();
+
+    for(ProgressRenderer *renderer:renderers)
+        renderer->release();
+    qDeleteAll(renderers);
+    const bool fed=!sources.isEmpty()&&sources.first()->isAttached();
+    qDeleteAll(sources);
+
+    std::sort(frame_ms.begin(),frame_ms.end());
+    const double frames=qMax(1,options.frames);
+    QJsonObject result;
+    result["name"]=bench.name();
+    result["kind"]=bench.kind;
+    result["size"]=bench.size;
+    result["instances"]=bench.instances;
+    result["animated"]=bench.animated;
+    result["quality"]=bench.quality;
+    result["label"]=options.label;
+    result["gpu_easing"]=options.gpuEasing;
+    result["geometry"]=bench.mesh?"mesh":"quad";
+    result["vertices_per_instance"]=vertices;
+    result["fragments_per_instance"]=double(samples_passed)/bench.instances;
+    result["surface"]=GaugeSurface::modeName(bench.surface);
+    result["framebuffer_bytes_per_instance"]=framebuffer_bytes;
+    if(options.composite)
+        result["composite_bytes_per_frame"]=composite_bytes;
+    result["fps"]=total_ms>0?frames*1000.0/total_ms:0;
+    result["paint_cpu_ms"]=cpu_ns_total/1e6/frames;
+    result["paint_cpu_ms_per_instance"]=cpu_ns_total/1e6/frames/bench.instances;
+    result["frame_ms_p50"]=percentile(frame_ms,0.50);
+    result["frame_ms_p99"]=percentile(frame_ms,0.99);
+    if(fed){
+        result["feed_sample_ns"]=samples_total>0?double(sample_ns_total)/samples_total:0;
+        result["feed_fresh_ratio"]=samples_total>0?double(fresh_total)/samples_total:0;
+    }
+    return result;
+}
+
+//动画推进：count个仪表同时动画，比较每个仪表一个QVariantAnimation和GaugeAnimator统一推进
+//属性动画按统一定时器的做法逐个setCurrentTime，每个都会发一次valueChanged，与控件的drawValue写入相当
+//只测推进本身，不含绘制；frame_cpu_us为一帧推进全部仪表的CPU时间
+static QJsonObject runAnimationCase(const QString &mode,int count,const BenchOptions &options)
+{
+    QVector<float> values(count,0);
+    QVector<QVariantAnimation*> animations;
+    QVector<int> handles;
+    GaugeAnimator *animator=GaugeAnimator::instance();
+    const qint64 rss_begin=residentBytes();
+    if(mode=="property"){
+        animations.reserve(count);
+        for(int i=0;i<count;i++){
+            QVariantAnimation *animation=new QVariantAnimation;
+            animation->setDuration(2000);
+            animation->setEasingCurve(QEasingCurve::OutQuart);
+            animation->setStartValue(0.0);
+            animation->setEndValue(1.0);
+            float *value=values.data()+i;
+            QObject::connect(animation,&QVariantAnimation::valueChanged,[value](const QVariant &v){
+                *value=v.toFloat();
+            });
+            animations.append(animation);
+        }
+    }else{
+        handles.reserve(count);
+        for(int i=0;i<count;i++){
+            const int handle=animator->add(nullptr);
+            animator->animateTo(handle,1.0f);
+            handles.append(handle);
+        }
+    }
+    const qint64 rss_bytes=residentBytes()-rss_begin;
+
+    //按60fps推进，时长2秒，测量期间动画不会结束
+    const double begin=animator->clock();
+    QVector<double> frame_ms;
+    frame_ms.reserve(options.frames);
+    qint64 cpu_ns_total=0;
+    QElapsedTimer total_timer;
+    for(int frame=-options.warmup;frame<options.frames;frame++)
+    {
+        if(frame==0)
+            total_timer.start();
+        const int step=(frame+options.warmup)%120;
+        QElapsedTimer frame_timer;
+        frame_timer.start();
+        const qint64 cpu_begin=threadCpuNs();
+        if(mode=="property"){
+            for(QVariantAnimation *animation:animations)
+                animation->setCurrentTime(step*1000/60);
+        }else{
+            animator->advance(begin+step/60.0);
+            for(int i=0;i<count;i++)
+                values[i]=animator->value(handles[i]);
+        }
+        const qint64 cpu_ns=threadCpuNs()-cpu_begin;
+        if(frame>=0){
+            cpu_ns_total+=cpu_ns;
+            frame_ms.append(frame_timer.nsecsElapsed()/1e6);
+        }
+    }
+    const double total_ms=total_timer.nsecsElapsed()/1e6;
+    qDeleteAll(animations);
+    for(int handle:handles)
+        animator->remove(handle);
+
+    std::sort(frame_ms.begin(),frame_ms.end());
+    const double frames=qMax(1,options.frames);
+    QJsonObject result;
+    result["name"]=QString("anim-%1/x%2").arg(mode).arg(count);
+    result["kind"]="anim-"+mode;
+    result["instances"]=count;
+    result["fps"]=total_ms>0?frames*1000.0/total_ms:0;
+    result["frame_cpu_us"]=cpu_ns_total/1e3/frames;
+    result["frame_cpu_ns_per_gauge"]=cpu_ns_total/frames/count;
+    result["frame_ms_p50"]=percentile(frame_ms,0.50);
+    result["frame_ms_p99"]=percentile(frame_ms,0.99);
+    //状态数组的大小，属性动画没有可比的精确值
+    if(mode!="property")
+        result["state_bytes_per_gauge"]=GaugeAnimator::bytesPerGauge();
+    if(rss_bytes>=0)
+        result["rss_bytes_per_gauge"]=double(rss_bytes)/count;
+    return result;
+}
+
+//与基准结果比较，返回退化的条目数
+//基准读不了、不是结果JSON或没有一个条目对得上时返回-1，CI上不能当作通过
+static int compareBaseline(const QJsonArray &results,const QString &path,double tolerance)
+{
+    QFile file(path);
+    if(!file.open(QIODevice::ReadOnly)){
+        qWarning()<<"cannot open baseline"<<path;
+        return -1;
+    }
+    QJsonParseError error;
+    const QJsonDocument document=QJsonDocument::fromJson(file.readAll(),&error);
+    if(error.error!=QJsonParseError::NoError||!document.object().value("results").isArray()){
+        qWarning()<<"invalid baseline"<<path<<error.errorString();
+        return -1;
+    }
+    const QJsonArray baseline=document.object().value("results").toArray();
+    QHash<QString,double> baseline_fps;
+    for(const QJsonValue &value:baseline)
+        baseline_fps.insert(value.toObject().value("name").toString(),
+                            value.toObject().value("fps").toDouble());
+
+    int regressions=0;
+    int matched=0;
+    QTextStream err(stderr);
+    for(const QJsonValue &value:results){
+        const QJsonObject result=value.toObject();
+        const QString name=result.value("name").toString();
+        if(!baseline_fps.contains(name))
+            continue;
+        matched++;
+        const double old_fps=baseline_fps.value(name);
+        const double new_fps=result.value("fps").toDouble();
+        if(new_fps<old_fps*(1.0-tolerance)){
+            err<<"regression "<<name<<": "<<old_fps<<" -> "<<new_fps<<" fps\n";
+            regressions++;
+        }
+    }
+    if(matched==0){
+        qWarning()<<"no case in"<<path<<"matches this run";
+        return -1;
+    }
+    return regressions;
+}
+
+int main(int argc, char *argv[])
+{
+    //默认走离屏平台，便于在CI上运行
+    if(qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM","offscreen");
+    QCoreApplication::setAttribute(Qt::AA_UseDesktopOpenGL);
+    QGuiApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Offscreen benchmark for CircleProgressBar/WaveProgressBar");
+    parser.addHelpOption();
+    QCommandLineOption sizes_option("sizes","Comma separated FBO sizes.","list","64,128,256,512,1024,2048");
+    QCommandLineOption counts_option("counts","Comma separated instance counts.","list","1,16");
+    QCommandLineOption kinds_option("kinds","Comma separated gauge kinds (circle,wave,soft-circle,soft-wave).","list","circle,wave");
+    QCommandLineOption qualities_option("qualities","Comma separated shader tiers (high,medium,low).","list","high,medium,low");
+    QCommandLineOption frames_option("frames","Measured frames per case.","n","60");
+    QCommandLineOption warmup_option("warmup","Warm-up frames per case.","n","5");
+    QCommandLineOption no_label_option("no-label","Skip the percentage label.");
+    QCommandLineOption output_option("output","Write JSON to file instead of stdout.","file");
+    QCommandLineOption baseline_option("baseline","Compare fps with a previous JSON result.","file");
+    QCommandLineOption tolerance_option("tolerance","Allowed fps drop against baseline.","ratio","0.1");
+    QCommandLineOption gpu_easing_option("gpu-easing","Evaluate the value animation in the shader (GaugeEasing).");
+    QCommandLineOption animations_option("animations","Comma separated gauge counts for the animation update benchmark (QVariantAnimation vs GaugeAnimator).","list");
+    QCommandLineOption geometry_option("geometry","Comma separated gauge geometry (quad,mesh).","list","quad");
+    QCommandLineOption surfaces_option("surfaces","Comma separated framebuffer formats (default,low,low16).","list","default");
+    QCommandLineOption composite_option("composite","Blit every instance into an RGBA8 target each frame, like the backing store compositing the widgets.");
+    QCommandLineOption feed_option("feed","Drive animated cases from a shared gauge region (see tools/GaugeFeedWriter).","key");
+    parser.addOptions({sizes_option,counts_option,kinds_option,qualities_option,frames_option,warmup_option,
+                       no_label_option,output_option,baseline_option,tolerance_option,gpu_easing_option,animations_option,geometry_option,surfaces_option,composite_option,feed_option});
+    parser.process(app);
+
+    BenchOptions options;
+    options.frames=qMax(1,parser.value(frames_option).toInt());
+    options.warmup=qMax(0,parser.value(warmup_option).toInt());
+    options.label=!parser.isSet(no_label_option);
+    options.feedKey=parser.value(feed_option);
+    options.gpuEasing=parser.isSet(gpu_easing_option);
+    options.composite=parser.isSet(composite_option);
+
+    QSurfaceFormat format;
+    format.setRenderableType(QSurfaceFormat::OpenGL);
+    format.setMajorVersion(3);
+    format.setMinorVersion(3);
+    format.setProfile(QSurfaceFormat::CoreProfile);
+
+    QJsonArray results;
+    const QVector<int> sizes=parseIntList(parser.value(sizes_option));
+    const QVector<int> counts=parseIntList(parser.value(counts_option));
+    //只给--animations时不跑绘制
+    QStringList kinds=parser.value(kinds_option).split(',',skip_empty_parts);
+    if(parser.isSet(animations_option)&&!parser.isSet(kinds_option))
+        kinds.clear();
+    //只测CPU光栅化时不需要GL上下文，没有3.3的机器上也能跑
+    bool need_gl=false;
+    for(const QString &kind:kinds)
+        need_gl|=!kind.trimmed().startsWith("soft-");
+
+    QOffscreenSurface surface;
+    surface.setFormat(format);
+    surface.create();
+    QOpenGLContext context;
+    context.setFormat(format);
+    QOpenGLFunctions *gl=nullptr;
+    if(need_gl){
+        if(!context.create()||!context.makeCurrent(&surface)){
+            qCritical()<<"failed to create OpenGL 3.3 core context";
+            return 1;
+        }
+        gl=context.functions();
+    }
+
+    const QStringList qualities=parser.value(qualities_option).split(',',skip_empty_parts);
+    const QStringList geometries=parser.value(geometry_option).split(',',skip_empty_parts);
+    QVector<GaugeSurface::Mode> surfaces;
+    for(const QString &name:parser.value(surfaces_option).split(',',skip_empty_parts)){
+        bool ok=false;
+        const GaugeSurface::Mode mode=GaugeSurface::parseMode(name,&ok);
+        if(ok)
+            surfaces.append(mode);
+        else
+            qWarning()<<"unknown surface"<<name;
+    }
+    for(const QString &kind:kinds){
+        for(const QString &quality:qualities){
+            for(int size:sizes){
+                for(int count:counts){
+                    for(bool animated:{false,true}){
+                        for(const QString &geometry:geometries){
+                            for(GaugeSurface::Mode surface:surfaces){
+                                BenchCase bench;
+                                bench.kind=kind.trimmed();
+                                bench.size=size;
+                                bench.instances=count;
+                                bench.animated=animated;
+                                bench.quality=quality.trimmed();
+                                bench.mesh=geometry.trimmed()=="mesh";
+                                bench.surface=surface;
+                                //CPU光栅化没有网格模式，也不用GL帧缓冲
+                                if((bench.mesh||surface!=GaugeSurface::Default)&&bench.kind.startsWith("soft-"))
+                                    continue;
+                                const QJsonObject result=runCase(bench,options);
+                                qInfo().noquote()<<bench.name()<<"fps"<<result.value("fps").toDouble();
+                                results.append(result);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    for(int count:parseIntList(parser.value(animations_option))){
+        for(const char *mode:{"property","shared"}){
+            const QJsonObject result=runAnimationCase(QString::fromLatin1(mode),count,options);
+            qInfo().noquote()<<result.value("name").toString()<<"cpu us/frame"<<result.value("frame_cpu_us").toDouble();
+            results.append(result);
+        }
+    }
+
+    QJsonObject root;
+    if(gl){
+        root["gl_vendor"]=QString::fromLatin1(reinterpret_cast<const char*>(gl->glGetString(GL_VENDOR)));
+        root["gl_renderer"]=QString::fromLatin1(reinterpret_cast<const char*>(gl->glGetString(GL_RENDERER)));
+        root["gl_version"]=QString::fromLatin1(reinterpret_cast<const char*>(gl->glGetString(GL_VERSION)));
+    }
+    root["frames"]=options.frames;
+    root["software_simd"]=SoftwareRasterizer::instructionSet();
+    root["cache_hits"]=GLResourceCache::instance()->hitCount();
+    root["cache_misses"]=GLResourceCache::instance()->missCount();
+    root["results"]=results;
+    const QByteArray json=QJsonDocument(root).toJson();
+    if(gl)
+        context.doneCurrent();
+
+    if(parser.isSet(output_option)){
+        QFile file(parser.value(output_option));
+        if(!file.open(QIODevice::WriteOnly)){
+            qCritical()<<"cannot write"<<file.fileName();
+            return 1;
+        }
+        file.write(json);
+    }else{
+        QTextStream(stdout)<<json;
+    }
+
+    if(parser.isSet(baseline_option)){
+        const int regressions=compareBaseline(results,parser.value(baseline_option),
+                                              parser.value(tolerance_option).toDouble());
+        if(regressions<0)
+            return 3;
+        if(regressions>0)
+            return 2;
+    }
+    return 0;
+}
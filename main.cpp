@@ -1,98 +1,67 @@
 #include "mainwindow.h"
+#include "GaugeBackend.h"
+#include "GLCapabilities.h"
+#include "GaugeWarmup.h"
 
 #include <QApplication>
 #include <QSurfaceFormat>
-#include <QOpenGLWindow>
-#include <QOpenGLContext>
-#include <QOpenGLFunctions>
-#include <QOffscreenSurface>
-#include <QScreen>
 #include <QDebug>
 
-//解析字符串中的opengl版本号
-bool parseOpenGLVersion(const QByteArray &versionString, int &major, int &minor)
+//探测GL能力选择后端，GL后端时在工作线程预编译着色器
+static void initOpenGL(GaugeWarmup &warmup)
 {
-    bool majorOk = false;
-    bool minorOk = false;
-    QList<QByteArray> parts = versionString.split(' ');
-    if (versionString.startsWith(QByteArrayLiteral("OpenGL ES"))) {
-        if (parts.size() >= 3) {
-            QList<QByteArray> versionParts = parts.at(2).split('.');
-            if (versionParts.size() >= 2) {
-                major = versionParts.at(0).toInt(&majorOk);
-                minor = versionParts.at(1).toInt(&minorOk);
-                // Nexus 6 has "OpenGL ES 3.0V@95.0 (GIT@I86da836d38)"
-                if (!minorOk)
-                    if (int idx = versionParts.at(1).indexOf('V'))
-                        minor = versionParts.at(1).left(idx).toInt(&minorOk);
-            } else {
-                qWarning("Unrecognized OpenGL ES version");
-            }
-        } else {
-            // If < 3 parts to the name, it is an unrecognised OpenGL ES
-            qWarning("Unrecognised OpenGL ES version");
-        }
-    } else {
-        // Not OpenGL ES, but regular OpenGL, the version numbers are first in the string
-        QList<QByteArray> versionParts = parts.at(0).split('.');
-        if (versionParts.size() >= 2) {
-            major = versionParts.at(0).toInt(&majorOk);
-            minor = versionParts.at(1).toInt(&minorOk);
-        } else {
-            qWarning("Unrecognized OpenGL version");
-        }
-    }
+    //GL能力有磁盘缓存，只有第一次运行或环境变化时才创建临时上下文探测
+    const GLCapabilities caps=GLCapabilities::load();
+    qDebug()<<"OpenGL:"<<caps.vendor<<caps.renderer<<caps.version
+           <<(caps.fromCache?"(cached)":"(probed)");
+    qDebug() << "version:" << caps.majorVersion << caps.minorVersion;
+    //不到3.3时控件改用CPU绘制，CPU实现的GL用低档着色器
+    GaugeBackend::setBackend(caps.backend());
+    GaugeShaders::setDefaultQuality(caps.quality());
+
+    if(caps.majorVersion*10+caps.minorVersion<33)
+        qDebug()<<"The version of OpenGL is too old";
 
-    if (!majorOk || !minorOk)
-        qWarning("Unrecognized OpenGL version");
-    return (majorOk && minorOk);
+    //着色器在工作线程预编译，第一次切换到各页时不再卡顿
+    if(GaugeBackend::isSoftware()){
+        qDebug()<<"Use software rasterizer";
+    }else{
+        QObject::connect(&warmup,&GaugeWarmup::finished,[](int programs,qint64 ms){
+            qDebug()<<"Shader warm-up:"<<programs<<"programs in"<<ms<<"ms off the GUI thread";
+        });
+        warmup.start();
+    }
 }
 
 int main(int argc, char *argv[])
 {
     QCoreApplication::setAttribute(Qt::AA_UseDesktopOpenGL);
+    //所有窗口的上下文放到一个共享组，着色器程序和顶点缓冲全进程只需一份
+    QCoreApplication::setAttribute(Qt::AA_ShareOpenGLContexts);
 #if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
     QCoreApplication::setAttribute(Qt::AA_EnableHighDpiScaling);
 #endif
+    //默认指定为3.3版本，全局共享上下文在QApplication构造时按默认格式创建，要在这之前设置
+    //驱动不支持时Qt会退回到能创建的版本，这时下面会选择CPU绘制，不会用到GL控件
+    QSurfaceFormat format = QSurfaceFormat::defaultFormat();
+    //qDebug() <<"deault format:"<< format;
+    format.setRenderableType(QSurfaceFormat::OpenGL);
+    format.setMajorVersion(3);
+    format.setMinorVersion(3);
+    format.setProfile(QSurfaceFormat::CoreProfile);
+    QSurfaceFormat::setDefaultFormat(format);
+    //qDebug() <<"current format"<< format;
 
     QApplication app(argc, argv);
-    int major=0;
-    int minor=0;
-    //一般需要先构造一个QGuiApplication有些函数才能调用
-    QScreen *screen=app.primaryScreen();
-    if(screen){
-        QOffscreenSurface surface(screen);
-        surface.create();
-        QOpenGLContext context;
-        context.create();
-        context.makeCurrent(&surface);
-
-        const GLubyte *glstr=context.functions()->glGetString(GL_VERSION);
-        if(glstr){
-            QByteArray bytestr= QByteArray(reinterpret_cast<const char*>(glstr));
-            qDebug()<<"glGetString"<<bytestr;
-            if(!parseOpenGLVersion(bytestr,major,minor)){
-                major=0;
-                minor=0;
-            }
-        }
-        context.doneCurrent();
-        surface.destroy();
-    }
-    qDebug() << "version:" << major << minor;
-
-    //默认指定为3.3版本
-    if(major*10+minor>=33){
-        QSurfaceFormat format = QSurfaceFormat::defaultFormat();
-        //qDebug() <<"deault format:"<< format;
-        format.setRenderableType(QSurfaceFormat::OpenGL);
-        format.setMajorVersion(3);
-        format.setMinorVersion(3);
-        format.setProfile(QSurfaceFormat::CoreProfile);
-        QSurfaceFormat::setDefaultFormat(format);
-        //qDebug() <<"current format"<< format;
+    GaugeWarmup warmup;
+    if(GaugeBackend::rhiRequested()){
+        //QRhi后端的着色器在构建时编译，不创建GL上下文探测，也没有GLSL要预编译
+        GaugeBackend::setBackend(GaugeBackend::RhiBackend);
+        qDebug()<<"Use QRhi backend:"<<qgetenv("GAUGE_RHI_API");
     }else{
-        qDebug()<<"The version of OpenGL is too old";
+        if(qEnvironmentVariableIsSet("GAUGE_RHI_API"))
+            qDebug()<<"GAUGE_RHI_API is ignored, the QRhi backend needs Qt 6.7 and Qt Shader Tools";
+        initOpenGL(warmup);
     }
 
     MainWindow w;
@@ -1,5 +1,14 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
+#include "GaugeBackend.h"
+#include "GLCapabilities.h"
+#include "SoftwareProgressBar.h"
+#ifdef GAUGE_RHI
+#include "GaugeRhiWidget.h"
+#endif
+
+#include <QRandomGenerator>
+#include <QtMath>
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
@@ -7,8 +16,18 @@ MainWindow::MainWindow(QWidget *parent)
 {
     ui->setupUi(this);
 
+    if(GaugeBackend::isSoftware()){
+        initSoftware();
+    }else if(GaugeBackend::backend()==GaugeBackend::RhiBackend){
+        initRhi();
+    }else if(GLCapabilities::current().softwareRasterizer){
+        //CPU实现的GL合成控件也在CPU上做，按像素算的带宽最明显
+        ui->glCirlcleProgress->setSurfaceMode(GaugeSurface::LowBandwidth);
+        ui->glWaveProgress->setSurfaceMode(GaugeSurface::LowBandwidth);
+    }
     initTabA();
     initTabB();
+    initTabC();
 }
 
 MainWindow::~MainWindow()
@@ -20,10 +39,10 @@ void MainWindow::initTabA()
 {
     //默认百分之45
     ui->boxCircleValue->setValue(45);
-    ui->glCirlcleProgress->setValue(45);
+    setCircleValue(45);
     //调节进度
     connect(ui->btnCircleSet,&QPushButton::clicked,this,[=]{
-        ui->glCirlcleProgress->setValue(ui->boxCircleValue->value());
+        setCircleValue(ui->boxCircleValue->value());
     });
 }
 
@@ -31,10 +50,107 @@ void MainWindow::initTabB()
 {
     //默认百分之45
     ui->boxWaveValue->setValue(45);
-    ui->glWaveProgress->setValue(45);
+    setWaveValue(45);
     //调节进度
     connect(ui->btnWaveSet,&QPushButton::clicked,this,[=]{
-        ui->glWaveProgress->setValue(ui->boxWaveValue->value());
+        setWaveValue(ui->boxWaveValue->value());
+    });
+}
+
+void MainWindow::initSoftware()
+{
+    //GL控件不显示就不会创建上下文，替换出布局后隐藏即可
+    softCircle=new SoftwareProgressBar(SoftwareProgressBar::CircleGauge,ui->tabA);
+    ui->tabA->layout()->replaceWidget(ui->glCirlcleProgress,softCircle);
+    ui->glCirlcleProgress->hide();
+
+    softWave=new SoftwareProgressBar(SoftwareProgressBar::WaveGauge,ui->tabB);
+    ui->tabB->layout()->replaceWidget(ui->glWaveProgress,softWave);
+    ui->glWaveProgress->hide();
+
+    //画布依赖实例化绘制，没有软件版本
+    ui->tabWidget->setTabEnabled(ui->tabWidget->indexOf(ui->tabC),false);
+}
+
+void MainWindow::initRhi()
+{
+#ifdef GAUGE_RHI
+    //与软件后端相同，替换出布局后隐藏GL控件
+    rhiCircle=new GaugeRhiWidget(GaugeRhiRenderer::CircleGauge,ui->tabA);
+    ui->tabA->layout()->replaceWidget(ui->glCirlcleProgress,rhiCircle);
+    ui->glCirlcleProgress->hide();
+
+    rhiWave=new GaugeRhiWidget(GaugeRhiRenderer::WaveGauge,ui->tabB);
+    ui->tabB->layout()->replaceWidget(ui->glWaveProgress,rhiWave);
+    ui->glWaveProgress->hide();
+
+    //画布只有GL版本，打开会编译GLSL
+    ui->tabWidget->setTabEnabled(ui->tabWidget->indexOf(ui->tabC),false);
+#endif
+}
+
+void MainWindow::setCircleValue(double value)
+{
+#ifdef GAUGE_RHI
+    if(rhiCircle){
+        rhiCircle->setValue(value);
+        return;
+    }
+#endif
+    if(softCircle)
+        softCircle->setValue(value);
+    else
+        ui->glCirlcleProgress->setValue(value);
+}
+
+void MainWindow::setWaveValue(double value)
+{
+#ifdef GAUGE_RHI
+    if(rhiWave){
+        rhiWave->setValue(value);
+        return;
+    }
+#endif
+    if(softWave)
+        softWave->setValue(value);
+    else
+        ui->glWaveProgress->setValue(value);
+}
+
+void MainWindow::initTabC()
+{
+    //默认300个仪表
+    ui->boxCanvasCount->setValue(300);
+    //画布显示后才有确定的尺寸，第一次切换过去时再排列
+    connect(ui->tabWidget,&QTabWidget::currentChanged,this,[=](int index){
+        if(ui->tabWidget->widget(index)==ui->tabC&&ui->glCanvas->gaugeCount()==0)
+            resetCanvas(ui->boxCanvasCount->value());
+    });
+    //调节数量，同时刷新一次随机进度
+    connect(ui->btnCanvasSet,&QPushButton::clicked,this,[=]{
+        resetCanvas(ui->boxCanvasCount->value());
     });
 }
 
+void MainWindow::resetCanvas(int count)
+{
+    GaugeCanvas *canvas=ui->glCanvas;
+    canvas->clearGauges();
+    if(count<=0)
+        return;
+    //按画布宽高比算列数，使格子接近正方形
+    const double ratio=canvas->width()/double(qMax(1,canvas->height()));
+    const int cols=qMax(1,qCeil(qSqrt(count*ratio)));
+    const int rows=qCeil(count/double(cols));
+    const double cell_w=canvas->width()/double(cols);
+    const double cell_h=canvas->height()/double(rows);
+    QRandomGenerator *random=QRandomGenerator::global();
+    for(int i=0;i<count;i++)
+    {
+        const QRectF rect((i%cols)*cell_w,(i/cols)*cell_h,cell_w,cell_h);
+        const GaugeCanvas::GaugeType type=(i%2)?GaugeCanvas::WaveGauge:GaugeCanvas::CircleGauge;
+        const int id=canvas->addGauge(type,rect.adjusted(2,2,-2,-2));
+        canvas->setGaugeValue(id,random->bounded(1.0));
+        canvas->setGaugeTime(id,random->bounded(1.0));
+    }
+}
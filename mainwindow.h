@@ -1,6 +1,9 @@
 #pragma once
 #include <QMainWindow>
 
+class SoftwareProgressBar;
+class GaugeRhiWidget;
+
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
 QT_END_NAMESPACE
@@ -16,7 +19,25 @@ public:
     void initTabA();
     //b 波浪进度球
     void initTabB();
+    //OpenGL不够时把a、b换成CPU绘制的进度条，c不可用
+    void initSoftware();
+    //QRhi后端时把a、b换成GaugeRhiWidget，c不可用
+    void initRhi();
+    //a 环形进度条
+    void setCircleValue(double value);
+    //b 波浪进度球
+    void setWaveValue(double value);
+    //c 多仪表画布
+    void initTabC();
+    //按画布当前大小网格排列count个仪表
+    void resetCanvas(int count);
 
 private:
     Ui::MainWindow *ui;
+    //软件后端的进度条，OpenGL后端时为空
+    SoftwareProgressBar *softCircle{ nullptr };
+    SoftwareProgressBar *softWave{ nullptr };
+    //QRhi后端的进度条，未启用时为空
+    GaugeRhiWidget *rhiCircle{ nullptr };
+    GaugeRhiWidget *rhiWave{ nullptr };
 };
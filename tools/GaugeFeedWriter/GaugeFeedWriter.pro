@@ -0,0 +1,18 @@
+QT += core
+QT -= gui
+
+CONFIG += c++11 utf8_source console
+CONFIG -= app_bundle
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+TARGET = GaugeFeedWriter
+
+SOURCES += \
+    main.cpp \
+    $$PWD/../../OpenGL2D/SharedGaugeMemory.cpp
+
+HEADERS += \
+    $$PWD/../../OpenGL2D/SharedGaugeMemory.h
+
+INCLUDEPATH += $$PWD/../../OpenGL2D
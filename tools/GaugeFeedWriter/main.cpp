@@ -0,0 +1,92 @@
+//共享内存进度值的测试写入进程，模拟采集程序
+//按固定频率向每个槽写入波形，配合SharedMemorySource和GaugeBenchmark --feed使用
+//例：./GaugeFeedWriter --key gauges --slots 16 --rate 1000 --pattern sine
+#include "SharedGaugeMemory.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QDateTime>
+#include <QThread>
+#include <QDebug>
+
+#include <cmath>
+#include <csignal>
+
+static volatile std::sig_atomic_t stop_requested=0;
+
+static void requestStop(int)
+{
+    stop_requested=1;
+}
+
+//第slot个槽在t秒时的值，范围[0,100]，每个槽相位错开
+static double patternValue(const QString &pattern,int slot,double t)
+{
+    const double phase=t+slot*0.37;
+    if(pattern=="ramp")
+        return std::fmod(phase*20.0,100.0);
+    if(pattern=="step")
+        return std::fmod(std::floor(phase)*10.0,100.0);
+    return 50.0+50.0*std::sin(phase*2.0);
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Writes test values into a shared gauge region");
+    parser.addHelpOption();
+    QCommandLineOption key_option("key","Shared memory key.","key","EasyOpenGL2D.gauges");
+    QCommandLineOption slots_option("slots","Number of slots.","n","16");
+    QCommandLineOption rate_option("rate","Writes per second for every slot, 0 writes as fast as possible.","hz","1000");
+    QCommandLineOption duration_option("duration","Seconds to run, 0 runs until interrupted.","s","0");
+    QCommandLineOption pattern_option("pattern","Waveform (sine,ramp,step).","name","sine");
+    parser.addOptions({key_option,slots_option,rate_option,duration_option,pattern_option});
+    parser.process(app);
+
+    const int slot_count=qMax(1,parser.value(slots_option).toInt());
+    const double rate=qMax(0.0,parser.value(rate_option).toDouble());
+    const double duration=qMax(0.0,parser.value(duration_option).toDouble());
+    const QString pattern=parser.value(pattern_option);
+
+    SharedGaugeMemory memory(parser.value(key_option));
+    if(!memory.create(slot_count)){
+        qCritical().noquote()<<"cannot create shared memory:"<<memory.errorString();
+        return 1;
+    }
+    std::signal(SIGINT,requestStop);
+    std::signal(SIGTERM,requestStop);
+    qInfo().noquote()<<"writing"<<slot_count<<"slots to"<<memory.key()<<"at"<<rate<<"Hz";
+
+    QElapsedTimer clock;
+    clock.start();
+    const qint64 interval_ns=rate>0?qint64(1e9/rate):0;
+    qint64 next_ns=0;
+    quint64 writes=0;
+    while(!stop_requested)
+    {
+        const qint64 now_ns=clock.nsecsElapsed();
+        const double t=now_ns/1e9;
+        if(duration>0&&t>=duration)
+            break;
+        const qint64 stamp=QDateTime::currentMSecsSinceEpoch();
+        for(int slot=0;slot<slot_count;slot++)
+            memory.write(slot,patternValue(pattern,slot,t),stamp);
+        writes++;
+        if(interval_ns>0){
+            //按绝对时刻排下一次，睡眠误差不累积
+            next_ns+=interval_ns;
+            const qint64 wait_ns=next_ns-clock.nsecsElapsed();
+            if(wait_ns>0)
+                QThread::usleep(quint64(wait_ns/1000));
+            else if(wait_ns<-interval_ns*10)
+                next_ns=clock.nsecsElapsed();
+        }
+    }
+    const double seconds=clock.nsecsElapsed()/1e9;
+    qInfo().noquote()<<"wrote"<<writes<<"rounds in"<<seconds<<"s,"
+                    <<(seconds>0?writes/seconds:0)<<"rounds/s";
+    return 0;
+}
@@ -0,0 +1,17 @@
+QT += core gui widgets quick
+
+CONFIG += c++11 utf8_source
+CONFIG -= app_bundle
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+TARGET = GaugeQuick
+
+SOURCES += \
+    main.cpp
+
+RESOURCES += \
+    GaugeQuick.qrc
+
+INCLUDEPATH += $$PWD/../../OpenGL2D
+include($$PWD/../../OpenGL2D/OpenGL2D.pri)
@@ -0,0 +1,58 @@
+//QML中的仪表：网格里放--count个GaugeItem，每秒输出一次帧率
+//同类仪表在场景图中合批，QSG_RENDERER_DEBUG=render可以看到批次数
+//例：QSG_RENDERER_DEBUG=render ./GaugeQuick --count 400
+#include "GaugeQuickItem.h"
+
+#include <QGuiApplication>
+#include <QCommandLineParser>
+#include <QSurfaceFormat>
+#include <QQuickView>
+#include <QQmlContext>
+#include <QElapsedTimer>
+#include <QDebug>
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication::setAttribute(Qt::AA_EnableHighDpiScaling);
+    //着色器是#version 330 core，场景图的上下文按默认格式创建
+    QSurfaceFormat format=QSurfaceFormat::defaultFormat();
+    format.setRenderableType(QSurfaceFormat::OpenGL);
+    format.setMajorVersion(3);
+    format.setMinorVersion(3);
+    format.setProfile(QSurfaceFormat::CoreProfile);
+    QSurfaceFormat::setDefaultFormat(format);
+    QGuiApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("CircleProgressBar/WaveProgressBar as Qt Quick scene graph nodes");
+    parser.addHelpOption();
+    QCommandLineOption count_option("count","Number of gauges.","n","300");
+    QCommandLineOption no_label_option("no-label","Skip the percentage labels.");
+    parser.addOptions({count_option,no_label_option});
+    parser.process(app);
+
+    GaugeQuickItem::registerQmlTypes();
+    QQuickView view;
+    view.rootContext()->setContextProperty("gaugeCount",qMax(1,parser.value(count_option).toInt()));
+    view.rootContext()->setContextProperty("labelVisible",!parser.isSet(no_label_option));
+    view.setResizeMode(QQuickView::SizeRootObjectToView);
+    view.setSource(QUrl("qrc:/main.qml"));
+    if(view.status()!=QQuickView::Ready)
+        return 1;
+
+    //frameSwapped在渲染线程发出，排队到GUI线程计数
+    int frames=0;
+    QElapsedTimer timer;
+    timer.start();
+    QObject::connect(&view,&QQuickWindow::frameSwapped,&view,[&]{
+        frames++;
+        if(timer.elapsed()>=1000){
+            qInfo().noquote()<<QString("%1 fps").arg(frames*1000.0/timer.elapsed(),0,'f',1);
+            frames=0;
+            timer.restart();
+        }
+    },Qt::QueuedConnection);
+    view.resize(1280,800);
+    view.show();
+    return app.exec();
+}
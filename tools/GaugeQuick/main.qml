@@ -0,0 +1,51 @@
+import QtQuick 2.9
+import EasyOpenGL2D 1.0
+
+Rectangle {
+    id: root
+    color: "black"
+
+    readonly property int columns: Math.ceil(Math.sqrt(gaugeCount*width/Math.max(height,1)))
+    readonly property real cell: width/Math.max(columns,1)
+
+    //每两秒换一批目标值，进度动画与控件一样2秒OutQuart
+    Timer {
+        id: retarget
+        property int round: 0
+        interval: 2000
+        repeat: true
+        running: true
+        onTriggered: round++
+    }
+
+    //仪表和文字分两层，同类仪表之间没有其他节点，合批不会被打断
+    Repeater {
+        id: gauges
+        model: gaugeCount
+        GaugeItem {
+            x: (index%root.columns)*root.cell
+            y: Math.floor(index/root.columns)*root.cell
+            width: root.cell
+            height: root.cell
+            type: index%2 ? GaugeItem.WaveGauge : GaugeItem.CircleGauge
+            phase: (index*0.618)%1
+            value: ((index+1)*37+retarget.round*53)%100
+            Behavior on value { NumberAnimation { duration: 2000; easing.type: Easing.OutQuart } }
+        }
+    }
+    Repeater {
+        model: labelVisible ? gaugeCount : 0
+        Text {
+            readonly property Item gauge: gauges.itemAt(index)
+            x: gauge ? gauge.x : 0
+            y: gauge ? gauge.y : 0
+            width: root.cell
+            height: root.cell
+            horizontalAlignment: Text.AlignHCenter
+            verticalAlignment: Text.AlignVCenter
+            color: "white"
+            font.pixelSize: Math.max(6,root.cell/8)
+            text: gauge ? gauge.value.toFixed(2)+" %" : ""
+        }
+    }
+}
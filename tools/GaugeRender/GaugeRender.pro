@@ -0,0 +1,14 @@
+QT += core gui widgets
+
+CONFIG += c++11 utf8_source console
+CONFIG -= app_bundle
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+TARGET = GaugeRender
+
+SOURCES += \
+    main.cpp
+
+INCLUDEPATH += $$PWD/../../OpenGL2D
+include($$PWD/../../OpenGL2D/OpenGL2D.pri)
@@ -0,0 +1,363 @@
+//批量离屏渲染进度条图片，给网页报表用
+//每行一个仪表：name,value[,kind[,size]]，kind/size省略时取--kind/--size，#开头的行跳过
+//每个渲染线程一个独立的上下文和FBO，读回的图片交给编码线程压缩写盘，渲染不等PNG编码
+//例：QT_QPA_PLATFORM=offscreen LIBGL_ALWAYS_SOFTWARE=1 ./GaugeRender --input values.csv --output out --threads 4
+//    printf "cpu,42\nmem,87,wave\n" | ./GaugeRender --output out
+#include "CircleProgressRenderer.h"
+#include "WaveProgressRenderer.h"
+
+#include <QGuiApplication>
+#include <QCommandLineParser>
+#include <QSurfaceFormat>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QOpenGLFramebufferObject>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QAtomicInteger>
+#include <QQueue>
+#include <QFile>
+#include <QDir>
+#include <QTextStream>
+#include <QImage>
+#include <QDebug>
+
+#include <memory>
+
+//一张图的参数
+struct RenderJob
+{
+    QString name;
+    QString kind;
+    int size{ 256 };
+    float progress{ 0 };
+};
+
+//渲染完等待编码的图片
+struct EncodeJob
+{
+    QString path;
+    QImage image;
+};
+
+//有界的阻塞队列，满时生产者等待，限制排队图片占用的内存
+template<typename T>
+class BlockingQueue
+{
+public:
+    explicit BlockingQueue(int capacity) : capacity(capacity) {}
+
+    void push(const T &item) {
+        QMutexLocker locker(&mutex);
+        while(queue.size()>=capacity)
+            notFull.wait(&mutex);
+        queue.enqueue(item);
+        notEmpty.wakeOne();
+    }
+    //队列已关闭且取空时返回false
+    bool pop(T &item) {
+        QMutexLocker locker(&mutex);
+        while(queue.isEmpty()&&!closed)
+            notEmpty.wait(&mutex);
+        if(queue.isEmpty())
+            return false;
+        item=queue.dequeue();
+        notFull.wakeOne();
+        return true;
+    }
+    //不再有新数据，唤醒所有等待的消费者
+    void close() {
+        QMutexLocker locker(&mutex);
+        closed=true;
+        notEmpty.wakeAll();
+    }
+
+private:
+    const int capacity;
+    QQueue<T> queue;
+    bool closed{ false };
+    QMutex mutex;
+    QWaitCondition notEmpty;
+    QWaitCondition notFull;
+};
+
+//全局选项
+struct RenderOptions
+{
+    QString outputDir;
+    double minValue{ 0 };
+    double maxValue{ 100 };
+    float time{ 0 };     //波浪的相位[0,1)
+    bool label{ true };
+    GaugeShaders::Quality quality{ GaugeShaders::QualityHigh };
+    int compression{ -1 }; //QImage::save的quality参数，PNG时越小压缩越强
+};
+
+//统计
+static QAtomicInteger<qint64> rendered_count{ 0 };
+static QAtomicInteger<qint64> encoded_count{ 0 };
+static QAtomicInteger<qint64> failed_count{ 0 };
+static QAtomicInteger<qint64> render_ns_total{ 0 };
+static QAtomicInteger<qint64> encode_ns_total{ 0 };
+
+static GaugeShaders::Quality parseQuality(const QString &text)
+{
+    if(text=="low")
+        return GaugeShaders::QualityLow;
+    if(text=="medium")
+        return GaugeShaders::QualityMedium;
+    return GaugeShaders::QualityHigh;
+}
+
+//解析一行输入，格式错误时返回false
+static bool parseLine(const QString &line,const RenderOptions &options,const QString &defaultKind,int defaultSize,RenderJob &job)
+{
+    const QStringList fields=line.split(',');
+    if(fields.size()<2)
+        return false;
+    job.name=fields.at(0).trimmed();
+    bool ok=false;
+    const double value=fields.at(1).trimmed().toDouble(&ok);
+    //名字用作文件名，不允许跳出输出目录
+    if(!ok||job.name.isEmpty()||job.name.contains('/')||job.name.contains('\\')||job.name.startsWith('.'))
+        return false;
+    job.kind=fields.size()>2&&!fields.at(2).trimmed().isEmpty()?fields.at(2).trimmed():defaultKind;
+    if(job.kind!="circle"&&job.kind!="wave")
+        return false;
+    job.size=defaultSize;
+    if(fields.size()>3&&!fields.at(3).trimmed().isEmpty()){
+        job.size=fields.at(3).trimmed().toInt(&ok);
+        if(!ok||job.size<=0||job.size>8192)
+            return false;
+    }
+    const double range=options.maxValue-options.minValue;
+    job.progress=float(qBound(0.0,(value-options.minValue)/range,1.0));
+    return true;
+}
+
+//渲染线程：独立的上下文，不与其他线程共享，着色器的uniform状态互不干扰
+//FBO和两种渲染器按尺寸复用，读回后把图片交给编码队列
+static void renderLoop(QOpenGLContext *context,QOffscreenSurface *surface,const RenderOptions &options,
+                       BlockingQueue<RenderJob> *jobs,BlockingQueue<EncodeJob> *encodes)
+{
+    if(!context->makeCurrent(surface)){
+        qCritical()<<"makeCurrent failed";
+        RenderJob job;
+        while(jobs->pop(job))
+            failed_count.fetchAndAddRelaxed(1);
+        context->moveToThread(qApp->thread());
+        return;
+    }
+    CircleProgressRenderer circle;
+    WaveProgressRenderer wave;
+    for(ProgressRenderer *renderer:{static_cast<ProgressRenderer*>(&circle),static_cast<ProgressRenderer*>(&wave)}){
+        renderer->initialize();
+        renderer->setQuality(options.quality);
+        renderer->setLabelVisible(options.label);
+    }
+    std::unique_ptr<QOpenGLFramebufferObject> fbo;
+    const QDir dir(options.outputDir);
+    RenderJob job;
+    while(jobs->pop(job))
+    {
+        QElapsedTimer timer;
+        timer.start();
+        if(!fbo||fbo->width()!=job.size||fbo->height()!=job.size)
+            fbo.reset(new QOpenGLFramebufferObject(job.size,job.size));
+        fbo->bind();
+        if(job.kind=="wave")
+            wave.render(job.size,job.size,job.progress,options.time);
+        else
+            circle.render(job.size,job.size,job.progress);
+        EncodeJob encode;
+        encode.path=dir.filePath(job.name+".png");
+        //读回会等待绘制完成
+        encode.image=fbo->toImage();
+        fbo->release();
+        render_ns_total.fetchAndAddRelaxed(timer.nsecsElapsed());
+        rendered_count.fetchAndAddRelaxed(1);
+        encodes->push(encode);
+    }
+    fbo.reset();
+    circle.release();
+    wave.release();
+    context->doneCurrent();
+    //交回主线程析构
+    context->moveToThread(qApp->thread());
+}
+
+//编码线程：压缩PNG并写盘
+static void encodeLoop(const RenderOptions &options,BlockingQueue<EncodeJob> *encodes)
+{
+    EncodeJob job;
+    while(encodes->pop(job))
+    {
+        QElapsedTimer timer;
+        timer.start();
+        if(job.image.save(job.path,"PNG",options.compression)){
+            encoded_count.fetchAndAddRelaxed(1);
+        }else{
+            qWarning().noquote()<<"cannot write"<<job.path;
+            failed_count.fetchAndAddRelaxed(1);
+        }
+        encode_ns_total.fetchAndAddRelaxed(timer.nsecsElapsed());
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    //默认走离屏平台，无显示器的服务器上也能运行
+    if(qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM","offscreen");
+    QCoreApplication::setAttribute(Qt::AA_UseDesktopOpenGL);
+    QGuiApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Renders CircleProgressBar/WaveProgressBar images in bulk");
+    parser.addHelpOption();
+    QCommandLineOption input_option("input","CSV file with name,value[,kind[,size]] lines, - reads stdin.","file","-");
+    QCommandLineOption output_option("output","Output directory for <name>.png.","dir",".");
+    QCommandLineOption kind_option("kind","Default gauge kind (circle,wave).","kind","circle");
+    QCommandLineOption size_option("size","Default image size.","px","256");
+    QCommandLineOption range_option("range","Value range.","min,max","0,100");
+    QCommandLineOption time_option("time","Wave phase in [0,1).","t","0");
+    QCommandLineOption quality_option("quality","Shader tier (high,medium,low).","tier","high");
+    QCommandLineOption no_label_option("no-label","Skip the percentage label.");
+    QCommandLineOption threads_option("threads","Render threads, each with its own context.","n","2");
+    QCommandLineOption encoders_option("encoders","PNG encoder threads, 0 uses the idle cores.","n","0");
+    QCommandLineOption compression_option("compression","PNG quality passed to QImage::save (0-100, -1 default).","n","-1");
+    parser.addOptions({input_option,output_option,kind_option,size_option,range_option,time_option,quality_option,
+                       no_label_option,threads_option,encoders_option,compression_option});
+    parser.process(app);
+
+    RenderOptions options;
+    options.outputDir=parser.value(output_option);
+    const QStringList range=parser.value(range_option).split(',');
+    if(range.size()==2){
+        options.minValue=range.at(0).toDouble();
+        options.maxValue=range.at(1).toDouble();
+    }
+    if(options.maxValue<=options.minValue){
+        qCritical()<<"invalid --range";
+        return 1;
+    }
+    options.time=float(qBound(0.0,parser.value(time_option).toDouble(),1.0));
+    options.label=!parser.isSet(no_label_option);
+    options.quality=parseQuality(parser.value(quality_option));
+    options.compression=qBound(-1,parser.value(compression_option).toInt(),100);
+    const QString default_kind=parser.value(kind_option);
+    const int default_size=qBound(1,parser.value(size_option).toInt(),8192);
+    const int render_threads=qMax(1,parser.value(threads_option).toInt());
+    int encoder_threads=parser.value(encoders_option).toInt();
+    if(encoder_threads<=0)
+        encoder_threads=qMax(1,QThread::idealThreadCount()-render_threads);
+
+    if(!QDir().mkpath(options.outputDir)){
+        qCritical().noquote()<<"cannot create"<<options.outputDir;
+        return 1;
+    }
+    QFile input;
+    if(parser.value(input_option)=="-"){
+        input.open(stdin,QIODevice::ReadOnly|QIODevice::Text);
+    }else{
+        input.setFileName(parser.value(input_option));
+        if(!input.open(QIODevice::ReadOnly|QIODevice::Text)){
+            qCritical().noquote()<<"cannot read"<<input.fileName();
+            return 1;
+        }
+    }
+
+    QSurfaceFormat format;
+    format.setRenderableType(QSurfaceFormat::OpenGL);
+    format.setMajorVersion(3);
+    format.setMinorVersion(3);
+    format.setProfile(QSurfaceFormat::CoreProfile);
+
+    //表面需要在GUI线程创建，上下文创建后移到各自的渲染线程
+    QVector<QOffscreenSurface*> surfaces;
+    QVector<QOpenGLContext*> contexts;
+    for(int i=0;i<render_threads;i++){
+        QOffscreenSurface *surface=new QOffscreenSurface;
+        surface->setFormat(format);
+        surface->create();
+        QOpenGLContext *context=new QOpenGLContext;
+        context->setFormat(format);
+        if(!context->create()){
+            qCritical()<<"failed to create OpenGL 3.3 core context";
+            return 1;
+        }
+        surfaces.append(surface);
+        contexts.append(context);
+    }
+
+    //每个渲染线程排队几张，编码跟不上时读入和渲染暂停
+    BlockingQueue<RenderJob> jobs(render_threads*4);
+    BlockingQueue<EncodeJob> encodes(encoder_threads*4);
+    QElapsedTimer total_timer;
+    total_timer.start();
+    QVector<QThread*> renderers;
+    for(int i=0;i<render_threads;i++){
+        QOpenGLContext *context=contexts.at(i);
+        QOffscreenSurface *surface=surfaces.at(i);
+        QThread *thread=QThread::create([context,surface,&options,&jobs,&encodes]{
+            renderLoop(context,surface,options,&jobs,&encodes);
+        });
+        context->moveToThread(thread);
+        renderers.append(thread);
+        thread->start();
+    }
+    QVector<QThread*> encoders;
+    for(int i=0;i<encoder_threads;i++){
+        QThread *thread=QThread::create([&options,&encodes]{ encodeLoop(options,&encodes); });
+        encoders.append(thread);
+        thread->start();
+    }
+
+    //边读边渲染，输入很大时不必全部读进内存
+    QTextStream stream(&input);
+    int line_number=0;
+    int skipped=0;
+    QString line;
+    while(stream.readLineInto(&line))
+    {
+        line_number++;
+        line=line.trimmed();
+        if(line.isEmpty()||line.startsWith('#'))
+            continue;
+        RenderJob job;
+        if(!parseLine(line,options,default_kind,default_size,job)){
+            qWarning().noquote()<<"skip line"<<line_number<<":"<<line;
+            skipped++;
+            continue;
+        }
+        jobs.push(job);
+    }
+    jobs.close();
+    for(QThread *thread:renderers){
+        thread->wait();
+        delete thread;
+    }
+    encodes.close();
+    for(QThread *thread:encoders){
+        thread->wait();
+        delete thread;
+    }
+    const double seconds=total_timer.nsecsElapsed()/1e9;
+    qDeleteAll(contexts);
+    for(QOffscreenSurface *surface:surfaces){
+        surface->destroy();
+        delete surface;
+    }
+
+    const qint64 rendered=rendered_count.loadAcquire();
+    const qint64 encoded=encoded_count.loadAcquire();
+    QTextStream(stdout)<<QString("images %1, failed %2, skipped %3, %4 s, %5 images/s\n"
+                                 "render %6 ms/image (%7 threads), encode %8 ms/image (%9 threads)\n")
+                         .arg(encoded).arg(failed_count.loadAcquire()).arg(skipped)
+                         .arg(seconds,0,'f',3).arg(seconds>0?encoded/seconds:0,0,'f',1)
+                         .arg(rendered?render_ns_total.loadAcquire()/1e6/rendered:0,0,'f',3).arg(render_threads)
+                         .arg(encoded?encode_ns_total.loadAcquire()/1e6/encoded:0,0,'f',3).arg(encoder_threads);
+    return failed_count.loadAcquire()>0?1:0;
+}